@@ -10,35 +10,33 @@
 function( MarlinCheckROOTRequirements )
   # check if find_package( ROOT ... ) was processed before
   if( NOT ROOT_FOUND OR NOT ROOT_INCLUDE_DIRS )
-    message( FATAL_ERROR "ROOT not found. Couldn't check ROOT7 requirements. Please use find_package( ROOT ... ) before calling this function" )
+    message( FATAL_ERROR "ROOT not found. Couldn't check ROOT requirements. Please use find_package( ROOT ... ) before calling this function" )
   endif()
   if( NOT MARLIN_BOOK )
     return()
   endif()
-  # Marlin book requires includes from ROOT 7
+  # the book store ROOT writer (BookStore::writeROOT) uses the ROOT 6 histograms and files
   list( APPEND REQUIRED_INCLUDES
-    RHist.hxx
-    RSpan.hxx
-    RAxis.hxx
-    RHistBufferedFill.hxx
-    RHistConcurrentFill.hxx
+    TFile.h
+    TDirectory.h
+    TH1D.h
+    TH2D.h
+    TProfile.h
   )
-  foreach( include_dir ${ROOT_INCLUDE_DIRS} )
-    foreach( include_file ${REQUIRED_INCLUDES} )
-      string( REPLACE "." "_" include_file_var ${include_file} )
-      find_file( file_found_${include_file_var} ${include_file} PATHS ${include_dir} PATH_SUFFIXES ROOT NO_DEFAULT_PATH )    
-      message( STATUS " => Checking for file ${include_file}: ${file_found_${include_file_var}}" )
-      if( NOT file_found_${include_file_var} )
-        message( FATAL_ERROR "Couldn't find ROOT header file: ${include_file}" )
-      endif()
-    endforeach()
+  foreach( include_file ${REQUIRED_INCLUDES} )
+    string( REPLACE "." "_" include_file_var ${include_file} )
+    find_file( file_found_${include_file_var} ${include_file} PATHS ${ROOT_INCLUDE_DIRS} PATH_SUFFIXES ROOT NO_DEFAULT_PATH )
+    message( STATUS " => Checking for file ${include_file}: ${file_found_${include_file_var}}" )
+    if( NOT file_found_${include_file_var} )
+      message( FATAL_ERROR "Couldn't find ROOT header file: ${include_file}" )
+    endif()
   endforeach()
-  # Required ROOT options
-  set( REQUIRED_OPTIONS root7 )
-  foreach( opt ${REQUIRED_OPTIONS} )
-    message( STATUS " => Checking for ROOT option ${opt}: ${ROOT_${opt}_FOUND}" )
-    if( NOT ROOT_${opt}_FOUND )
-      message( FATAL_ERROR "Marlin ROOT requirements: ROOT was not compiled with the option '${opt}'" )
+  # Required ROOT components (libraries)
+  set( REQUIRED_COMPONENTS Hist RIO )
+  foreach( component ${REQUIRED_COMPONENTS} )
+    message( STATUS " => Checking for ROOT component ${component}: ${ROOT_${component}_LIBRARY}" )
+    if( NOT ROOT_${component}_LIBRARY )
+      message( FATAL_ERROR "Marlin ROOT requirements: ROOT library '${component}' not found" )
     endif()
   endforeach()
   message( STATUS "Marlin ROOT requirements OK ..." )
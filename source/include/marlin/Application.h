@@ -8,6 +8,18 @@
 #include <marlin/GeometryManager.h>
 #include <marlin/LoggerManager.h>
 #include <marlin/RandomSeedManager.h>
+#include <marlin/BookStore.h>
+#include <marlin/EventFilter.h>
+#include <marlin/InputCollections.h>
+#include <marlin/Checkpoint.h>
+#include <marlin/concurrency/TaskGroup.h>
+
+// -- std headers
+#include <set>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
 
 namespace marlin {
 
@@ -29,6 +41,8 @@ namespace marlin {
     using EventList = std::vector<std::shared_ptr<EventStore>> ;
     using DataSource = std::shared_ptr<DataSourcePlugin> ;
     using ConditionsMap = std::map<std::string, std::string> ;
+    using EventFilterMap = std::map<std::string, EventFilter> ;
+    using CheckpointMap = std::map<std::string, Checkpoint::SaveFunction> ;
 
   public:
     Application() = default ;
@@ -142,6 +156,16 @@ namespace marlin {
      */
     RandomSeedManager &randomSeedManager() ;
 
+    /**
+     *  @brief  Get the histogram book store
+     */
+    const BookStore &bookStore() const ;
+
+    /**
+     *  @brief  Get the histogram book store
+     */
+    BookStore &bookStore() ;
+
     /**
      *  @brief  Set the scheduler instance to use in this application.
      *  Must be called before init(argc, argv)
@@ -150,6 +174,105 @@ namespace marlin {
      */
     void setScheduler( Scheduler scheduler ) ;
 
+    /**
+     *  @brief  Get the number of workers processing events concurrently.
+     *  Valid from the processor initialization on. Returns 1 if no scheduler is set
+     */
+    std::size_t concurrency() const ;
+
+    /**
+     *  @brief  Get the queue of tasks spawned by processors.
+     *  The tasks are run by idle workers of the scheduler, if any,
+     *  and by the threads waiting for them
+     */
+    concurrency::TaskQueue &taskQueue() const ;
+
+    /**
+     *  @brief  Get the number of events read from the data source so far.
+     *  This is also the input index of the next event (see EventStore::inputIndex())
+     */
+    std::size_t eventsRead() const ;
+
+    /**
+     *  @brief  Get the input index below which all events are retired
+     *  (processed or skipped). Can be called from any thread
+     */
+    std::size_t retiredWatermark() const ;
+
+    /**
+     *  @brief  Get the input index below which all events are processed by the
+     *  sequence (all processors run or event skipped). Updated by the workers as
+     *  soon as an event is done, before it is retired by the main thread, so that
+     *  ordered outputs (see concurrency::CommitQueue) never wait for the main thread.
+     *  Can be called from any thread
+     */
+    std::size_t processedWatermark() const ;
+
+    /**
+     *  @brief  Notify that an event is processed by the sequence (see processedWatermark()).
+     *  Called by the workers at the end of the event processing
+     *
+     *  @param  inputIndex the input index of the event
+     */
+    void eventProcessed( std::size_t inputIndex ) ;
+
+    /**
+     *  @brief  Register the event filter of a processor, equivalent to its return value.
+     *  If the processor is the first active one and the other processors only run on
+     *  the events it selects (see processor conditions), the filter is pushed down to
+     *  the data source, so that the other events are not built nor processed.
+     *  Must be called at processor initialization
+     *
+     *  @param  processor the processor name
+     *  @param  filter the event filter
+     */
+    void registerEventFilter( const std::string &processor, EventFilter filter ) ;
+
+    /**
+     *  @brief  Register collections used by a processor.
+     *  The input collections registered as processor parameters are added
+     *  automatically after the processor initialization
+     *
+     *  @param  processor the processor name
+     *  @param  names the collection names
+     */
+    void registerInputCollections( const std::string &processor, const std::vector<std::string> &names ) ;
+
+    /**
+     *  @brief  Register a processor using all the collections of the events
+     *
+     *  @param  processor the processor name
+     *  @param  exceptNames the collection names not used by the processor
+     *  @param  exceptTypes the collection types not used by the processor
+     */
+    void registerAllInputCollections( const std::string &processor, const InputCollections::NameSet &exceptNames, const InputCollections::NameSet &exceptTypes ) ;
+
+    /**
+     *  @brief  Register an active processor. Unless it registers its input
+     *  collections, it may use any collection (see InputCollections)
+     *
+     *  @param  processor the processor name
+     */
+    void registerInputProcessor( const std::string &processor ) ;
+
+    /**
+     *  @brief  Whether checkpoints are written (global parameter CheckpointFile)
+     */
+    bool checkpointing() const ;
+
+    /**
+     *  @brief  Register a checkpoint participant, e.g a processor writing an output file.
+     *  At each checkpoint, the save function returns the participant state after the
+     *  committed events. If the job is resumed (-r), the restore function is called
+     *  immediately with the saved state (empty if none). Must be called at processor
+     *  initialization
+     *
+     *  @param  name the participant name (e.g the processor name)
+     *  @param  save the function returning the state to save
+     *  @param  restore the function restoring a saved state
+     */
+    void registerCheckpoint( const std::string &name, Checkpoint::SaveFunction save, Checkpoint::RestoreFunction restore ) ;
+
   protected:
     /**
      *  @brief  Get the parser instance
@@ -163,7 +286,8 @@ namespace marlin {
     void parseCommandLine() ;
 
     /**
-     *  @brief  Create the parser instance based on the steering file extension
+     *  @brief  Create the parser instance based on the steering file extension.
+     *  A steering cache parser is created if a cache file was given on the command line
      */
     std::shared_ptr<IParser> createParser() const ;
 
@@ -181,6 +305,21 @@ namespace marlin {
      */
     void onRunHeaderRead( std::shared_ptr<RunHeader> rhdr ) ;
 
+    /**
+     *  @brief  Get the event filter that can be pushed down to the data source, if any
+     */
+    EventFilter pushdownEventFilter() const ;
+
+    /**
+     *  @brief  Read the checkpoint settings and the checkpoint to resume from, if any
+     */
+    void initCheckpoint() ;
+
+    /**
+     *  @brief  Write a checkpoint if the checkpoint interval is elapsed
+     */
+    void checkpoint() ;
+
     /**
      *  @brief  Processed finished events from the output queue
      *
@@ -197,6 +336,10 @@ namespace marlin {
     RandomSeedManager          _randomSeedMgr {} ;
     /// The logger manager
     LoggerManager              _loggerMgr {} ;
+    /// The histogram book store
+    BookStore                  _bookStore {} ;
+    /// The queue of tasks spawned by processors
+    mutable concurrency::TaskQueue _taskQueue {} ;
 
   private:
     /// The program name. Initialized on init()
@@ -209,6 +352,8 @@ namespace marlin {
     bool                       _initialized {false} ;
     /// The steering file name
     std::string                _steeringFileName {} ;
+    /// The compiled steering file cache name (optional)
+    std::string                _steeringCacheFile {} ;
     /// The XML steering file parser
     std::shared_ptr<IParser>   _parser {nullptr} ;
     ///< The event processing scheduler instance
@@ -217,8 +362,46 @@ namespace marlin {
     DataSource                 _dataSource {nullptr} ;
     ///< Initial processor runtime conditions from steering file
     ConditionsMap              _conditions {} ;
+    ///< The event filters registered by processors
+    EventFilterMap             _eventFilters {} ;
+    ///< The collections used by the active processors
+    InputCollections           _inputCollections {} ;
+    ///< The mutex protecting the processor registrations (processors may be initialized in parallel)
+    std::mutex                 _registrationMutex {} ;
     ///< Whether the currently pushed event is the first one
     bool                       _isFirstEvent {true} ;
+    ///< The number of events read, input index of the next event
+    std::atomic<std::size_t>   _eventsRead {0} ;
+    ///< The input indices of the events not retired yet
+    mutable std::set<std::size_t> _inFlightIndices {} ;
+    ///< The input index below which all events are retired
+    mutable std::atomic<std::size_t> _retiredWatermark {0} ;
+    ///< The mutex protecting the indices of the events being processed
+    std::mutex                 _processingMutex {} ;
+    ///< The input indices of the events not processed yet
+    std::set<std::size_t>      _processingIndices {} ;
+    ///< The input index below which all events are processed
+    std::atomic<std::size_t>   _processedWatermark {0} ;
+    ///< The checkpoint file name (no checkpoint if empty)
+    std::string                _checkpointFile {} ;
+    ///< The minimum time between two checkpoints
+    std::chrono::steady_clock::duration _checkpointInterval {} ;
+    ///< The time of the last checkpoint
+    std::chrono::steady_clock::time_point _lastCheckpoint {} ;
+    ///< The retired watermark at the last checkpoint
+    std::size_t                _checkpointWatermark {0} ;
+    ///< Whether the checkpoints are refused because histograms are booked
+    bool                       _checkpointsRefused {false} ;
+    ///< Whether to resume the job from the checkpoint file (-r)
+    bool                       _resume {false} ;
+    ///< The checkpoint to resume from
+    Checkpoint                 _resumeCheckpoint {} ;
+    ///< The number of events committed by the previous jobs, when resumed
+    std::size_t                _committedBefore {0} ;
+    ///< The checkpoint participants
+    CheckpointMap              _checkpointParticipants {} ;
+    ///< The data source positions after the events not retired yet, by input index
+    mutable std::map<std::size_t, std::string> _sourcePositions {} ;
   };
 
 } // end namespace marlin
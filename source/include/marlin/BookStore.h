@@ -0,0 +1,555 @@
+#ifndef MARLIN_BOOKSTORE_h
+#define MARLIN_BOOKSTORE_h 1
+
+// -- std headers
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+
+// -- marlin headers
+#include <marlin/Logging.h>
+#include <marlin/WorkerLocal.h>
+
+namespace marlin {
+
+  class Application ;
+
+  /**
+   *  @brief  HistogramAxis class
+   *  Describes the binning of a histogram axis, either with a fixed
+   *  bin width or with variable bin edges. Bin 0 is the underflow
+   *  bin and bin nbins()+1 is the overflow bin.
+   */
+  class HistogramAxis {
+  public:
+    HistogramAxis() = delete ;
+    ~HistogramAxis() = default ;
+    HistogramAxis( const HistogramAxis & ) = default ;
+    HistogramAxis &operator=( const HistogramAxis & ) = default ;
+
+    /**
+     *  @brief  Constructor with fixed bin width
+     *
+     *  @param  nbins the number of bins
+     *  @param  min the lower edge
+     *  @param  max the upper edge
+     */
+    HistogramAxis( std::size_t nbins, double min, double max ) ;
+
+    /**
+     *  @brief  Constructor with variable bin edges
+     *
+     *  @param  edges the bin edges, in increasing order (nbins+1 values)
+     */
+    HistogramAxis( const std::vector<double> &edges ) ;
+
+    /**
+     *  @brief  Get the number of bins (without under/overflow)
+     */
+    std::size_t nbins() const ;
+
+    /**
+     *  @brief  Get the lower edge
+     */
+    double min() const ;
+
+    /**
+     *  @brief  Get the upper edge
+     */
+    double max() const ;
+
+    /**
+     *  @brief  Whether the axis has variable bin edges
+     */
+    bool variable() const ;
+
+    /**
+     *  @brief  Get the bin edges. Empty for fixed binning
+     */
+    const std::vector<double> &edges() const ;
+
+    /**
+     *  @brief  Find the bin of the value x.
+     *  Values below min() (and NaN) go in the underflow bin
+     *
+     *  @param  x the value
+     */
+    std::size_t findBin( double x ) const ;
+
+    /**
+     *  @brief  Whether the two axis have the same binning
+     *
+     *  @param  rhs the other axis
+     */
+    bool operator==( const HistogramAxis &rhs ) const ;
+
+  private:
+    ///< The number of bins
+    std::size_t             _nbins {0} ;
+    ///< The lower edge
+    double                  _min {0.} ;
+    ///< The upper edge
+    double                  _max {0.} ;
+    ///< The inverse bin width (fixed binning)
+    double                  _scale {0.} ;
+    ///< The bin edges (variable binning)
+    std::vector<double>     _edges {} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  HistogramType enumerator
+   */
+  enum class HistogramType {
+    H1,          ///< 1D histogram
+    H2,          ///< 2D histogram
+    Profile1     ///< 1D profile
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  HistogramData class
+   *  Holds the bin contents of a histogram, including under/overflow bins.
+   *  For 2D histograms, the bin index is ix + (nx+2) * iy.
+   *  Profiles additionally hold the sums of w*y and w*y*y.
+   */
+  class HistogramData {
+  public:
+    using Axes = std::vector<HistogramAxis> ;
+    using Bins = std::vector<double> ;
+
+  public:
+    HistogramData() = delete ;
+    ~HistogramData() = default ;
+    HistogramData( const HistogramData & ) = default ;
+    HistogramData &operator=( const HistogramData & ) = default ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  type the histogram type
+     *  @param  axes the histogram axes
+     */
+    HistogramData( HistogramType type, const Axes &axes ) ;
+
+    /**
+     *  @brief  Get the histogram type
+     */
+    HistogramType type() const ;
+
+    /**
+     *  @brief  Get the histogram axes
+     */
+    const Axes &axes() const ;
+
+    /**
+     *  @brief  Get the global bin index of a 1D histogram or profile
+     *
+     *  @param  x the x value
+     */
+    std::size_t bin( double x ) const ;
+
+    /**
+     *  @brief  Get the global bin index of a 2D histogram
+     *
+     *  @param  x the x value
+     *  @param  y the y value
+     */
+    std::size_t bin( double x, double y ) const ;
+
+    /**
+     *  @brief  Fill a bin with a weight
+     *
+     *  @param  bin the global bin index
+     *  @param  weight the weight
+     */
+    void fill( std::size_t bin, double weight ) ;
+
+    /**
+     *  @brief  Fill a profile bin with a value and a weight
+     *
+     *  @param  bin the global bin index
+     *  @param  y the profiled value
+     *  @param  weight the weight
+     */
+    void fillProfile( std::size_t bin, double y, double weight ) ;
+
+    /**
+     *  @brief  Add the content of another histogram with the same binning
+     *
+     *  @param  other the histogram data to add
+     */
+    void add( const HistogramData &other ) ;
+
+    /**
+     *  @brief  Get the number of entries
+     */
+    unsigned long long entries() const ;
+
+    /**
+     *  @brief  Get the sum of weights per bin
+     */
+    const Bins &sumw() const ;
+
+    /**
+     *  @brief  Get the sum of squared weights per bin
+     */
+    const Bins &sumw2() const ;
+
+    /**
+     *  @brief  Get the sum of w*y per bin (profile only)
+     */
+    const Bins &sumwy() const ;
+
+    /**
+     *  @brief  Get the sum of w*y*y per bin (profile only)
+     */
+    const Bins &sumwy2() const ;
+
+  private:
+    ///< The histogram type
+    HistogramType           _type {HistogramType::H1} ;
+    ///< The histogram axes
+    Axes                    _axes {} ;
+    ///< The number of entries
+    unsigned long long      _entries {0} ;
+    ///< The sum of weights
+    Bins                    _sumw {} ;
+    ///< The sum of squared weights
+    Bins                    _sumw2 {} ;
+    ///< The sum of w*y (profile only)
+    Bins                    _sumwy {} ;
+    ///< The sum of w*y*y (profile only)
+    Bins                    _sumwy2 {} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  Histogram class
+   *  Base class of the histogram handles returned by the BookStore.
+   *  Each worker thread fills its own copy of the histogram data (see
+   *  WorkerLocal), so filling requires neither locks nor atomics. The
+   *  worker copies are merged on demand by merged(), once the event
+   *  processing is over (e.g. in Processor::end()).
+   */
+  class Histogram {
+  public:
+    using Buffers = WorkerLocal<HistogramData> ;
+
+  public:
+    Histogram() = delete ;
+    virtual ~Histogram() = default ;
+    Histogram( const Histogram & ) = delete ;
+    Histogram &operator=( const Histogram & ) = delete ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  path the histogram path in the book store
+     *  @param  title the histogram title
+     *  @param  prototype an empty histogram data used for each worker
+     *  @param  nworkers the number of worker threads
+     */
+    Histogram( const std::string &path, const std::string &title, const HistogramData &prototype, std::size_t nworkers ) ;
+
+    /**
+     *  @brief  Get the histogram path
+     */
+    const std::string &path() const ;
+
+    /**
+     *  @brief  Get the histogram title
+     */
+    const std::string &title() const ;
+
+    /**
+     *  @brief  Get the histogram type
+     */
+    HistogramType type() const ;
+
+    /**
+     *  @brief  Get the histogram axes
+     */
+    const HistogramData::Axes &axes() const ;
+
+    /**
+     *  @brief  Merge the worker copies and return the result.
+     *  Not thread safe: call it outside of event processing only
+     */
+    HistogramData merged() const ;
+
+  protected:
+    ///< The histogram path
+    std::string                 _path {} ;
+    ///< The histogram title
+    std::string                 _title {} ;
+    ///< The empty histogram data, used as prototype for the worker copies
+    HistogramData               _prototype ;
+    ///< The worker copies
+    mutable Buffers             _buffers ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  Histogram1D class
+   */
+  class Histogram1D : public Histogram {
+  public:
+    using Histogram::Histogram ;
+
+    /**
+     *  @brief  Fill the histogram. Thread safe and lock free
+     *
+     *  @param  x the value
+     *  @param  weight the weight
+     */
+    void fill( double x, double weight = 1. ) ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  Histogram2D class
+   */
+  class Histogram2D : public Histogram {
+  public:
+    using Histogram::Histogram ;
+
+    /**
+     *  @brief  Fill the histogram. Thread safe and lock free
+     *
+     *  @param  x the x value
+     *  @param  y the y value
+     *  @param  weight the weight
+     */
+    void fill( double x, double y, double weight = 1. ) ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  Profile1D class
+   */
+  class Profile1D : public Histogram {
+  public:
+    using Histogram::Histogram ;
+
+    /**
+     *  @brief  Fill the profile. Thread safe and lock free
+     *
+     *  @param  x the x value
+     *  @param  y the profiled value
+     *  @param  weight the weight
+     */
+    void fill( double x, double y, double weight = 1. ) ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  BookStore class
+   *  Books histograms for processors and writes them at the end of the
+   *  application. Booking is thread safe and is expected in Processor::init().
+   *  Booking twice the same path returns the same histogram, so that cloned
+   *  processors share a single histogram without manual merging. Booking an
+   *  existing path with a different type or binning throws.
+   *
+   *  The histograms are written on end() to the file given by the global
+   *  parameter "BookStoreFile" (default "MarlinBookStore.json"), if at least
+   *  one histogram was booked. An empty name disables the output. The file is
+   *  written in JSON format, or in ROOT format if the file name ends with
+   *  ".root" and Marlin was built with MARLIN_BOOK=ON.
+   */
+  class BookStore {
+  public:
+    using Logger = Logging::Logger ;
+    using HistogramMap = std::map<std::string, std::shared_ptr<Histogram>> ;
+
+  public:
+    BookStore( const BookStore & ) = delete ;
+    BookStore &operator=( const BookStore & ) = delete ;
+    ~BookStore() = default ;
+
+    /**
+     *  @brief  Default constructor
+     */
+    BookStore() ;
+
+    /**
+     *  @brief  Initialize the book store
+     *
+     *  @param  app the application from which to get settings
+     */
+    void init( const Application *app ) ;
+
+    /**
+     *  @brief  Initialize the book store without application,
+     *  e.g for a standalone use or for testing
+     *
+     *  @param  nworkers the number of worker threads filling the histograms
+     *  @param  outputFile the output file name written on end() (empty: no output)
+     */
+    void init( std::size_t nworkers, const std::string &outputFile ) ;
+
+    /**
+     *  @brief  Book a 1D histogram
+     *
+     *  @param  path the histogram path
+     *  @param  title the histogram title
+     *  @param  axis the x axis
+     */
+    Histogram1D &book1D( const std::string &path, const std::string &title, const HistogramAxis &axis ) ;
+
+    /**
+     *  @brief  Book a 2D histogram
+     *
+     *  @param  path the histogram path
+     *  @param  title the histogram title
+     *  @param  xaxis the x axis
+     *  @param  yaxis the y axis
+     */
+    Histogram2D &book2D( const std::string &path, const std::string &title, const HistogramAxis &xaxis, const HistogramAxis &yaxis ) ;
+
+    /**
+     *  @brief  Book a 1D profile
+     *
+     *  @param  path the profile path
+     *  @param  title the profile title
+     *  @param  axis the x axis
+     */
+    Profile1D &bookProfile1D( const std::string &path, const std::string &title, const HistogramAxis &axis ) ;
+
+    /**
+     *  @brief  Get all the booked histograms
+     */
+    const HistogramMap &histograms() const ;
+
+    /**
+     *  @brief  Merge and write the histograms to the output file, if any
+     */
+    void end() ;
+
+    /**
+     *  @brief  Merge and write the histograms in JSON format
+     *
+     *  @param  fname the output file name
+     */
+    void writeJSON( const std::string &fname ) const ;
+
+    /**
+     *  @brief  Merge and write the histograms in ROOT format.
+     *  Throws if Marlin was not built with MARLIN_BOOK=ON
+     *
+     *  @param  fname the output file name
+     */
+    void writeROOT( const std::string &fname ) const ;
+
+  private:
+    /**
+     *  @brief  Book a histogram or get the existing one
+     *
+     *  @param  path the histogram path
+     *  @param  title the histogram title
+     *  @param  type the histogram type
+     *  @param  axes the histogram axes
+     */
+    template <typename T>
+    T &book( const std::string &path, const std::string &title, HistogramType type, const HistogramData::Axes &axes ) ;
+
+  private:
+    ///< The booked histograms, by path
+    HistogramMap                  _histograms {} ;
+    ///< The synchronization mutex for booking
+    std::mutex                    _mutex {} ;
+    ///< The application in which the book store has been initialized
+    const Application            *_application {nullptr} ;
+    ///< The number of worker threads, if initialized without application
+    std::size_t                   _nworkers {0} ;
+    ///< The output file name
+    std::string                   _outputFile {} ;
+    ///< The logger instance
+    Logger                        _logger {nullptr} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  inline std::size_t HistogramAxis::findBin( double x ) const {
+    if( not ( x >= _min ) ) {
+      return 0 ;
+    }
+    if( x >= _max ) {
+      return _nbins + 1 ;
+    }
+    if( _edges.empty() ) {
+      return std::min( _nbins - 1, static_cast<std::size_t>( ( x - _min ) * _scale ) ) + 1 ;
+    }
+    return std::upper_bound( _edges.begin(), _edges.end(), x ) - _edges.begin() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline std::size_t HistogramData::bin( double x ) const {
+    return _axes[0].findBin( x ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline std::size_t HistogramData::bin( double x, double y ) const {
+    return _axes[0].findBin( x ) + ( _axes[0].nbins() + 2 ) * _axes[1].findBin( y ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline void HistogramData::fill( std::size_t bin, double weight ) {
+    _sumw[bin] += weight ;
+    _sumw2[bin] += weight * weight ;
+    ++ _entries ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline void HistogramData::fillProfile( std::size_t bin, double y, double weight ) {
+    fill( bin, weight ) ;
+    _sumwy[bin] += weight * y ;
+    _sumwy2[bin] += weight * y * y ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline void Histogram1D::fill( double x, double weight ) {
+    auto &data = _buffers.local() ;
+    data.fill( data.bin( x ), weight ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline void Histogram2D::fill( double x, double y, double weight ) {
+    auto &data = _buffers.local() ;
+    data.fill( data.bin( x, y ), weight ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline void Profile1D::fill( double x, double y, double weight ) {
+    auto &data = _buffers.local() ;
+    data.fillProfile( data.bin( x ), y, weight ) ;
+  }
+
+} // end namespace marlin
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef MARLIN_CHECKPOINT_h
+#define MARLIN_CHECKPOINT_h 1
+
+// -- std headers
+#include <string>
+#include <map>
+#include <functional>
+
+namespace marlin {
+
+  /**
+   *  @brief  Checkpoint class.
+   *
+   *  The state of a job at a commit point, to resume it after a failure.
+   *  All the events of input index lower than the watermark are committed
+   *  (processed and written), none of the following ones. It holds:
+   *
+   *  - the data source position after the last committed event (see
+   *    DataSourcePlugin::position()), e.g the position in the input files,
+   *  - the state of the registered participants (e.g output file sizes),
+   *  - the global random seed, the event seeds being derived from it.
+   *
+   *  The checkpoint file is a text file with one line per item:
+   *
+   *    MarlinCheckpoint <version>
+   *    W <watermark>
+   *    S <random seed>
+   *    P <data source position>
+   *    X <participant> <participant state>
+   */
+  class Checkpoint {
+  public:
+    ///< The checkpoint file format version
+    static constexpr unsigned int Version = 1 ;
+    /**
+     *  @brief  Get the state of a participant at a commit point: the state
+     *  after committing all the events of input index lower than the given
+     *  one, and none of the following ones. Called from the reader thread
+     */
+    using SaveFunction = std::function<std::string(std::size_t)> ;
+    /**
+     *  @brief  Restore the state of a participant saved in a checkpoint
+     */
+    using RestoreFunction = std::function<void(const std::string&)> ;
+    using StateMap = std::map<std::string, std::string> ;
+
+  public:
+    Checkpoint() = default ;
+    ~Checkpoint() = default ;
+    Checkpoint( const Checkpoint & ) = default ;
+    Checkpoint &operator=( const Checkpoint & ) = default ;
+
+    /**
+     *  @brief  Load a checkpoint file
+     *
+     *  @param  fname the checkpoint file name
+     */
+    static Checkpoint load( const std::string &fname ) ;
+
+    /**
+     *  @brief  Save the checkpoint. The file is replaced atomically:
+     *  a job killed while saving leaves the previous checkpoint
+     *
+     *  @param  fname the checkpoint file name
+     */
+    void save( const std::string &fname ) const ;
+
+  public:
+    ///< The number of committed events, input index of the next event
+    std::size_t                _watermark {0} ;
+    ///< The global random seed
+    unsigned int               _randomSeed {0} ;
+    ///< The data source position after the last committed event
+    std::string                _position {} ;
+    ///< The participant states, by name
+    StateMap                   _states {} ;
+  };
+
+}
+
+#endif
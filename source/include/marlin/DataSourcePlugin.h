@@ -4,6 +4,8 @@
 // -- marlin headers
 #include <marlin/Parameter.h>
 #include <marlin/Logging.h>
+#include <marlin/EventFilter.h>
+#include <marlin/InputCollections.h>
 
 // -- std headers
 #include <functional>
@@ -88,6 +90,60 @@ namespace marlin {
      */
     void onRunHeaderRead( RunHeaderFunction func ) ;
 
+    /**
+     *  @brief  Whether the data source can evaluate an event filter
+     *  on the event headers, before the events are built
+     */
+    virtual bool supportsEventFilter() const { return false ; }
+
+    /**
+     *  @brief  Set the event filter to evaluate before the events are built.
+     *  Called by the application before the plugin initialization
+     *
+     *  @param  filter the event filter
+     */
+    void setEventFilter( EventFilter filter ) ;
+
+    /**
+     *  @brief  Get the number of events rejected by the event filter
+     */
+    std::size_t filteredEvents() const ;
+
+    /**
+     *  @brief  Whether the data source can report its read position and
+     *  resume reading from it (see Checkpoint)
+     */
+    virtual bool supportsResume() const { return false ; }
+
+    /**
+     *  @brief  Get the current read position, after the last event passed to
+     *  processEvent(). Called by the application on each event when checkpoints
+     *  are enabled. The format is private to the data source
+     */
+    virtual std::string position() const ;
+
+    /**
+     *  @brief  Resume reading from a position returned by position(), possibly
+     *  by a previous job. Called by the application after the plugin initialization
+     *
+     *  @param  pos the position to resume from
+     */
+    virtual void resume( const std::string &pos ) ;
+
+    /**
+     *  @brief  Set the collections used by the active processors.
+     *  Called by the application before the plugin initialization
+     *
+     *  @param  collections the used collections
+     */
+    void setInputCollections( const InputCollections &collections ) ;
+
+    /**
+     *  @brief  Get the collections used by the active processors.
+     *  Data sources may read only these collections
+     */
+    const InputCollections &inputCollections() const ;
+
     /**
      *  @brief  Get the plugin logger
      */
@@ -110,6 +166,26 @@ namespace marlin {
      */
     void processEvent( std::shared_ptr<EventStore> event ) ;
 
+    /**
+     *  @brief  Evaluate the event filter, if any, on an event header.
+     *  Daughter classes supporting event filters must call it before
+     *  building the event and skip the event if it returns false
+     *
+     *  @param  header the event header
+     */
+    bool acceptEvent( const EventHeader &header ) ;
+
+    /**
+     *  @brief  Whether an event filter is set
+     */
+    bool hasEventFilter() const ;
+
+    /**
+     *  @brief  Get the application in which the plugin is running.
+     *  Valid from the plugin initialization on
+     */
+    const Application &app() const ;
+
   protected:
     ///< The data source description
     std::string              _description {"No description"} ;
@@ -119,10 +195,18 @@ namespace marlin {
     const std::string        _type ;
     ///< The plugin logger
     Logger                   _logger {nullptr} ;
+    ///< The application in which the plugin is running
+    const Application       *_application {nullptr} ;
     ///< The callback function on event read
     EventFunction            _onEventRead {nullptr} ;
     ///< The callback function on run header read
     RunHeaderFunction        _onRunHeaderRead {nullptr} ;
+    ///< The event filter
+    EventFilter              _eventFilter {nullptr} ;
+    ///< The number of events rejected by the event filter
+    std::size_t              _filteredEvents {0} ;
+    ///< The collections used by the active processors
+    InputCollections         _inputCollections {} ;
   };
 
 }
@@ -0,0 +1,156 @@
+#ifndef MARLIN_EVENTARENA_h
+#define MARLIN_EVENTARENA_h 1
+
+// -- std headers
+#include <memory_resource>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+namespace marlin {
+
+  /**
+   *  @brief  ArenaPool class
+   *  Thread safe cache of memory blocks used as upstream resource of event
+   *  arenas. Blocks released by an arena are kept for the next events instead
+   *  of being returned to the system. There is one pool per worker (see
+   *  workerPool()), so the lock is only contended when an event is retired
+   *  by another thread than its worker.
+   *  The pool also keeps a smoothed peak of the arena usage, used as initial
+   *  size of the next arenas, so that an arena usually needs a single block.
+   */
+  class ArenaPool : public std::pmr::memory_resource {
+  public:
+    /// The alignment of all blocks allocated by the pool
+    static constexpr std::size_t BlockAlignment = 64 ;
+    /// The minimum block size
+    static constexpr std::size_t MinBlockSize = 64 * 1024 ;
+    /// The maximum number of cached blocks
+    static constexpr std::size_t MaxCachedBlocks = 16 ;
+
+  public:
+    ArenaPool() = default ;
+    ArenaPool( const ArenaPool & ) = delete ;
+    ArenaPool &operator=( const ArenaPool & ) = delete ;
+
+    /**
+     *  @brief  Destructor. Free the cached blocks
+     */
+    ~ArenaPool() ;
+
+    /**
+     *  @brief  Get the initial size to use for a new arena
+     */
+    std::size_t sizeHint() const ;
+
+    /**
+     *  @brief  Update the size hint with the usage of a released arena
+     *
+     *  @param  usage the number of bytes allocated in the arena
+     */
+    void updateSizeHint( std::size_t usage ) ;
+
+    /**
+     *  @brief  Get the number of cached blocks
+     */
+    std::size_t cachedBlocks() const ;
+
+    /**
+     *  @brief  Get the arena pool of a worker. Pools are created on first access
+     *  and live until the end of the program
+     *
+     *  @param  index the worker index
+     */
+    static ArenaPool &workerPool( std::size_t index ) ;
+
+  private:
+    void *do_allocate( std::size_t bytes, std::size_t alignment ) override ;
+    void do_deallocate( void *ptr, std::size_t bytes, std::size_t alignment ) override ;
+    bool do_is_equal( const std::pmr::memory_resource &other ) const noexcept override ;
+
+  private:
+    /**
+     *  @brief  Block struct
+     */
+    struct Block {
+      ///< The block size
+      std::size_t    _size {0} ;
+      ///< The block alignment
+      std::size_t    _alignment {BlockAlignment} ;
+    };
+
+    ///< The synchronization mutex
+    mutable std::mutex                       _mutex {} ;
+    ///< The cached blocks, by size
+    std::multimap<std::size_t, void*>        _freeBlocks {} ;
+    ///< The blocks in use
+    std::unordered_map<void*, Block>         _usedBlocks {} ;
+    ///< The initial size of the next arenas
+    std::atomic<std::size_t>                 _sizeHint {MinBlockSize} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  EventArena class
+   *  Monotonic memory resource for transient per-event data. Allocations
+   *  are bump-pointer allocations in blocks taken from an ArenaPool, and
+   *  deallocations do nothing. All the memory is given back at once when
+   *  the arena is released, which the framework does when the event is
+   *  retired. Use it with std::pmr containers:
+   *  @code{cpp}
+   *  std::pmr::vector<EVENT::CalorimeterHit*> hits( ProcessorApi::eventArena( event ) ) ;
+   *  @endcode
+   *  The arena is not thread safe: only use it from the thread processing
+   *  the event (not in parallelFor chunks). Objects created in the arena are
+   *  never destroyed: use it for trivially destructible types or containers
+   *  that don't outlive the event.
+   */
+  class EventArena : public std::pmr::memory_resource {
+  public:
+    EventArena() = delete ;
+    EventArena( const EventArena & ) = delete ;
+    EventArena &operator=( const EventArena & ) = delete ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  pool the upstream pool
+     */
+    EventArena( ArenaPool &pool ) ;
+
+    /**
+     *  @brief  Destructor. Release the arena
+     */
+    ~EventArena() ;
+
+    /**
+     *  @brief  Give all blocks back to the pool and update its size hint
+     */
+    void release() ;
+
+    /**
+     *  @brief  Get the number of bytes allocated since the last release
+     */
+    std::size_t bytesAllocated() const ;
+
+  private:
+    void *do_allocate( std::size_t bytes, std::size_t alignment ) override ;
+    void do_deallocate( void *ptr, std::size_t bytes, std::size_t alignment ) override ;
+    bool do_is_equal( const std::pmr::memory_resource &other ) const noexcept override ;
+
+  private:
+    ///< The upstream pool
+    ArenaPool                               &_pool ;
+    ///< The monotonic resource
+    std::pmr::monotonic_buffer_resource      _resource ;
+    ///< The number of bytes allocated since the last release
+    std::size_t                              _bytesAllocated {0} ;
+  };
+
+}
+
+#endif
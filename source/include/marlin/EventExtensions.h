@@ -10,6 +10,8 @@
 #include <memory>
 #include <thread>
 #include <string>
+#include <atomic>
+#include <mutex>
 
 namespace marlin {
 
@@ -108,11 +110,55 @@ namespace marlin {
   //--------------------------------------------------------------------------
   //--------------------------------------------------------------------------
 
+  /**
+   *  @brief  CancellationExtension class
+   *  Event extension holding the cooperative cancellation flag of an event.
+   *  The flag is set by the event watchdog when a time budget is exceeded
+   *  (see EventWatchdog) and polled by processors via ProcessorApi::cancelled()
+   */
+  class CancellationExtension {
+  public:
+    CancellationExtension() = default ;
+    ~CancellationExtension() = default ;
+    CancellationExtension(const CancellationExtension&) = delete ;
+    CancellationExtension& operator=(const CancellationExtension&) = delete ;
+
+  public:
+    /**
+     *  @brief  Request the cancellation of the event
+     *
+     *  @param  reason the cancellation reason
+     */
+    void cancel( const std::string &reason ) ;
+
+    /**
+     *  @brief  Whether the event cancellation was requested
+     */
+    bool cancelled() const ;
+
+    /**
+     *  @brief  Get the cancellation reason
+     */
+    std::string reason() const ;
+
+  private:
+    /// The cancellation flag
+    std::atomic<bool>     _cancelled {false} ;
+    /// The synchronization mutex for the reason
+    mutable std::mutex    _mutex {} ;
+    /// The cancellation reason
+    std::string           _reason {} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
   // extension mapping types
   namespace extensions {
     struct ProcessorConditions {} ;
     struct RandomSeed {} ;
     struct IsFirstEvent {} ;
+    struct Cancellation {} ;
   }
 
 }
@@ -0,0 +1,29 @@
+#ifndef MARLIN_EVENTFILTER_h
+#define MARLIN_EVENTFILTER_h 1
+
+// -- std headers
+#include <functional>
+
+namespace marlin {
+
+  /**
+   *  @brief  EventHeader struct
+   *  The cheap event metadata a data source can read before building
+   *  the full event, to evaluate an event filter
+   */
+  struct EventHeader {
+    ///< The run number
+    int              _runNumber {0} ;
+    ///< The event number
+    int              _eventNumber {0} ;
+  };
+
+  /**
+   *  @brief  An event filter, evaluated on the event header.
+   *  Returns true if the event is selected
+   */
+  using EventFilter = std::function<bool(const EventHeader&)> ;
+
+}
+
+#endif
@@ -7,6 +7,9 @@
 
 // -- marlin headers
 #include <marlin/Extensions.h>
+#include <marlin/EventArena.h>
+#include <marlin/WorkerLocal.h>
+#include <marlin/concurrency/TaskGroup.h>
 
 namespace marlin {
 
@@ -35,6 +38,19 @@ namespace marlin {
      */
     std::size_t uid() const ;
 
+    /**
+     *  @brief  Set the event input index: the position of the event in the
+     *  input stream, assigned in read order by the application
+     *
+     *  @param  index the input index
+     */
+    void setInputIndex( std::size_t index ) ;
+
+    /**
+     *  @brief  Get the event input index
+     */
+    std::size_t inputIndex() const ;
+
     /**
      *  @brief  Get the underlying event to a specific type
      */
@@ -100,15 +116,65 @@ namespace marlin {
      */
     const Extensions &extensions() const ;
 
+    /**
+     *  @brief  Get the event memory arena for transient per-event data.
+     *  The arena is created on first call, on the pool of the calling worker,
+     *  and released when the event is retired. See EventArena
+     */
+    EventArena &arena() ;
+
+    /**
+     *  @brief  Release the event memory arena, if any.
+     *  Called by the framework when the event is retired
+     */
+    void releaseArena() ;
+
+    /**
+     *  @brief  Request to skip the rest of the event processing.
+     *  The sequence checks the flag after each processor, without
+     *  the cost of an exception (see ProcessorApi::skipEvent())
+     */
+    void requestSkip() ;
+
+    /**
+     *  @brief  Whether a skip of the event processing was requested
+     */
+    bool skipRequested() const ;
+
+    /**
+     *  @brief  Prepare the event in a task (e.g unpacking by the data source), run by
+     *  an idle worker while the event waits in the scheduler queue. The task must
+     *  not hold the event store itself. The event processing waits for it
+     *  (see waitPreparation())
+     *
+     *  @param  queue the task queue
+     *  @param  task the preparation task
+     */
+    void prepare( concurrency::TaskQueue &queue, std::function<void()> task ) ;
+
+    /**
+     *  @brief  Wait for the preparation task, if any. Runs it in the calling thread
+     *  if no worker has started it yet. Rethrows the exception thrown by the task
+     */
+    void waitPreparation() ;
+
   private:
     ///
     std::size_t                 _uid {0} ;
+    /// The event position in the input stream
+    std::size_t                 _inputIndex {0} ;
     /// The underlying event store implementation
     std::shared_ptr<void>       _event {nullptr} ;
     /// The event implementtion type
     std::type_index             _eventType {typeid(nullptr)} ;
     /// The event extensions
     Extensions                  _extensions {} ;
+    /// The event memory arena
+    std::unique_ptr<EventArena> _arena {nullptr} ;
+    /// Whether a skip of the event processing was requested
+    bool                        _skipRequested {false} ;
+    /// The event preparation task
+    std::unique_ptr<concurrency::TaskGroup> _preparation {nullptr} ;
   };
 
   //--------------------------------------------------------------------------
@@ -126,6 +192,18 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  inline void EventStore::setInputIndex( std::size_t index ) {
+    _inputIndex = index ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline std::size_t EventStore::inputIndex() const {
+    return _inputIndex ;
+  }
+
+  //--------------------------------------------------------------------------
+
   template <typename T>
   inline std::shared_ptr<T> EventStore::event() const {
     return std::static_pointer_cast<T>( _event ) ;
@@ -202,4 +280,49 @@ namespace marlin {
     return _extensions ;
   }
 
+  //--------------------------------------------------------------------------
+
+  inline EventArena &EventStore::arena() {
+    if( nullptr == _arena ) {
+      _arena.reset( new EventArena( ArenaPool::workerPool( WorkerLocalBase::currentWorkerIndex() ) ) ) ;
+    }
+    return *_arena ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline void EventStore::releaseArena() {
+    _arena.reset() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline void EventStore::requestSkip() {
+    _skipRequested = true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline void EventStore::prepare( concurrency::TaskQueue &queue, std::function<void()> task ) {
+    if( nullptr == _preparation ) {
+      _preparation = std::make_unique<concurrency::TaskGroup>( queue ) ;
+    }
+    _preparation->run( std::move( task ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline void EventStore::waitPreparation() {
+    if( nullptr != _preparation ) {
+      auto preparation = std::move( _preparation ) ;
+      preparation->wait() ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline bool EventStore::skipRequested() const {
+    return _skipRequested ;
+  }
+
 }
@@ -0,0 +1,154 @@
+#ifndef MARLIN_EVENTWATCHDOG_h
+#define MARLIN_EVENTWATCHDOG_h 1
+
+// -- std headers
+#include <vector>
+#include <memory>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+// -- marlin headers
+#include <marlin/Logging.h>
+#include <marlin/Utils.h>
+
+namespace marlin {
+
+  class CancellationExtension ;
+
+  /**
+   *  @brief  EventWatchdog class
+   *  Watches the wall time spent by the workers on their current event and
+   *  processor. A watchdog thread wakes up periodically and, when the event
+   *  budget or the budget of the running processor is exceeded, sets the
+   *  cooperative cancellation flag of the event (see CancellationExtension).
+   *  The processor is expected to poll the flag (ProcessorApi::cancelled())
+   *  and give up. The sequence then skips the rest of the event, counting it
+   *  in the skipped event statistics. A processor ignoring the flag can't be
+   *  interrupted: the event is skipped once the processor returns.
+   *  Each worker reports to its own slot, so the locks are only contended
+   *  by the watchdog thread.
+   */
+  class EventWatchdog {
+  public:
+    using Logger = Logging::Logger ;
+
+  public:
+    EventWatchdog() = delete ;
+    EventWatchdog( const EventWatchdog & ) = delete ;
+    EventWatchdog &operator=( const EventWatchdog & ) = delete ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  nslots the number of slots (workers)
+     *  @param  eventBudget the wall time budget of an event, in seconds (0: no budget)
+     *  @param  logger the logger to report cancellations
+     */
+    EventWatchdog( std::size_t nslots, double eventBudget, Logger logger ) ;
+
+    /**
+     *  @brief  Destructor. Stop the watchdog thread
+     */
+    ~EventWatchdog() ;
+
+    /**
+     *  @brief  Start the watchdog thread
+     *
+     *  @param  period the check period, in seconds
+     */
+    void start( double period ) ;
+
+    /**
+     *  @brief  Stop the watchdog thread
+     */
+    void stop() ;
+
+    /**
+     *  @brief  Notify that a worker starts processing an event
+     *
+     *  @param  slot the worker slot
+     *  @param  uid the event unique id
+     *  @param  cancellation the event cancellation flag
+     */
+    void eventStarted( std::size_t slot, std::size_t uid, CancellationExtension *cancellation ) ;
+
+    /**
+     *  @brief  Notify that a worker starts running a processor on its current event
+     *
+     *  @param  slot the worker slot
+     *  @param  name the processor name (must outlive the call)
+     *  @param  budget the processor wall time budget, in seconds (0: no budget)
+     */
+    void processorStarted( std::size_t slot, const std::string &name, double budget ) ;
+
+    /**
+     *  @brief  Notify that a worker is done with its current event
+     *
+     *  @param  slot the worker slot
+     */
+    void eventFinished( std::size_t slot ) ;
+
+    /**
+     *  @brief  Get the number of cancelled events
+     */
+    std::size_t nCancelled() const ;
+
+  private:
+    /**
+     *  @brief  Slot struct
+     *  The current state of a worker
+     */
+    struct Slot {
+      ///< The synchronization mutex
+      std::mutex                 _mutex {} ;
+      ///< The current event cancellation flag (nullptr if idle)
+      CancellationExtension     *_cancellation {nullptr} ;
+      ///< The current event uid
+      std::size_t                _uid {0} ;
+      ///< The event start time
+      clock::time_point          _eventStart {} ;
+      ///< The current processor name
+      const std::string         *_processor {nullptr} ;
+      ///< The current processor start time
+      clock::time_point          _processorStart {} ;
+      ///< The current processor budget
+      double                     _processorBudget {0.} ;
+    };
+
+    /**
+     *  @brief  The watchdog thread loop
+     */
+    void run() ;
+
+    /**
+     *  @brief  Check all slots against their budgets
+     */
+    void check() ;
+
+  private:
+    ///< The worker slots
+    std::vector<std::unique_ptr<Slot>>    _slots {} ;
+    ///< The event budget
+    double                                _eventBudget {0.} ;
+    ///< The logger instance
+    Logger                                _logger {nullptr} ;
+    ///< The check period
+    double                                _period {1.} ;
+    ///< The watchdog thread
+    std::thread                           _thread {} ;
+    ///< The mutex for the stop condition
+    std::mutex                            _mutex {} ;
+    ///< The condition variable to wake up the thread on stop
+    std::condition_variable               _conditionVariable {} ;
+    ///< The stop flag
+    bool                                  _stopFlag {false} ;
+    ///< The number of cancelled events
+    std::atomic<std::size_t>              _nCancelled {0} ;
+  };
+
+}
+
+#endif
@@ -59,6 +59,11 @@ namespace marlin {
      *  @brief  Get the number of free event slots
      */
     virtual std::size_t freeSlots() const = 0 ;
+
+    /**
+     *  @brief  Get the number of workers processing events concurrently
+     */
+    virtual std::size_t concurrency() const = 0 ;
   };
 
 } // end namespace marlin
@@ -0,0 +1,109 @@
+#ifndef MARLIN_INPUTCOLLECTIONS_h
+#define MARLIN_INPUTCOLLECTIONS_h 1
+
+// -- std headers
+#include <string>
+#include <vector>
+#include <set>
+
+namespace marlin {
+
+  /**
+   *  @brief  InputCollections class
+   *  The event collections used by the active processors, so that the data
+   *  source can read only them. The processors input collections, declared
+   *  with registerInputCollection(s), are added at processor initialization.
+   *  Processors using all the collections of the event (e.g output or dump)
+   *  add an "all collections" entry, with the collections they don't need.
+   *  A processor declaring nothing at all may use any collection: the
+   *  collections can be selected only if no such processor is active.
+   */
+  class InputCollections {
+  public:
+    using NameSet = std::set<std::string> ;
+
+  private:
+    /**
+     *  @brief  AllCollections struct
+     *  A processor using all collections, except some names and types
+     */
+    struct AllCollections {
+      ///< The collection names not used
+      NameSet                   _exceptNames {} ;
+      ///< The collection types not used
+      NameSet                   _exceptTypes {} ;
+    };
+
+  public:
+    /**
+     *  @brief  Add collections used by a processor. The processor has
+     *  declared its inputs, even if the list is empty
+     *
+     *  @param  processor the processor name
+     *  @param  names the collection names
+     */
+    void addCollections( const std::string &processor, const std::vector<std::string> &names ) ;
+
+    /**
+     *  @brief  Add a processor using all the collections of the event
+     *
+     *  @param  processor the processor name
+     *  @param  exceptNames the collection names not used by the processor
+     *  @param  exceptTypes the collection types not used by the processor
+     */
+    void addAllCollections( const std::string &processor, const NameSet &exceptNames = {}, const NameSet &exceptTypes = {} ) ;
+
+    /**
+     *  @brief  Add an active processor. Unless it declares its inputs (see
+     *  addCollections() and addAllCollections()), it may use any collection
+     *
+     *  @param  processor the processor name
+     */
+    void addProcessor( const std::string &processor ) ;
+
+    /**
+     *  @brief  Get the active processors not declaring their inputs (see addProcessor()).
+     *  If not empty, all the collections have to be read
+     */
+    NameSet undeclaredProcessors() const ;
+
+    /**
+     *  @brief  Whether no collection has been declared at all.
+     *  In this case, nothing is known about the collections to read
+     */
+    bool empty() const ;
+
+    /**
+     *  @brief  Whether a processor uses all the collections (see addAllCollections()).
+     *  The collection names are then not enough to know which collections to read:
+     *  use isUsed() with the collections of the input
+     */
+    bool allCollections() const ;
+
+    /**
+     *  @brief  Get the names of the used collections (see addCollections())
+     */
+    const NameSet &names() const ;
+
+    /**
+     *  @brief  Whether a collection is used by a processor
+     *
+     *  @param  name the collection name
+     *  @param  type the collection type
+     */
+    bool isUsed( const std::string &name, const std::string &type ) const ;
+
+  private:
+    ///< The used collection names
+    NameSet                      _names {} ;
+    ///< The processors using all collections
+    std::vector<AllCollections>  _allCollections {} ;
+    ///< The active processors
+    NameSet                      _processors {} ;
+    ///< The processors having declared their inputs
+    NameSet                      _declaredProcessors {} ;
+  };
+
+}
+
+#endif
@@ -28,11 +28,23 @@
 // geometry plugin declaration
 #define MARLIN_DECLARE_GEOPLUGIN_NAME( Class, NameStr ) MARLIN_DECLARE_PLUGIN( Class, NameStr, marlin::PluginType::GeometryPlugin )
 #define MARLIN_DECLARE_GEOPLUGIN( Class ) MARLIN_DECLARE_GEOPLUGIN_NAME( Class, #Class )
-// processor plugin declaration
-#define MARLIN_DECLARE_PROCESSOR( Class ) namespace { \
-  static const auto __type__ = Class().type() ; \
-  MARLIN_DECLARE_PLUGIN( Class, __type__, marlin::PluginType::Processor ) \
-}
+// processor plugin declaration.
+// The processor type is resolved lazily, by instantiating the processor when
+// a processor not registered yet is queried, never while loading the libraries.
+// Use MARLIN_DECLARE_PROCESSOR_NAME (type given as string) to avoid the instantiation
+#define MARLIN_DECLARE_PROCESSOR( Class ) \
+  namespace marlin_plugins { \
+    struct PluginDeclaration_##Class { \
+      PluginDeclaration_##Class() { \
+        marlin::PluginManager::instance().registerPlugin( marlin::PluginType::Processor, \
+          [](){ return std::string( Class().type() ) ; }, \
+          [](){ return std::static_pointer_cast<void>( std::make_shared<Class>() ) ; }, \
+          false ) ; \
+      } \
+    }; \
+    static PluginDeclaration_##Class __instance_##Class ; \
+  }
+#define MARLIN_DECLARE_PROCESSOR_NAME( Class, NameStr ) MARLIN_DECLARE_PLUGIN( Class, NameStr, marlin::PluginType::Processor )
 
 // data source plugin declaration
 #define MARLIN_DECLARE_DATASOURCE_NAME( Class, NameStr ) MARLIN_DECLARE_PLUGIN( Class, NameStr, marlin::PluginType::DataSource )
@@ -60,19 +72,46 @@ namespace marlin {
    *  processor factory instances. Processor instances can be
    *  created from factories using the PluginManager::create()
    *  method on query.
+   *
+   *  If the environment variable MARLIN_PLUGIN_MANIFEST points to an
+   *  up-to-date plugin manifest (see writeManifest()), the libraries
+   *  are not loaded by loadLibraries() but on first query of a plugin
+   *  they provide. Libraries providing no plugin are loaded immediately.
    */
   class PluginManager {
   public:
     // typedefs
     typedef std::shared_ptr<void>                       PluginPtr ;
     typedef std::function<PluginPtr()>                  FactoryFunction ;
+    typedef std::function<std::string()>                NameFunction ;
     typedef std::map<std::string, FactoryFunction>      FactoryMap ;
     typedef std::map<PluginType, FactoryMap>            PluginFactoryMap ;
     typedef std::vector<void*>                          LibraryList ;
+    typedef std::map<std::string, std::string>          NameLibraryMap ;
+    typedef std::map<PluginType, NameLibraryMap>        PluginLibraryMap ;
     typedef Logging::Logger                             Logger ;
     typedef std::recursive_mutex                        mutex_type ;
     typedef std::lock_guard<mutex_type>                 lock_type ;
 
+  private:
+    /**
+     *  @brief  PendingPlugin struct
+     *  A plugin registered without name. The name is resolved on first query
+     */
+    struct PendingPlugin {
+      ///< The plugin type
+      PluginType         _type {} ;
+      ///< The function returning the plugin name
+      NameFunction       _nameFunction {} ;
+      ///< The plugin factory function
+      FactoryFunction    _factoryFunction {} ;
+      ///< Whether to ignore duplicate entries
+      bool               _ignoreDuplicate {true} ;
+      ///< The library providing the plugin
+      std::string        _library {} ;
+    };
+    typedef std::vector<PendingPlugin>                  PendingPluginList ;
+
   private:
     PluginManager(const PluginManager &) = delete ;
     PluginManager& operator=(const PluginManager &) = delete ;
@@ -119,11 +158,36 @@ namespace marlin {
       FactoryFunction factoryFunction, bool ignoreDuplicate = true ) ;
 
     /**
-     *  @brief  Load shared libraries to populate the list of plugins
+     *  @brief  Register a new plugin to the manager with a deferred name.
+     *  The name function is called on first query of the plugins (create(),
+     *  pluginNames(), etc...) and not at registration time.
+     *  See overloaded function description for more details
+     *
+     *  @param  type the plugin type
+     *  @param  nameFunction the function returning the plugin name
+     *  @param  factoryFunction the factory function responsible for the plugin creation
+     *  @param  ignoreDuplicate whether to avoid exception throw in case of duplicate entry
+     */
+    void registerPlugin( PluginType type, NameFunction nameFunction,
+      FactoryFunction factoryFunction, bool ignoreDuplicate = true ) ;
+
+    /**
+     *  @brief  Load shared libraries to populate the list of plugins.
+     *  If a valid plugin manifest is found (see manifestvar), the libraries
+     *  are loaded lazily on plugin query.
      *
      *  @param  envvar the environment variable to load the libraries from
+     *  @param  manifestvar the environment variable pointing to the plugin manifest
      */
-    bool loadLibraries( const std::string &envvar = "MARLIN_DLL" ) ;
+    bool loadLibraries( const std::string &envvar = "MARLIN_DLL", const std::string &manifestvar = "MARLIN_PLUGIN_MANIFEST" ) ;
+
+    /**
+     *  @brief  Write the plugin manifest: the list of loaded libraries and the
+     *  plugins they provide. Plugins built in the Marlin library are not written.
+     *
+     *  @param  fname the manifest file name
+     */
+    void writeManifest( const std::string &fname ) const ;
 
     /**
      *  @brief  Get all registered plugin name for the given type
@@ -170,11 +234,88 @@ namespace marlin {
      */
     static std::string pluginTypeToString( PluginType type ) ;
 
+    /**
+     *  @brief  Convert a string to plugin type
+     *
+     *  @param  str the plugin type as string
+     */
+    static PluginType stringToPluginType( const std::string &str ) ;
+
+    /**
+     *  @brief  Find a plugin factory. Load the library providing the plugin
+     *  and resolve pending plugins if needed. Returns nullptr if not found
+     *
+     *  @param  type the plugin type
+     *  @param  name the plugin name
+     */
+    FactoryFunction findFactory( PluginType type, const std::string &name ) const ;
+
+    /**
+     *  @brief  Insert a plugin factory in the registry
+     *
+     *  @param  type the plugin type
+     *  @param  name the plugin name
+     *  @param  factoryFunction the factory function
+     *  @param  ignoreDuplicate whether to avoid exception throw in case of duplicate entry
+     *  @param  library the library providing the plugin
+     */
+    void insertFactory( PluginType type, const std::string &name,
+      FactoryFunction factoryFunction, bool ignoreDuplicate, const std::string &library ) const ;
+
+    /**
+     *  @brief  Resolve the names of the pending plugins and insert them in the registry.
+     *  All the plugins are inserted first, then the errors (e.g duplicate entries) are thrown
+     */
+    void resolvePendingPlugins() const ;
+
+    /**
+     *  @brief  Resolve the names of the pending plugins, in registration order, until
+     *  the given plugin is found, so that only the plugins before it are instantiated.
+     *  The errors of the resolved plugins are thrown after inserting them.
+     *  Returns whether the plugin was found
+     *
+     *  @param  type the plugin type
+     *  @param  name the plugin name
+     */
+    bool resolvePendingPlugin( PluginType type, const std::string &name ) const ;
+
+    /**
+     *  @brief  Load a shared library. Returns false on failure
+     *
+     *  @param  library the library path
+     */
+    bool loadLibrary( const std::string &library ) const ;
+
+    /**
+     *  @brief  Load all the libraries not yet loaded from the manifest
+     */
+    void loadAllLibraries() const ;
+
+    /**
+     *  @brief  Read the plugin manifest. Returns false if the manifest
+     *  can't be read or doesn't match the list of libraries
+     *
+     *  @param  fname the manifest file name
+     *  @param  libraries the list of libraries to load
+     */
+    bool readManifest( const std::string &fname, const std::vector<std::string> &libraries ) ;
+
   private:
+    // Note: the registry is populated lazily, also from const queries
     /// The map of plugin factories
-    PluginFactoryMap           _pluginFactories {} ;
+    mutable PluginFactoryMap   _pluginFactories {} ;
+    /// The plugins registered with a deferred name
+    mutable PendingPluginList  _pendingPlugins {} ;
+    /// The libraries providing the plugins (from registration or manifest)
+    mutable PluginLibraryMap   _pluginLibraries {} ;
+    /// The libraries known from the manifest but not loaded yet
+    mutable std::vector<std::string> _lazyLibraries {} ;
+    /// The library being currently loaded
+    mutable std::string        _currentLibrary {} ;
+    /// The list of loaded libraries (paths)
+    mutable std::vector<std::string> _libraryNames {} ;
     /// The list of loaded libraries
-    LibraryList                _libraries {} ;
+    mutable LibraryList        _libraries {} ;
     /// The plugin manager logger
     mutable Logger             _logger {nullptr} ;
     /// The synchronization mutex
@@ -198,15 +339,14 @@ namespace marlin {
   template <typename T>
   inline std::shared_ptr<T> PluginManager::create( PluginType type, const std::string &name ) const {
     lock_type lock( _mutex ) ;
-    auto typeIter = _pluginFactories.find( type ) ;
-    auto factoryIter = typeIter->second.find( name ) ;
+    auto factory = findFactory( type, name ) ;
     // plugin not found ?
-    if ( typeIter->second.end() == factoryIter ) {
+    if ( nullptr == factory ) {
       auto typeStr = pluginTypeToString( type ) ;
       _logger->log<DEBUG5>() << "Plugin not found: type '" << typeStr << "', name '" << name << "'" << std::endl ;
       return nullptr ;
     }
-    auto pointer = factoryIter->second() ; // factory function call
+    auto pointer = factory() ; // factory function call
     return std::static_pointer_cast<T, void>( pointer ) ;
   }
 
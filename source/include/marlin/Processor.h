@@ -20,6 +20,7 @@ namespace marlin {
 
   class Application ;
   class ProcessorApi ;
+  class WorkerLocalBase ;
 
   /**
    *  @brief  Processor class
@@ -100,6 +101,41 @@ namespace marlin {
      */
     virtual void end() { /* nop */ }
 
+    /**
+     *  @brief  Create a replica of this processor (opt-in).
+     *
+     *  Called by the framework on the fully initialized processor (after init())
+     *  when the processor is cloned in each worker thread. The replica must be a
+     *  new instance of the same type, ready to process events: init() is NOT
+     *  called on it. Expensive immutable state built in init() (lookup tables,
+     *  calibration maps, ...) should be shared with the replica (e.g using
+     *  std::shared_ptr<const T>) and only the mutable state copied.
+     *  The framework sets the parameters, the logger and the application
+     *  on the replica after this call. Note that this method might be called
+     *  concurrently on the same instance.
+     *
+     *  Registrations done in init():
+     *  - random seeds (ProcessorApi::registerForRandomSeeds()) are per instance:
+     *    the framework registers the replica if this processor is registered
+     *  - event filters, input collections, checkpoints and booked histograms are
+     *    shared by name: the registrations of this processor apply to the replica.
+     *    Copy the histogram references to the replica
+     *  - worker local storages (ProcessorApi::workerLocal()) belong to this
+     *    processor: they are not visible from the replica
+     *
+     *  The default implementation returns nullptr, meaning that clones are
+     *  created from scratch and initialized by calling init().
+     *  Example:
+     *  @code{cpp}
+     *  std::shared_ptr<Processor> clone() const override {
+     *    auto replica = std::make_shared<MyProcessor>() ;
+     *    replica->_lookupTable = _lookupTable ; // shared_ptr<const Table>
+     *    return replica ;
+     *  }
+     *  @endcode
+     */
+    virtual std::shared_ptr<Processor> clone() const { return nullptr ; }
+
     /**
      *  @brief  Return type name for the processor (as set in constructor).
      */
@@ -159,6 +195,19 @@ namespace marlin {
     /** Sets the registered steering parameters before calling init() */
     void baseInit( Application *application ) ;
 
+    /**
+     *  @brief  Create a replica of this (initialized) processor using clone().
+     *  The parameters, the logger and the application are set on the replica.
+     *  Returns nullptr if the processor doesn't support replication
+     */
+    std::shared_ptr<Processor> baseClone() const ;
+
+    /**
+     *  @brief  Call the reduce functions of the worker local
+     *  storages (see ProcessorApi::workerLocal) and then end()
+     */
+    void baseEnd() ;
+
     /** Initialize the parameters */
     void setParameters( std::shared_ptr<StringParameters> parameters) ;
 
@@ -262,6 +311,13 @@ namespace marlin {
     Application &app() ;
 
   private:
+    /**
+     *  @brief  Set the application and create the processor logger
+     *
+     *  @param  application the application in which the processor runs
+     */
+    void baseSetup( Application *application ) ;
+
     /** Allow friend class CCProcessor to change/reset processor parameters */
     virtual void setProcessorParameters( std::shared_ptr<StringParameters> processorParameters) ;
 
@@ -290,6 +346,8 @@ namespace marlin {
     Application                       *_application {nullptr} ;
     /// The user forced runtime options for parallel processing
     RuntimeOptions                     _forcedRuntimeOptions {} ;
+    /// The worker local storages, by type hash and name. See ProcessorApi::workerLocal
+    std::map<std::pair<unsigned long long, std::string>, std::shared_ptr<WorkerLocalBase>> _workerLocals {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -3,12 +3,19 @@
 
 // -- std headers
 #include <string>
+#include <memory>
+#include <functional>
+#include <set>
+#include <vector>
 
 // -- marlin headers
 #include <marlin/Processor.h>
 #include <marlin/Application.h>
 #include <marlin/GeometryManager.h>
 #include <marlin/MarlinConfig.h>
+#include <marlin/WorkerLocal.h>
+#include <marlin/concurrency/TaskGroup.h>
+#include <marlin/Utils.h>
 
 namespace marlin {
 
@@ -93,6 +100,71 @@ namespace marlin {
      */
     static void skipCurrentEvent( const Processor *const proc ) ;
 
+    /**
+     *  @brief  Skip the rest of the event processing without throwing.
+     *  The next processors in the sequence are not called. The processor
+     *  should return from processEvent() right after this call. Much cheaper
+     *  than skipCurrentEvent() for filters rejecting most of the events:
+     *  no exception and only a debug log message
+     *  @code{cpp}
+     *  if( not selected ) {
+     *    ProcessorApi::skipEvent( this, event ) ;
+     *    return ;
+     *  }
+     *  @endcode
+     *
+     *  @param  proc the processor instance initiating the call
+     *  @param  event the current event
+     */
+    static void skipEvent( const Processor *const proc, EventStore *event ) ;
+
+    /**
+     *  @brief  Register an event filter equivalent to the processor return value,
+     *  evaluated on the event header (run and event numbers). If the processor is
+     *  the first active one and the next processors only run if it returns true,
+     *  the filter is pushed down to the data source and the rejected events are not
+     *  even built. Call it in your processor init() function
+     *
+     *  @param  proc the processor instance
+     *  @param  filter the event filter
+     */
+    static void registerEventFilter( Processor *const proc, EventFilter filter ) ;
+
+    /**
+     *  @brief  Declare collections used by the processor, in addition to the input
+     *  collections registered as parameters (registerInputCollection(s)), which are
+     *  declared automatically. The data source may read only the declared collections.
+     *  A processor declaring nothing at all may use any collection: all the collections
+     *  are then read
+     *
+     *  @param  proc the processor instance
+     *  @param  names the collection names (empty if the processor uses no collection)
+     */
+    static void requireCollections( Processor *const proc, const std::vector<std::string> &names ) ;
+
+    /**
+     *  @brief  Declare that the processor uses all the collections of the events
+     *  (e.g to write or dump them), except the given names and types
+     *
+     *  @param  proc the processor instance
+     *  @param  exceptNames the collection names not used by the processor
+     *  @param  exceptTypes the collection types not used by the processor
+     */
+    static void requireAllCollections( Processor *const proc, const std::set<std::string> &exceptNames = {}, const std::set<std::string> &exceptTypes = {} ) ;
+
+    /**
+     *  @brief  Register the processor to the job checkpoints (global parameter CheckpointFile),
+     *  e.g to save the size of an output file. At each checkpoint, the save function gets the
+     *  input index below which all events are committed and returns the processor state after
+     *  these events only. When the job is resumed, the restore function gets the saved state
+     *  (empty if none) immediately. Call it in your processor init() function
+     *
+     *  @param  proc the processor instance
+     *  @param  save the function returning the state to save
+     *  @param  restore the function restoring a saved state
+     */
+    static void registerCheckpoint( Processor *const proc, Checkpoint::SaveFunction save, Checkpoint::RestoreFunction restore ) ;
+
     /**
      *  @brief  Abort program execution properly
      *
@@ -100,6 +172,128 @@ namespace marlin {
      *  @param  reason the reason why the processor aborts the program
      */
     static void abort( const Processor *const proc, const std::string &reason ) ;
+
+    /**
+     *  @brief  Whether the event watchdog requested the cancellation of the event,
+     *  because the event or processor time budget is exceeded. Cheap enough to
+     *  be polled in the processor loops
+     *
+     *  @param  event the current event
+     */
+    static bool cancelled( EventStore *event ) ;
+
+    /**
+     *  @brief  Acknowledge the cancellation of the event, if requested: log it
+     *  and skip the event (see skipCurrentEvent()). Does nothing otherwise
+     *  @code{cpp}
+     *  for( auto seed : seeds ) {
+     *    ProcessorApi::checkCancelled( this, event ) ;
+     *    // long pattern recognition ...
+     *  }
+     *  @endcode
+     *
+     *  @param  proc the processor instance
+     *  @param  event the current event
+     */
+    static void checkCancelled( const Processor *const proc, EventStore *event ) ;
+
+    /**
+     *  @brief  Get the worker local storage of type T of the processor.
+     *  The storage holds one instance of T per worker thread, allocated on
+     *  first access by the worker itself. Call it in your processor init()
+     *  and keep the reference: the lookup is not thread safe.
+     *  Several storages of the same type are distinguished by name.
+     *  See WorkerLocal for details
+     *
+     *  @param  proc the processor instance owning the storage
+     *  @param  factory an optional factory function creating the worker instances.
+     *  Throws if the storage already exists
+     *  @param  name the storage name, to hold several storages of the same type
+     */
+    template <typename T>
+    static WorkerLocal<T> &workerLocal( Processor *const proc, typename WorkerLocal<T>::Factory factory = nullptr, const std::string &name = "" ) ;
+
+    /**
+     *  @brief  Book a 1D histogram in the application book store.
+     *  The histogram path is "<processor name>/<name>". Filling is lock free,
+     *  so the processor doesn't need to be critical or cloned. See BookStore
+     *
+     *  @param  proc the processor instance booking the histogram
+     *  @param  name the histogram name
+     *  @param  title the histogram title
+     *  @param  axis the x axis
+     */
+    static Histogram1D &book1D( Processor *const proc, const std::string &name, const std::string &title, const HistogramAxis &axis ) ;
+
+    /**
+     *  @brief  Book a 2D histogram in the application book store. See book1D()
+     *
+     *  @param  proc the processor instance booking the histogram
+     *  @param  name the histogram name
+     *  @param  title the histogram title
+     *  @param  xaxis the x axis
+     *  @param  yaxis the y axis
+     */
+    static Histogram2D &book2D( Processor *const proc, const std::string &name, const std::string &title, const HistogramAxis &xaxis, const HistogramAxis &yaxis ) ;
+
+    /**
+     *  @brief  Book a 1D profile in the application book store. See book1D()
+     *
+     *  @param  proc the processor instance booking the profile
+     *  @param  name the profile name
+     *  @param  title the profile title
+     *  @param  axis the x axis
+     */
+    static Profile1D &bookProfile1D( Processor *const proc, const std::string &name, const std::string &title, const HistogramAxis &axis ) ;
+
+    /**
+     *  @brief  Run a function over the range [begin, end) in parallel, on the
+     *  workers of the framework thread pool. The range is split in chunks of
+     *  grain elements and the function is called as fn(first, last) for each
+     *  chunk. The calling thread processes chunks too and returns once all
+     *  chunks are done. Without idle worker (or with the simple scheduler),
+     *  all chunks run in the calling thread. Rethrows the first exception.
+     *  The chunks may run in any worker thread: don't use worker local
+     *  storage (see workerLocal()) inside the function.
+     *  @code{cpp}
+     *  ProcessorApi::parallelFor( this, 0, hits.size(), 64, [&]( std::size_t first, std::size_t last ) {
+     *    for( auto i=first ; i<last ; ++i ) {
+     *      calibrate( hits[i] ) ;
+     *    }
+     *  }) ;
+     *  @endcode
+     *
+     *  @param  proc the processor instance
+     *  @param  begin the range begin
+     *  @param  end the range end
+     *  @param  grain the number of elements per chunk
+     *  @param  fn the function to run on each chunk
+     */
+    template <typename FUNCTION>
+    static void parallelFor( const Processor *const proc, std::size_t begin, std::size_t end, std::size_t grain, FUNCTION fn ) ;
+
+    /**
+     *  @brief  Run a function asynchronously on the workers of the framework
+     *  thread pool. The returned task group can run more functions and must be
+     *  waited with wait() before the end of the current processor call. While
+     *  waiting, the calling thread runs pending tasks itself, so it never
+     *  deadlocks. The task group destructor waits too, but drops exceptions.
+     *  The same restrictions as for parallelFor() apply
+     *
+     *  @param  proc the processor instance
+     *  @param  fn the function to run
+     */
+    static std::unique_ptr<concurrency::TaskGroup> spawn( const Processor *const proc, std::function<void()> fn ) ;
+
+    /**
+     *  @brief  Get the memory arena of the event, for transient per-event data.
+     *  The memory is given back at once when the event is retired, so
+     *  deallocations are free. Only use it from the thread processing the event.
+     *  See EventArena
+     *
+     *  @param  event the event store
+     */
+    static std::pmr::memory_resource *eventArena( EventStore *event ) ;
   };
 
   //--------------------------------------------------------------------------
@@ -110,6 +304,29 @@ namespace marlin {
     return proc->app().geometryManager().geometry<T>() ;
   }
 
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline WorkerLocal<T> &ProcessorApi::workerLocal( Processor *const proc, typename WorkerLocal<T>::Factory factory, const std::string &name ) {
+    const auto key = std::make_pair( HashHelper::typeHash64<T>(), name ) ;
+    auto iter = proc->_workerLocals.find( key ) ;
+    if( proc->_workerLocals.end() == iter ) {
+      auto storage = std::make_shared<WorkerLocal<T>>( proc->app().concurrency(), factory ) ;
+      iter = proc->_workerLocals.insert( { key, storage } ).first ;
+    }
+    else if( nullptr != factory ) {
+      MARLIN_THROW( "Worker local storage '" + name + "' already created: factory not used. Use a different name" ) ;
+    }
+    return *std::static_pointer_cast<WorkerLocal<T>>( iter->second ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename FUNCTION>
+  inline void ProcessorApi::parallelFor( const Processor *const proc, std::size_t begin, std::size_t end, std::size_t grain, FUNCTION fn ) {
+    concurrency::parallelFor( proc->app().taskQueue(), begin, end, grain, fn ) ;
+  }
+
 }
 
 #endif
@@ -5,6 +5,7 @@
 #include <map>
 #include <random>
 #include <memory>
+#include <mutex>
 #include <functional>
 #include <unordered_set>
 
@@ -57,6 +58,13 @@ namespace marlin {
      */
     void addEntry( HashArgument arg ) ;
 
+    /**
+     *  @brief  Whether an entry is registered in the random seed manager
+     *
+     *  @param  arg the entry argument (e.g a processor pointer)
+     */
+    bool hasEntry( HashArgument arg ) const ;
+
     /**
      *  @brief  Generate a random seed map.
      *  Mainly used by the whiteboard to get random seeds
@@ -66,6 +74,20 @@ namespace marlin {
      */
     std::unique_ptr<RandomSeedMap> generateRandomSeeds( const EventStore * const evt ) ;
 
+    /**
+     *  @brief  Get the global seed. The event seeds are derived
+     *  from the global seed and the event uid
+     */
+    SeedType globalSeed() const ;
+
+    /**
+     *  @brief  Set the global seed, e.g from the steering file or
+     *  to resume a job from a checkpoint
+     *
+     *  @param  seed the global seed
+     */
+    void setGlobalSeed( SeedType seed ) ;
+
   private:
     /**
      *  @brief  Get a new random number from the internal generator
@@ -77,6 +99,8 @@ namespace marlin {
     SeedType                _globalSeed {0} ;
     /// The entry list
     EntryList               _entryList {} ;
+    /// The mutex protecting the entry list (entries may be added from parallel processor init)
+    mutable std::mutex      _mutex {} ;
     /// The random generator engine
     RandomGenerator         _generator {_globalSeed} ;
     /// The random number distribution
@@ -0,0 +1,163 @@
+#ifndef MARLIN_RUNTIMECALIBRATION_h
+#define MARLIN_RUNTIMECALIBRATION_h 1
+
+// -- std headers
+#include <string>
+#include <vector>
+#include <map>
+#include <cstddef>
+
+namespace marlin {
+
+  /**
+   *  @brief  RuntimeCalibration class
+   *  Proposes the processor runtime options (ProcessorClone, ProcessorCritical)
+   *  from the measurements of a calibration run: the processing time per
+   *  event, the lock wait fraction and the memory used per processor instance.
+   *
+   *  A cloned processor costs one instance per worker. Sharing a single
+   *  critical instance saves (N-1) instances but serializes the processor.
+   *  With N workers and a mean event time T, a critical processor taking t
+   *  per event is busy a fraction rho = N*t/T of the time. The proposals are:
+   *
+   *  - cloned and critical: the clones are serialized anyway, share a single
+   *    critical instance,
+   *  - cloned, not critical: share a single critical instance if an instance
+   *    uses a significant amount of memory and rho is low,
+   *  - otherwise: keep the options. A critical processor is never made non
+   *    critical, as it may not be thread safe. A high load or lock fraction
+   *    is reported in the proposal reason.
+   *
+   *  Forced runtime options (see Processor::forceRuntimeOption()) are kept.
+   *  The proposals are written as a steering file patch: a list of processor
+   *  sections that can be copied in the steering file or read back by setting
+   *  the processor runtime options to "auto".
+   */
+  class RuntimeCalibration {
+  public:
+    /**
+     *  @brief  Settings struct
+     */
+    struct Settings {
+      ///< The number of workers of the calibration run
+      std::size_t        _concurrency {1} ;
+      ///< The maximum load of a processor turned critical
+      double             _maxCriticalLoad {0.25} ;
+      ///< The lock wait fraction above which a critical processor is reported as a bottleneck
+      double             _maxLockFraction {0.05} ;
+      ///< The memory per instance (bytes) above which a processor is worth sharing
+      std::size_t        _minInstanceMemory {16*1024*1024} ;
+    };
+
+    /**
+     *  @brief  Measurement struct
+     *  The calibration measurements of a processor (all instances)
+     */
+    struct Measurement {
+      ///< The processor name
+      std::string        _name {} ;
+      ///< Whether the processor is cloned
+      bool               _clone {true} ;
+      ///< Whether the processor is critical
+      bool               _critical {false} ;
+      ///< Whether the clone option is forced by the processor
+      bool               _cloneForced {false} ;
+      ///< Whether the critical option is forced by the processor
+      bool               _criticalForced {false} ;
+      ///< The total time spent in processEvent() (seconds)
+      double             _procTime {0.} ;
+      ///< The total time spent in processEvent(), lock wait included (seconds)
+      double             _appTime {0.} ;
+      ///< The number of processed events
+      std::size_t        _events {0} ;
+      ///< The mean memory used per processor instance (bytes)
+      double             _instanceMemory {0.} ;
+    };
+
+    /**
+     *  @brief  Options struct
+     *  The proposed runtime options of a processor
+     */
+    struct Options {
+      ///< Whether to clone the processor
+      bool               _clone {true} ;
+      ///< Whether the processor is critical
+      bool               _critical {false} ;
+      ///< A human readable explanation of the proposal
+      std::string        _reason {} ;
+    };
+
+    using OptionsMap = std::map<std::string, Options> ;
+
+  public:
+    RuntimeCalibration() = delete ;
+    ~RuntimeCalibration() = default ;
+    RuntimeCalibration( const RuntimeCalibration & ) = delete ;
+    RuntimeCalibration &operator=( const RuntimeCalibration & ) = delete ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  settings the calibration settings
+     */
+    RuntimeCalibration( const Settings &settings ) ;
+
+    /**
+     *  @brief  Add the measurements of a processor
+     *
+     *  @param  measurement the processor measurements
+     */
+    void addMeasurement( const Measurement &measurement ) ;
+
+    /**
+     *  @brief  Get the measurements in insertion order
+     */
+    const std::vector<Measurement> &measurements() const ;
+
+    /**
+     *  @brief  Get the mean event time of a worker (seconds), lock wait included
+     */
+    double eventTime() const ;
+
+    /**
+     *  @brief  Propose the runtime options of a processor
+     *
+     *  @param  measurement the processor measurements
+     */
+    Options propose( const Measurement &measurement ) const ;
+
+    /**
+     *  @brief  Propose the runtime options of all processors
+     */
+    OptionsMap proposeAll() const ;
+
+    /**
+     *  @brief  Write the proposals as a steering file patch
+     *
+     *  @param  fname the output file name
+     *  @param  options the proposals
+     */
+    void writeSteeringPatch( const std::string &fname, const OptionsMap &options ) const ;
+
+    /**
+     *  @brief  Read the proposals from a steering file patch
+     *
+     *  @param  fname the input file name
+     */
+    static OptionsMap readSteeringPatch( const std::string &fname ) ;
+
+    /**
+     *  @brief  Get the resident memory of the process (bytes), 0 if unknown
+     */
+    static std::size_t residentMemory() ;
+
+  private:
+    ///< The calibration settings
+    Settings                   _settings {} ;
+    ///< The processor measurements
+    std::vector<Measurement>   _measurements {} ;
+  };
+
+}
+
+#endif
@@ -13,6 +13,8 @@
 // -- marlin headers
 #include <marlin/Logging.h>
 #include <marlin/Utils.h>
+#include <marlin/EventWatchdog.h>
+#include <marlin/RuntimeCalibration.h>
 
 namespace marlin {
 
@@ -23,6 +25,10 @@ namespace marlin {
   class EventStore ;
   class RunHeader ;
 
+  namespace concurrency {
+    class TaskQueue ;
+  }
+
   //--------------------------------------------------------------------------
   //--------------------------------------------------------------------------
 
@@ -77,6 +83,28 @@ namespace marlin {
      */
     // clock::pair modifyEvent( std::shared_ptr<EVENT::LCEvent> event ) ;
 
+    /**
+     *  @brief  Call Processor::baseInit(). Lock if the mutex has been initialized.
+     *  Returns the time spent in the call (excluding the lock waiting time)
+     *
+     *  @param  app the application in which the processor runs
+     */
+    clock::duration_rep init( Application *app ) ;
+
+    /**
+     *  @brief  Call Processor::end(). Lock if the mutex has been initialized.
+     */
+    void end() ;
+
+    /**
+     *  @brief  Replace the processor by a replica of another (initialized) processor
+     *  if it supports replication (see Processor::clone()). Returns the time spent
+     *  in the replication or a negative value if not supported.
+     *
+     *  @param  prototype the prototype item to replicate from
+     */
+    clock::duration_rep replicate( const SequenceItem &prototype ) ;
+
     /**
      *  @brief  Get the processor instance
      */
@@ -87,11 +115,30 @@ namespace marlin {
      */
     const std::string &name() const ;
 
+    /**
+     *  @brief  Set the wall time budget of the processor per event (see EventWatchdog)
+     *
+     *  @param  budget the time budget in seconds (0: no budget)
+     */
+    void setTimeBudget( double budget ) ;
+
+    /**
+     *  @brief  Get the wall time budget of the processor per event, in seconds
+     */
+    double timeBudget() const ;
+
+    /**
+     *  @brief  Whether the processor calls are serialized (ProcessorCritical)
+     */
+    bool critical() const ;
+
   private:
     ///< The processor instance
     std::shared_ptr<Processor>     _processor {nullptr} ;
     ///< The mutex instance
     std::shared_ptr<std::mutex>    _mutex {nullptr} ;
+    ///< The processor time budget per event
+    double                         _timeBudget {0.} ;
   };
 
   //--------------------------------------------------------------------------
@@ -134,11 +181,22 @@ namespace marlin {
     using SkippedEventMap = std::map<std::string, int> ;
 
   public:
-    Sequence() = default ;
     ~Sequence() = default ;
     Sequence &operator=(const Sequence &) = delete ;
     Sequence(const Sequence &) = delete ;
 
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  index the sequence index, also used as worker index (see WorkerLocal)
+     */
+    Sequence( Index index = 0 ) ;
+
+    /**
+     *  @brief  Get the sequence index
+     */
+    Index index() const ;
+
   public:
     /**
      *  @brief  Create a sequence item. The item is not added.
@@ -193,17 +251,50 @@ namespace marlin {
     const ClockMeasureMap &clockMeasures() const ;
 
     /**
-     *  @brief  Get all the skipped events of the sequence
+     *  @brief  Get the clock measurement summed over all items,
+     *  updated after each processed event. Cheaper than clockMeasureSummary()
+     */
+    const ClockMeasure &totalClock() const ;
+
+    /**
+     *  @brief  Get all the skipped events of the sequence, by processor name.
+     *  Merges the skips requested via EventStore::requestSkip() and
+     *  the ones thrown with SkipEventException (by exception message)
      */
-    const SkippedEventMap &skippedEvents() const ;
+    SkippedEventMap skippedEvents() const ;
+
+    /**
+     *  @brief  Set the event watchdog to report to. The sequence index is used as slot
+     *
+     *  @param  watchdog the event watchdog (nullptr to disable)
+     */
+    void setWatchdog( EventWatchdog *watchdog ) ;
+
+    /**
+     *  @brief  Set the application to notify when an event is processed
+     *  (see Application::eventProcessed())
+     *
+     *  @param  app the application (nullptr to disable)
+     */
+    void setApplication( Application *app ) ;
 
   private:
+    ///< The sequence index
+    Index                           _index {0} ;
+    ///< The event watchdog
+    EventWatchdog                  *_watchdog {nullptr} ;
+    ///< The application notified when an event is processed
+    Application                    *_application {nullptr} ;
     ///< The sequence items (processor list)
     Container                       _items {} ;
     ///< The processor clock measurements
     ClockMeasureMap                 _clockMeasures {} ;
-    ///< The map of skipped events
+    ///< The clock measurement summed over all items
+    ClockMeasure                    _totalClock {} ;
+    ///< The map of skipped events (SkipEventException)
     SkippedEventMap                 _skipEventMap {} ;
+    ///< The number of skip requests per item (EventStore::requestSkip())
+    std::vector<int>                _skipCounters {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -229,6 +320,7 @@ namespace marlin {
       std::shared_ptr<SequenceItem>,
       std::hash<std::shared_ptr<SequenceItem>>,
       ItemEqual> ;
+    using SequenceItemOrder = std::vector<std::shared_ptr<SequenceItem>> ;
 
   public:
     SuperSequence() = delete ;
@@ -250,12 +342,27 @@ namespace marlin {
      */
     std::shared_ptr<Sequence> sequence( Index index ) const ;
 
+    /**
+     *  @brief  Configure the runtime calibration from the global parameters.
+     *  "RuntimeCalibration" turns on the calibration mode: the memory used
+     *  by each processor instance is measured in init() and the runtime
+     *  options proposed from the measurements are written by writeCalibration()
+     *  in the file "RuntimeCalibrationFile". If this file exists, it provides
+     *  the runtime options of the processors setting them to "auto".
+     *  Must be called before adding the processors
+     *
+     *  @param  app the application in which the processors run
+     */
+    void configureCalibration( Application *app ) ;
+
     /**
      *  @brief  Add a processor using the input parameters.
      *  The processor is added to each sequence. Depending on
      *  the parameter "ProcessorClone" and the processor forced
      *  runtime policy, the processor is either cloned for each
-     *  sequence or shared by all sequences
+     *  sequence or shared by all sequences. The "auto" value of
+     *  "ProcessorClone" and "ProcessorCritical" takes the options from
+     *  the calibration file (see configureCalibration()), if any
      *
      *  @param  parameters the processor input parameters
      */
@@ -267,7 +374,21 @@ namespace marlin {
     SizeType size() const ;
 
     /**
-     *  @brief  Call Processor::baseInit(app) for all processors
+     *  @brief  Call Processor::baseInit(app) for all processors.
+     *  The processors are initialized in steering order, the clones of a
+     *  processor concurrently as tasks of the application task queue
+     *  (see Application::taskQueue()). If the global parameter "ParallelInit"
+     *  is set to true, distinct processors are initialized concurrently too.
+     *  In calibration mode, everything is initialized serially.
+     *  Critical processors are initialized one at a time, using their
+     *  processing lock.
+     *  If some initializations fail, the first failure in processor order
+     *  is re-thrown once the running initializations are done. The processors
+     *  after the failing one are then not initialized.
+     *  Cloned processors are first initialized in the first sequence only.
+     *  The other clones are then replicated from this prototype if the
+     *  processor supports it (see Processor::clone()), else initialized.
+     *  The init time of each processor is reported in the application logger
      *
      *  @param  app the application in which the processors run
      */
@@ -281,7 +402,9 @@ namespace marlin {
     void processRunHeader( std::shared_ptr<RunHeader> rhdr ) ;
 
     /**
-     *  @brief  Call Processor::end() for all processors
+     *  @brief  Call Processor::end() for all processors.
+     *  Same concurrency and error handling as for init().
+     *  The event watchdog, if any, is stopped before
      */
     void end() ;
 
@@ -292,11 +415,52 @@ namespace marlin {
      */
     void printStatistics( Logging::Logger logger ) const ;
 
+    /**
+     *  @brief  Propose the processor runtime options from the measurements
+     *  of the calibration run and write them in the calibration file.
+     *  No-op if the calibration mode is off
+     *
+     *  @param  logger the logger in which to print the proposals
+     */
+    void writeCalibration( Logging::Logger logger ) const ;
+
+  private:
+    /**
+     *  @brief  Merge the clock measurements of all sequences
+     */
+    Sequence::ClockMeasureMap mergedClockMeasures() const ;
+
+    /**
+     *  @brief  Get the indices of the unique items of each processor,
+     *  the processors in steering order
+     */
+    std::vector<std::vector<std::size_t>> processorItemIndices() const ;
+
   private:
     ///< The list of sequences
     Sequences                  _sequences {} ;
     ///< A unique list of sequence items
     SequenceItemList           _uniqueItems {} ;
+    ///< The unique sequence items in processor order
+    SequenceItemOrder          _itemOrder {} ;
+    ///< The prototype items of the cloned items (same order, nullptr for prototypes)
+    SequenceItemOrder          _prototypes {} ;
+    ///< Whether to run the init/end of distinct processors concurrently
+    bool                       _parallelInit {false} ;
+    ///< The task queue running the init/end (nullptr: serial)
+    concurrency::TaskQueue    *_taskQueue {nullptr} ;
+    ///< The event watchdog (time budgets only)
+    std::unique_ptr<EventWatchdog> _watchdog {nullptr} ;
+    ///< Whether the calibration mode is on
+    bool                       _calibrate {false} ;
+    ///< The calibration file name
+    std::string                _calibrationFile {} ;
+    ///< The runtime options read from the calibration file
+    RuntimeCalibration::OptionsMap _autoOptions {} ;
+    ///< The memory used by each item at init (calibration mode only, same order as _itemOrder)
+    std::vector<std::size_t>   _instanceMemory {} ;
+    ///< The logger for the calibration messages
+    Logging::Logger            _logger {nullptr} ;
   };
 
 } // end namespace marlin
@@ -28,6 +28,7 @@ namespace marlin {
     void pushEvent( std::shared_ptr<EventStore> event ) ;
     void popFinishedEvents( std::vector<std::shared_ptr<EventStore>> &events ) ;
     std::size_t freeSlots() const ;
+    std::size_t concurrency() const ;
 
   private:
     ///< The logger instance
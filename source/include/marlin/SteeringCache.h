@@ -0,0 +1,156 @@
+#ifndef MARLIN_STEERINGCACHE_h
+#define MARLIN_STEERINGCACHE_h 1
+
+// -- std headers
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+// -- marlin headers
+#include <marlin/IParser.h>
+#include <marlin/Logging.h>
+
+namespace marlin {
+
+  class StringParameters ;
+  class XMLParser ;
+
+  /**
+   *  @brief  SteeringCache class
+   *  Parser implementation using a compiled (binary) version of a XML steering file.
+   *
+   *  The compiled steering is a flat binary file holding all the parameter sections
+   *  produced by the XMLParser (including the active processors and their conditions,
+   *  found in the global section). The file is memory mapped and read sequentially
+   *  without building any DOM.
+   *
+   *  On parse(), the cache file is loaded if its content hash matches the hash of
+   *  the XML steering file, the included files and the command line overrides.
+   *  Else the XML steering file is parsed as usual and the cache file is (re)written.
+   *  Failing to write the cache file is not an error at this stage.
+   *  The cache file can also be produced ahead of time with MarlinCompileSteering.
+   *
+   *  Note that the binary format is architecture dependent (native byte order).
+   */
+  class SteeringCache : public IParser {
+  public:
+    using SectionMap = std::map<std::string, std::shared_ptr<StringParameters>> ;
+    using FileList = std::vector<std::string> ;
+
+    /// The cache file format version. Increment on any format change
+    static constexpr unsigned int formatVersion = 1 ;
+
+  public:
+    SteeringCache() = delete ;
+    SteeringCache( const SteeringCache & ) = delete ;
+    SteeringCache &operator=( const SteeringCache & ) = delete ;
+    ~SteeringCache() = default ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  steeringFile the XML steering file name
+     *  @param  cacheFile the compiled steering file name
+     */
+    SteeringCache( const std::string &steeringFile, const std::string &cacheFile ) ;
+
+    /**
+     *  @brief  Set the command line parameters. They are part of the cache hash
+     *
+     *  @param  cmdlineparams the command line parameters
+     */
+    void setCmdLineParameters( const CommandLineParametersMap &cmdlineparams ) override ;
+
+    /**
+     *  @brief  Load the cache file if valid, else parse the XML file and write the cache file
+     */
+    void parse() override ;
+
+    /**
+     *  @brief  Get the parameters of a section
+     *
+     *  @param  sectionName the section name
+     */
+    std::shared_ptr<StringParameters> getParameters( const std::string &sectionName ) const override ;
+
+    /**
+     *  @brief  Write the parsed XML steering file. If the parameters were
+     *  loaded from the cache, the XML file is parsed first
+     *
+     *  @param  fname the output file name
+     */
+    void write( const std::string &fname ) const override ;
+
+    /**
+     *  @brief  Whether the parameters have been loaded from the cache file on last parse() call
+     */
+    bool loadedFromCache() const ;
+
+    /**
+     *  @brief  Compile the XML steering file into the cache file.
+     *  Throws if the cache file can't be written
+     */
+    void compile() ;
+
+  private:
+    /**
+     *  @brief  Parse the XML steering file and populate the sections
+     */
+    void readXML() ;
+
+    /**
+     *  @brief  Create and run the XML parser
+     */
+    std::shared_ptr<XMLParser> parseXML() const ;
+
+    /**
+     *  @brief  Compute the hash of the steering file content and the command line parameters
+     */
+    unsigned long long int steeringHash() const ;
+
+    /**
+     *  @brief  Compute the hash of a file content. Throws if the file can't be read
+     *
+     *  @param  fname the file name
+     */
+    static unsigned long long int fileHash( const std::string &fname ) ;
+
+    /**
+     *  @brief  Try to read the cache file. Returns false if the file doesn't
+     *  exists, is corrupted or is out of date.
+     *
+     *  @param  sections the section map to receive
+     */
+    bool readCache( SectionMap &sections ) const ;
+
+    /**
+     *  @brief  Write the sections and the dependency files in the cache file.
+     *  The file is first written under a temporary name and renamed afterwards
+     *  so that concurrent jobs never read a partial file.
+     *
+     *  @param  sections the sections to write
+     *  @param  dependencies the included files
+     */
+    void writeCache( const SectionMap &sections, const FileList &dependencies ) const ;
+
+  private:
+    ///< The XML steering file name
+    std::string                           _steeringFile {} ;
+    ///< The compiled steering file name
+    std::string                           _cacheFile {} ;
+    ///< The command line parameters
+    CommandLineParametersMap              _cmdLineParameters {} ;
+    ///< The parameter sections
+    SectionMap                            _sections {} ;
+    ///< Whether the sections were loaded from the cache file
+    bool                                  _fromCache {false} ;
+    ///< The XML parser, if the XML file was parsed
+    mutable std::shared_ptr<XMLParser>    _xmlParser {nullptr} ;
+    ///< The logger instance
+    Logging::Logger                       _logger {nullptr} ;
+  };
+
+} // end namespace marlin
+
+#endif
@@ -5,6 +5,11 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
 #include <algorithm>
 #include <iomanip>
 #include <iostream>
@@ -16,18 +21,35 @@ namespace marlin {
 
   /** Simple parameters class for Marlin.
    *  Holds named parameters as string vectors.
+   *  Typed accessors (getValue(), getValues(), get()) convert the string
+   *  values only once per key and type. The converted values are kept in a
+   *  typed store, indexed by the key hash, and shared by all subsequent
+   *  readers, e.g processor clones configured from the same parameters.
+   *  Reading is thread safe. Modifying the parameters clears the typed store
+   *  and must not happen concurrently with reading.
    *  @author F. Gaede, DESY
    *  @author R. Ete, DESY
    *  @version $Id: StringParameters.h,v 1.5 2006-11-10 11:56:07 engels Exp $
    */
   class StringParameters {
     typedef std::map<std::string, std::vector<std::string>> ParametersMap ;
+    /// An entry of the typed value store
+    struct TypedEntry {
+      ///< The parameter key
+      std::string                    _key {} ;
+      ///< The type hash of the stored value
+      unsigned long long int         _type {0} ;
+      ///< The converted value
+      std::shared_ptr<const void>    _value {nullptr} ;
+    };
+    typedef std::unordered_multimap<unsigned long long int, TypedEntry> TypedValueMap ;
     friend std::ostream& operator<< ( std::ostream& , const StringParameters& ) ;
 
   public:
     StringParameters() = default ;
     ~StringParameters() = default ;
-    StringParameters( const StringParameters &sp ) = default ;
+    StringParameters( const StringParameters &sp ) ;
+    StringParameters &operator=( const StringParameters &sp ) ;
 
     /**
      *  @brief  Add a parameter without value.
@@ -172,9 +194,31 @@ namespace marlin {
     template <typename T>
     void get( const std::string& key , std::vector<T> &values ) const ;
 
+  private:
+    /**
+     *  @brief  Get a value from the typed store. On first access, the value
+     *  is created by calling the converter and inserted in the store.
+     *
+     *  @param  key the parameter key
+     *  @param  converter the function converting the string value(s) to T
+     */
+    template <typename T, typename CONVERTER>
+    const T &typedValue( const std::string &key, CONVERTER converter ) const ;
+
+    /**
+     *  @brief  Clear the typed value store
+     */
+    void clearTypedValues() ;
+
   protected:
     ///< The parameters map
-    ParametersMap          _map {} ;
+    ParametersMap                 _map {} ;
+
+  private:
+    ///< The typed value store, filled on first typed access
+    mutable TypedValueMap         _typedValues {} ;
+    ///< The mutex protecting the typed value store
+    mutable std::shared_mutex     _typedMutex {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -189,6 +233,7 @@ namespace marlin {
   inline void StringParameters::add( const std::string& key, const T &value ) {
     add( key ) ;
     auto iter = _map.find( key ) ;
+    clearTypedValues() ;
     iter->second.push_back( StringUtil::typeToString<T>( value ) )  ;
   }
 
@@ -198,6 +243,7 @@ namespace marlin {
   inline void StringParameters::add( const std::string& key, const std::vector<T> &values ) {
     add( key ) ;
     auto iter = _map.find( key ) ;
+    clearTypedValues() ;
     for( auto val : values ) {
       iter->second.push_back( StringUtil::typeToString<T>(val) ) ;
     }
@@ -221,13 +267,52 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  template <typename T, typename CONVERTER>
+  inline const T &StringParameters::typedValue( const std::string &key, CONVERTER converter ) const {
+    const auto keyHash = HashHelper::hash64( key.c_str() ) ;
+    const auto typeHash = HashHelper::typeHash64<T>() ;
+    auto findEntry = [&]() -> const T* {
+      auto range = _typedValues.equal_range( keyHash ) ;
+      for( auto iter = range.first ; iter != range.second ; ++iter ) {
+        if( iter->second._type == typeHash and iter->second._key == key ) {
+          return static_cast<const T*>( iter->second._value.get() ) ;
+        }
+      }
+      return nullptr ;
+    };
+    {
+      std::shared_lock<std::shared_mutex> lock( _typedMutex ) ;
+      auto value = findEntry() ;
+      if( nullptr != value ) {
+        return *value ;
+      }
+    }
+    // convert outside of the lock. Throws on conversion failure
+    auto value = std::make_shared<const T>( converter() ) ;
+    std::unique_lock<std::shared_mutex> lock( _typedMutex ) ;
+    // an other thread may have been faster
+    auto existing = findEntry() ;
+    if( nullptr != existing ) {
+      return *existing ;
+    }
+    _typedValues.emplace( keyHash, TypedEntry{ key, typeHash, value } ) ;
+    return *value ;
+  }
+
+  //--------------------------------------------------------------------------
+
   template <typename T>
   inline T StringParameters::getValue( const std::string& key ) const {
     auto iter = _map.find( key ) ;
     if( _map.end() == iter ) {
       throw Exception( "StringParameters::getAs: parameter '" + key + "' not found" ) ;
     }
-    return StringUtil::stringToType<T>( iter->second.at(0) ) ;
+    if constexpr ( std::is_same<T, std::string>::value ) {
+      return iter->second.at(0) ;
+    }
+    else {
+      return typedValue<T>( key, [&](){ return StringUtil::stringToType<T>( iter->second.at(0) ) ; } ) ;
+    }
   }
 
   //--------------------------------------------------------------------------
@@ -238,7 +323,7 @@ namespace marlin {
     if( _map.end() == iter ) {
       throw Exception( "StringParameters::getAs: parameter '" + key + "' not found" ) ;
     }
-    return StringUtil::stringToType<T>( iter->second ) ;
+    return typedValue<std::vector<T>>( key, [&](){ return StringUtil::stringToType<T>( iter->second ) ; } ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -249,7 +334,7 @@ namespace marlin {
     if( _map.end() == iter ) {
       return fallback ;
     }
-    return StringUtil::stringToType<T>( iter->second.at(0) ) ;
+    return getValue<T>( key ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -260,7 +345,7 @@ namespace marlin {
     if( _map.end() == iter ) {
       return fallback ;
     }
-    return StringUtil::stringToType<T>( iter->second ) ;
+    return getValues<T>( key ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -271,7 +356,7 @@ namespace marlin {
     if( _map.end() == iter ) {
       return ;
     }
-    value = StringUtil::stringToType<T>( iter->second.at(0) ) ;
+    value = getValue<T>( key ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -282,7 +367,7 @@ namespace marlin {
     if( _map.end() == iter ) {
       return ;
     }
-    values = StringUtil::stringToType<T>( iter->second ) ;
+    values = getValues<T>( key ) ;
   }
 
 } // end namespace marlin
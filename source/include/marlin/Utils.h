@@ -6,6 +6,7 @@
 #include <cmath>
 #include <string>
 #include <sstream>
+#include <iomanip>
 #include <typeinfo>
 #include <chrono>
 #include <vector>
@@ -133,6 +134,21 @@ namespace marlin {
       return hash ;
     }
 
+    /**
+     *  @brief  Generate a hash 64 from a raw buffer.
+     *  The seed allows for chaining calls over several buffers
+     *
+     *  @param  data the input buffer
+     *  @param  size the buffer size
+     *  @param  seed the initial hash value
+     */
+    static unsigned long long int hash64( const void *data, std::size_t size, unsigned long long int seed = hashinit ) {
+      auto str = static_cast<const unsigned char*>(data) ;
+      unsigned long long int hash = seed ;
+      for ( std::size_t i=0 ; i<size ; ++i ) hash = doByte(hash, str[i]) ;
+      return hash ;
+    }
+
     /**
      *  @brief  Generate a hash 64 from the typeid name
      */
@@ -213,6 +229,13 @@ namespace marlin {
      */
     template <typename T>
     static std::string join( const std::vector<T> &input, const std::string &delimiter = " " ) ;
+
+    /**
+     *  @brief  Quote and escape a string for JSON output
+     *
+     *  @param  str the string to convert
+     */
+    static std::string jsonString( const std::string &str ) ;
   };
 
   //--------------------------------------------------------------------------
@@ -331,6 +354,30 @@ namespace marlin {
     return ss.str() ;
   }
 
+  //--------------------------------------------------------------------------
+
+  inline std::string StringUtil::jsonString( const std::string &str ) {
+    std::ostringstream out ;
+    out << '"' ;
+    for( auto c : str ) {
+      switch( c ) {
+        case '"': out << "\\\"" ; break ;
+        case '\\': out << "\\\\" ; break ;
+        case '\n': out << "\\n" ; break ;
+        case '\t': out << "\\t" ; break ;
+        default:
+          if( static_cast<unsigned char>(c) < 0x20 ) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec ;
+          }
+          else {
+            out << c ;
+          }
+      }
+    }
+    out << '"' ;
+    return out.str() ;
+  }
+
 } // end namespace marlin
 
 #endif
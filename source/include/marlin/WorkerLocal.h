@@ -0,0 +1,244 @@
+#ifndef MARLIN_WORKERLOCAL_h
+#define MARLIN_WORKERLOCAL_h 1
+
+// -- std headers
+#include <vector>
+#include <memory>
+#include <functional>
+#include <string>
+#include <limits>
+#include <type_traits>
+
+// -- marlin headers
+#include <marlin/Exceptions.h>
+
+namespace marlin {
+
+  /**
+   *  @brief  WorkerLocalBase class
+   *  Base class of worker local storage. Also provides access to
+   *  the worker index of the calling thread.
+   */
+  class WorkerLocalBase {
+  public:
+    /// The worker index of the threads that are not workers (main thread, reader, ...)
+    static constexpr std::size_t NoWorker = std::numeric_limits<std::size_t>::max() ;
+
+  public:
+    virtual ~WorkerLocalBase() = default ;
+
+    /**
+     *  @brief  Call the reduce function if any.
+     *  Called by the framework before Processor::end()
+     */
+    virtual void reduce() = 0 ;
+
+    /**
+     *  @brief  Get the worker index of the calling thread.
+     *  The pool threads get their index when they start. Returns NoWorker
+     *  for the other threads (e.g the main thread in init, run header and end)
+     */
+    static std::size_t currentWorkerIndex() ;
+
+    /**
+     *  @brief  Set the worker index of the calling thread.
+     *  Used by the framework only
+     *
+     *  @param  index the worker index
+     */
+    static void setCurrentWorkerIndex( std::size_t index ) ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  WorkerLocal class
+   *  Holds one instance of T per worker thread. The instance of a worker
+   *  is allocated by the worker itself on first access, so that no lock
+   *  is needed on the event processing path. Get an instance using
+   *  ProcessorApi::workerLocal<T>(this) in your processor init() and
+   *  keep the reference for later use in processEvent().
+   *  An optional reduce function can be set to merge the worker instances.
+   *  It is called once all events have been processed, before Processor::end().
+   *  The threads that are not workers share one extra slot (index size()),
+   *  e.g the main thread in init(), processRunHeader() and end(). Use it from
+   *  a single thread at a time.
+   *
+   *  @code{cpp}
+   *  // in init()
+   *  _counters = &ProcessorApi::workerLocal<Counter>( this ) ;
+   *  _counters->onReduce( [this]( WorkerLocal<Counter> &counters ) {
+   *    counters.forEach( [this]( std::size_t, Counter &c ) { _total += c._count ; } ) ;
+   *  }) ;
+   *  // in processEvent(). No lock, even for a shared processor
+   *  _counters->local()._count ++ ;
+   *  @endcode
+   */
+  template <typename T>
+  class WorkerLocal : public WorkerLocalBase {
+  public:
+    using Factory = std::function<std::unique_ptr<T>( std::size_t )> ;
+    using ReduceFunction = std::function<void( WorkerLocal<T>& )> ;
+    using Slots = std::vector<std::unique_ptr<T>> ;
+
+  public:
+    WorkerLocal() = delete ;
+    WorkerLocal( const WorkerLocal<T> & ) = delete ;
+    WorkerLocal &operator=( const WorkerLocal<T> & ) = delete ;
+    ~WorkerLocal() = default ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  nworkers the number of workers
+     *  @param  factory the function creating the instance of a worker (from its index).
+     *  If nullptr, T is default constructed
+     */
+    WorkerLocal( std::size_t nworkers, Factory factory = nullptr ) ;
+
+    /**
+     *  @brief  Get the instance of the calling worker.
+     *  The instance is allocated on first call
+     */
+    T &local() ;
+
+    /**
+     *  @brief  Get the slot index of the calling thread: its worker index,
+     *  or size() for the threads that are not workers
+     */
+    std::size_t index() const ;
+
+    /**
+     *  @brief  Get the number of workers. The slot of the threads
+     *  that are not workers is at index size()
+     */
+    std::size_t size() const ;
+
+    /**
+     *  @brief  Whether the instance of the given worker has been allocated
+     *
+     *  @param  index the worker index
+     */
+    bool allocated( std::size_t index ) const ;
+
+    /**
+     *  @brief  Call a function on each allocated instance, in slot index order.
+     *  The function signature must be void(std::size_t index, T &value).
+     *  Not thread safe: to be used outside of event processing (e.g. in reduce)
+     *
+     *  @param  function the function to call
+     */
+    template <typename FUNCTION>
+    void forEach( FUNCTION function ) ;
+
+    /**
+     *  @brief  Set the reduce function called before Processor::end()
+     *
+     *  @param  function the reduce function
+     */
+    void onReduce( ReduceFunction function ) ;
+
+    // from WorkerLocalBase
+    void reduce() override ;
+
+  private:
+    ///< The worker instances
+    Slots              _slots {} ;
+    ///< The factory function
+    Factory            _factory {nullptr} ;
+    ///< The reduce function
+    ReduceFunction     _reduce {nullptr} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline WorkerLocal<T>::WorkerLocal( std::size_t nworkers, Factory factory ) :
+    _slots(nworkers + 1),
+    _factory(factory) {
+    if( 0 == nworkers ) {
+      throw Exception( "WorkerLocal: number of workers must be > 0" ) ;
+    }
+    if( nullptr == _factory ) {
+      if constexpr ( std::is_default_constructible<T>::value ) {
+        _factory = []( std::size_t ) {
+          return std::unique_ptr<T>( new T() ) ;
+        };
+      }
+      else {
+        throw Exception( "WorkerLocal: type is not default constructible, a factory is required" ) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline T &WorkerLocal<T>::local() {
+    const auto worker = currentWorkerIndex() ;
+    if( NoWorker != worker and worker >= size() ) {
+      throw Exception( "WorkerLocal::local: worker index " + std::to_string( worker ) + " out of range" ) ;
+    }
+    const auto idx = index() ;
+    auto &slot = _slots[idx] ;
+    if( nullptr == slot ) {
+      slot = _factory( idx ) ;
+    }
+    return *slot ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline std::size_t WorkerLocal<T>::index() const {
+    const auto worker = currentWorkerIndex() ;
+    return ( NoWorker == worker ) ? size() : worker ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline std::size_t WorkerLocal<T>::size() const {
+    return _slots.size() - 1 ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline bool WorkerLocal<T>::allocated( std::size_t idx ) const {
+    return ( nullptr != _slots.at( idx ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  template <typename FUNCTION>
+  inline void WorkerLocal<T>::forEach( FUNCTION function ) {
+    for( std::size_t i=0 ; i<_slots.size() ; ++i ) {
+      if( nullptr != _slots[i] ) {
+        function( i, *_slots[i] ) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline void WorkerLocal<T>::onReduce( ReduceFunction function ) {
+    _reduce = function ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline void WorkerLocal<T>::reduce() {
+    if( nullptr != _reduce ) {
+      _reduce( *this ) ;
+    }
+  }
+
+} // end namespace marlin
+
+#endif
@@ -166,6 +166,9 @@ namespace marlin{
     void write(const std::string &filen) const ;
     
     std::vector<std::string> getSections() const ;
+
+    /** Return the list of files included in the steering file (<include ref="..."/>) */
+    const std::vector<std::string> &includedFiles() const ;
   protected:
 
     /** Extracts all parameters from the given node and adss them to the current StringParameters object
@@ -216,6 +219,7 @@ namespace marlin{
     bool _forCCheck; //boolean variable set to true if parser is used for consistency checking
 
     CommandLineParametersMap _cmdlineparams{};
+    std::vector<std::string> _includedFiles{};
 
   };
 
@@ -0,0 +1,123 @@
+#ifndef MARLIN_CONCURRENCY_CPUTOPOLOGY_h
+#define MARLIN_CONCURRENCY_CPUTOPOLOGY_h 1
+
+// -- std headers
+#include <string>
+#include <vector>
+#include <map>
+
+namespace marlin {
+
+  namespace concurrency {
+
+    /**
+     *  @brief  CPUTopology class
+     *  Static helpers to query the CPUs usable by the process (affinity mask,
+     *  cgroup cpuset and CPU quota, NUMA nodes) and to pin threads on CPUs.
+     *  Only implemented on Linux. On other platforms, the hardware
+     *  concurrency is used and thread pinning is not supported.
+     */
+    class CPUTopology {
+    public:
+      using CPUList = std::vector<int> ;
+      using NodeMap = std::map<int, CPUList> ;
+
+    public:
+      // only static API
+      CPUTopology() = delete ;
+      ~CPUTopology() = delete ;
+
+      /**
+       *  @brief  Get the number of threads the process can effectively use.
+       *  This is the minimum of the number of CPUs in the process affinity
+       *  mask (which reflects the cgroup cpuset) and of the cgroup CPU quota
+       *  (cgroup v2 cpu.max or cgroup v1 cpu.cfs_quota_us), rounded up.
+       *  Always at least 1
+       */
+      static std::size_t availableConcurrency() ;
+
+      /**
+       *  @brief  Get the cgroup CPU quota, in number of CPUs.
+       *  Returns 0 if no quota is set or the cgroup can't be read
+       */
+      static double cgroupCPUQuota() ;
+
+      /**
+       *  @brief  Read a cgroup v2 CPU quota file (cpu.max: "<quota> <period>" or "max <period>"),
+       *  in number of CPUs. Returns 0 if no quota is set or the file can't be read or parsed
+       *
+       *  @param  fname the cpu.max file name
+       */
+      static double cgroupV2Quota( const std::string &fname ) ;
+
+      /**
+       *  @brief  Read a cgroup v1 CPU quota (cpu.cfs_quota_us / cpu.cfs_period_us), in
+       *  number of CPUs. Returns 0 if no quota is set or the files can't be read or parsed
+       *
+       *  @param  directory the cgroup directory holding the quota files
+       */
+      static double cgroupV1Quota( const std::string &directory ) ;
+
+      /**
+       *  @brief  Find the cgroup path of the process for a given controller (cgroup v1)
+       *  or the unified hierarchy (cgroup v2, empty controller). Returns an empty string if not found
+       *
+       *  @param  controller the cgroup controller (e.g "cpu"), empty for the unified hierarchy
+       *  @param  fname the process cgroup file
+       */
+      static std::string cgroupPath( const std::string &controller, const std::string &fname = "/proc/self/cgroup" ) ;
+
+      /**
+       *  @brief  Get the list of CPUs the process is allowed to run on
+       */
+      static CPUList allowedCPUs() ;
+
+      /**
+       *  @brief  Get the allowed CPUs grouped by NUMA node.
+       *  If the NUMA topology can't be read, all CPUs are in node 0
+       */
+      static NodeMap numaNodes() ;
+
+      /**
+       *  @brief  Parse a CPU list, e.g "0-3,8,10-11"
+       *
+       *  @param  str the CPU list string
+       */
+      static CPUList parseCPUList( const std::string &str ) ;
+
+      /**
+       *  @brief  Compute the CPUs to pin each worker on, for a given affinity mode:
+       *   - "none": no pinning (empty lists)
+       *   - "compact": one CPU per worker, filling the CPUs in order
+       *   - "scatter": one CPU per worker, alternating the NUMA nodes
+       *   - "numa": all the CPUs of a NUMA node per worker, alternating the nodes
+       *   - an explicit CPU list (e.g "0-7,16-23"): one CPU per worker, in list order
+       *  Workers wrap around if there are more workers than CPUs.
+       *  Throws on invalid mode or if an explicit CPU is not in allowedCPUs()
+       *
+       *  @param  mode the affinity mode
+       *  @param  nworkers the number of workers
+       */
+      static std::vector<CPUList> workerCPUs( const std::string &mode, std::size_t nworkers ) ;
+
+      /**
+       *  @brief  Pin the calling thread on the given CPUs.
+       *  Returns false if pinning failed or is not supported
+       *
+       *  @param  cpus the list of CPUs
+       */
+      static bool pinCurrentThread( const CPUList &cpus ) ;
+
+      /**
+       *  @brief  Convert a CPU list to string, e.g "0-3,8"
+       *
+       *  @param  cpus the CPU list
+       */
+      static std::string toString( const CPUList &cpus ) ;
+    };
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,298 @@
+#ifndef MARLIN_CONCURRENCY_COMMITQUEUE_h
+#define MARLIN_CONCURRENCY_COMMITQUEUE_h 1
+
+// -- marlin headers
+#include <marlin/Exceptions.h>
+
+// -- std headers
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+
+namespace marlin {
+
+  namespace concurrency {
+
+    /**
+     *  @brief  CommitQueue class
+     *  A bounded queue consumed by a dedicated thread calling a commit
+     *  function on each element (e.g writing events to a file), so that
+     *  the producers (workers) don't wait on the commit (I/O).
+     *
+     *  In ordered mode, the elements are pushed with the input index of
+     *  their event and a reorder buffer commits them in index order. An
+     *  index may never come (e.g skipped event): the optional watermark
+     *  function gives the index below which all events are done, so that
+     *  missing indices below are not waited for. The watermark must be
+     *  advanced independently of the thread waiting for the producers (e.g
+     *  by the producers themselves when they are done with an event), as a
+     *  full queue blocks the producers until the watermark moves.
+     *
+     *  When the queue is full, push() blocks, except for an element with an
+     *  index lower than all the queued ones (ordered mode) as the commits may
+     *  be waiting for it. An exception thrown by the commit function stops
+     *  the thread and is re-thrown by the next push() or by stop().
+     *
+     *  In ordered mode, a marker (see pushMarker()) separates the committed
+     *  elements of lower indices from the others, e.g for a checkpoint.
+     */
+    template <typename T>
+    class CommitQueue {
+    public:
+      using CommitFunction = std::function<void(T&)> ;
+      using WatermarkFunction = std::function<std::size_t()> ;
+
+      /**
+       *  @brief  Settings struct
+       */
+      struct Settings {
+        ///< The maximum number of queued elements
+        std::size_t          _capacity {32} ;
+        ///< Whether to commit in index order
+        bool                 _ordered {false} ;
+        ///< The polling period of the watermark (ordered mode only), in seconds
+        double               _pollPeriod {0.01} ;
+      };
+
+    private:
+      /**
+       *  @brief  Entry struct
+       */
+      struct Entry {
+        ///< The queued element
+        T                    _value ;
+        ///< Whether the element completes its index
+        bool                 _completes {true} ;
+        ///< Whether the element is a marker (see pushMarker())
+        bool                 _marker {false} ;
+      };
+      using EntryMap = std::multimap<std::size_t, Entry> ;
+
+    public:
+      CommitQueue() = delete ;
+      CommitQueue( const CommitQueue & ) = delete ;
+      CommitQueue &operator=( const CommitQueue & ) = delete ;
+
+      /**
+       *  @brief  Constructor. Start the commit thread
+       *
+       *  @param  function the commit function
+       *  @param  settings the queue settings
+       *  @param  watermark the watermark function (ordered mode only, optional)
+       */
+      CommitQueue( CommitFunction function, const Settings &settings, WatermarkFunction watermark = nullptr ) :
+        _function(function),
+        _watermark(watermark),
+        _settings(settings) {
+        if( 0 == _settings._capacity ) {
+          throw Exception( "CommitQueue: capacity must be > 0" ) ;
+        }
+        _thread = std::thread( &CommitQueue<T>::run, this ) ;
+      }
+
+      /**
+       *  @brief  Destructor. Commit the remaining elements and stop the thread.
+       *  Errors are silently dropped, use stop() to get them
+       */
+      ~CommitQueue() {
+        try {
+          stop() ;
+        }
+        catch( ... ) {}
+      }
+
+      /**
+       *  @brief  Push an element to commit. Block if the queue is full.
+       *  In ordered mode, the elements are committed in index order, the
+       *  elements of the same index in push order. An element that doesn't
+       *  complete its index (e.g a run header preceding the event of this
+       *  index) lets the next element of the same index be committed
+       *
+       *  @param  index the input index (ordered mode only)
+       *  @param  value the element to commit
+       *  @param  completes whether the element completes its index
+       */
+      void push( std::size_t index, T value, bool completes = true ) {
+        std::unique_lock<std::mutex> lock( _mutex ) ;
+        if( not _settings._ordered ) {
+          index = _arrivals ++ ;
+        }
+        _pushCondition.wait( lock, [&]() {
+          return ( _stopFlag or nullptr != _error or _entries.size() < _settings._capacity
+            or ( _settings._ordered and index < _entries.begin()->first ) ) ;
+        }) ;
+        if( nullptr != _error ) {
+          std::rethrow_exception( _error ) ;
+        }
+        if( _stopFlag ) {
+          throw Exception( "CommitQueue::push: queue stopped" ) ;
+        }
+        _entries.insert( { index, Entry { std::move( value ), completes } } ) ;
+        lock.unlock() ;
+        _commitCondition.notify_one() ;
+      }
+
+      /**
+       *  @brief  Push a marker element (ordered mode only), committed after all the elements
+       *  of lower index and before the already queued elements of the same index. It is
+       *  committed as soon as the watermark reaches its index, even if some lower indices
+       *  never came. Never blocks, as the caller may be the thread retiring the events
+       *
+       *  @param  index the input index
+       *  @param  value the marker element to commit
+       */
+      void pushMarker( std::size_t index, T value ) {
+        std::unique_lock<std::mutex> lock( _mutex ) ;
+        if( not _settings._ordered ) {
+          throw Exception( "CommitQueue::pushMarker: ordered mode only" ) ;
+        }
+        if( nullptr != _error ) {
+          std::rethrow_exception( _error ) ;
+        }
+        if( _stopFlag ) {
+          throw Exception( "CommitQueue::pushMarker: queue stopped" ) ;
+        }
+        // inserted before the elements of the same index
+        _entries.emplace_hint( _entries.lower_bound( index ), index, Entry { std::move( value ), false, true } ) ;
+        lock.unlock() ;
+        _commitCondition.notify_one() ;
+      }
+
+      /**
+       *  @brief  Commit all the remaining elements in order and stop the thread.
+       *  Re-throw the commit error, if any
+       */
+      void stop() {
+        {
+          std::lock_guard<std::mutex> lock( _mutex ) ;
+          _stopFlag = true ;
+        }
+        _commitCondition.notify_all() ;
+        _pushCondition.notify_all() ;
+        if( _thread.joinable() ) {
+          _thread.join() ;
+        }
+        std::lock_guard<std::mutex> lock( _mutex ) ;
+        if( nullptr != _error ) {
+          auto error = _error ;
+          _error = nullptr ;
+          std::rethrow_exception( error ) ;
+        }
+      }
+
+      /**
+       *  @brief  Get the number of committed elements
+       */
+      std::size_t nCommitted() const {
+        return _nCommitted.load() ;
+      }
+
+    private:
+      /**
+       *  @brief  Whether the first entry can be committed. Lock must be held
+       */
+      bool committable() const {
+        if( _entries.empty() ) {
+          return false ;
+        }
+        if( _stopFlag or not _settings._ordered ) {
+          return true ;
+        }
+        const auto first = _entries.begin()->first ;
+        if( first <= _next ) {
+          return true ;
+        }
+        // all events below the watermark are done: don't wait for missing indices
+        if( nullptr == _watermark ) {
+          return false ;
+        }
+        const auto watermark = _watermark() ;
+        return ( first < watermark or ( _entries.begin()->second._marker and first <= watermark ) ) ;
+      }
+
+      /**
+       *  @brief  The commit thread loop
+       */
+      void run() {
+        const auto pollPeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( _settings._pollPeriod ) ) ;
+        std::unique_lock<std::mutex> lock( _mutex ) ;
+        while( true ) {
+          if( not committable() ) {
+            if( _stopFlag ) {
+              break ;
+            }
+            if( _settings._ordered and nullptr != _watermark ) {
+              _commitCondition.wait_for( lock, pollPeriod ) ;
+            }
+            else {
+              _commitCondition.wait( lock ) ;
+            }
+            continue ;
+          }
+          auto iter = _entries.begin() ;
+          const auto index = iter->first ;
+          auto entry = std::move( iter->second ) ;
+          _entries.erase( iter ) ;
+          if( entry._completes and index + 1 > _next ) {
+            _next = index + 1 ;
+          }
+          else if( index > _next ) {
+            _next = index ;
+          }
+          lock.unlock() ;
+          _pushCondition.notify_all() ;
+          try {
+            _function( entry._value ) ;
+            ++ _nCommitted ;
+          }
+          catch( ... ) {
+            lock.lock() ;
+            _error = std::current_exception() ;
+            _entries.clear() ;
+            break ;
+          }
+          lock.lock() ;
+        }
+        lock.unlock() ;
+        _pushCondition.notify_all() ;
+      }
+
+    private:
+      ///< The commit function
+      CommitFunction             _function {nullptr} ;
+      ///< The watermark function
+      WatermarkFunction          _watermark {nullptr} ;
+      ///< The queue settings
+      Settings                   _settings {} ;
+      ///< The queued elements, by index
+      EntryMap                   _entries {} ;
+      ///< The next index to commit (ordered mode)
+      std::size_t                _next {0} ;
+      ///< The arrival counter (unordered mode)
+      std::size_t                _arrivals {0} ;
+      ///< The synchronization mutex
+      std::mutex                 _mutex {} ;
+      ///< The condition variable to wake up the commit thread
+      std::condition_variable    _commitCondition {} ;
+      ///< The condition variable to wake up the blocked producers
+      std::condition_variable    _pushCondition {} ;
+      ///< The stop flag
+      bool                       _stopFlag {false} ;
+      ///< The first commit error
+      std::exception_ptr         _error {nullptr} ;
+      ///< The number of committed elements
+      std::atomic<std::size_t>   _nCommitted {0} ;
+      ///< The commit thread
+      std::thread                _thread {} ;
+    };
+
+  }
+
+}
+
+#endif
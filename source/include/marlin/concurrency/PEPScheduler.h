@@ -6,6 +6,8 @@
 #include <marlin/Logging.h>
 #include <marlin/Utils.h>
 #include <marlin/concurrency/ThreadPool.h>
+#include <marlin/concurrency/ThroughputController.h>
+#include <marlin/concurrency/QueueDepthEstimator.h>
 
 // -- std headers
 #include <unordered_set>
@@ -26,6 +28,12 @@ namespace marlin {
       std::shared_ptr<EventStore>         _event {nullptr} ;
       ///< An exception potential throw in the worker thread
       std::exception_ptr                  _exception {nullptr} ;
+      ///< The time spent in the sequence, including locks
+      clock::duration_rep                 _appClock {0} ;
+      ///< The time spent in the processors
+      clock::duration_rep                 _procClock {0} ;
+      ///< The wall time spent processing the event, in seconds
+      double                              _serviceTime {0.} ;
     };
 
     //--------------------------------------------------------------------------
@@ -41,6 +49,17 @@ namespace marlin {
      *  in the thread pool for further processing. Note that this operation can
      *  fail if the thread pool queue is full. Use freeSlots() to know how many
      *  slots are free in the thread pool queue and avoid unexpected exceptions.
+     *
+     *  If the global parameter "AdaptiveConcurrency" is set to true, a
+     *  ThroughputController adjusts the number of active workers (parking the
+     *  other ones) at runtime, bounded by "Concurrency".
+     *  The measurement interval is set by "AdaptiveInterval" (seconds, default 2).
+     *
+     *  The number of events held by the scheduler (queued, processing or finished
+     *  but not popped yet) is bounded by the global parameter "MaxEventsInFlight"
+     *  (default 4 x Concurrency). Unless "AdaptiveQueueDepth" is set to false,
+     *  the queue depth is sized by a QueueDepthEstimator from the measured event
+     *  service times and reader latency. Else it is fixed to 2 x Concurrency.
      */
     class PEPScheduler : public IScheduler {
     public:
@@ -66,11 +85,25 @@ namespace marlin {
       void pushEvent( std::shared_ptr<EventStore> event ) override ;
       void popFinishedEvents( std::vector<std::shared_ptr<EventStore>> &events ) override ;
       std::size_t freeSlots() const override ;
+      std::size_t concurrency() const override ;
 
     private:
       void preConfigure( Application *app ) ;
       void configureProcessors( Application *app ) ;
-      void configurePool() ;
+      void configurePool( Application *app ) ;
+
+      /**
+       *  @brief  Feed the throughput controller with a finished event and
+       *  apply its decision if a new one is taken
+       *
+       *  @param  output the worker output of the finished event
+       */
+      void updateController( const WorkerOutput &output ) ;
+
+      /**
+       *  @brief  Resize the pool queue from the queue depth estimator
+       */
+      void updateQueueDepth() ;
 
     private:
       ///< The worker thread pool
@@ -91,6 +124,22 @@ namespace marlin {
       clock::duration_rep              _lockingTime {0} ;
       ///< The total time spent on popping events from the output event pool
       clock::duration_rep              _popTime {0} ;
+      ///< The throughput controller (adaptive concurrency only)
+      std::unique_ptr<ThroughputController> _controller {nullptr} ;
+      ///< The number of decisions changing the active workers
+      unsigned int                     _nAdjustments {0} ;
+      ///< The queue depth estimator (adaptive queue depth only)
+      std::unique_ptr<QueueDepthEstimator> _queueDepthEstimator {nullptr} ;
+      ///< The maximum number of events in flight
+      std::size_t                      _maxInFlight {0} ;
+      ///< The number of queue depth changes
+      unsigned int                     _nQueueDepthUpdates {0} ;
+      ///< The number of events popped since the last queue depth update
+      unsigned int                     _nPoppedSinceUpdate {0} ;
+      ///< The time of the last event push
+      clock::time_point                _lastPushTime {} ;
+      ///< Whether a reader latency measurement is pending (see freeSlots())
+      mutable bool                     _readerPending {false} ;
     };
 
   }
@@ -75,6 +75,14 @@ namespace marlin {
         return _queue.empty() ;
       }
 
+      /**
+       *  @brief  Get the number of elements in the queue
+       */
+      std::size_t size() const {
+        std::unique_lock<std::mutex> lock(_mutex) ;
+        return _queue.size() ;
+      }
+
       /**
        *  @brief  Get the maximum queue size
        */
@@ -0,0 +1,123 @@
+#ifndef MARLIN_CONCURRENCY_QUEUEDEPTHESTIMATOR_h
+#define MARLIN_CONCURRENCY_QUEUEDEPTHESTIMATOR_h 1
+
+// -- std headers
+#include <cstddef>
+
+namespace marlin {
+
+  namespace concurrency {
+
+    /**
+     *  @brief  QueueDepthEstimator class
+     *  Estimates the number of events to buffer in the thread pool queue
+     *  from the measured distribution of event service times and from the
+     *  reader latency (time to read and prepare the next event).
+     *
+     *  With N active workers, a mean service time m and a reader latency r
+     *  (plus the polling latency of the reader when the queue is full), the
+     *  workers consume about N*(r+poll)/m events while the reader refills one
+     *  slot. The completions of N workers cluster with a spread growing as
+     *  cv*sqrt(N), where cv is the coefficient of variation of the service
+     *  times. The queue depth is:
+     *
+     *    depth = ceil( N*(r+poll)/m ) + ceil( z*cv*sqrt(N) ) + 1
+     *
+     *  bounded by [1, maxInFlight - N], maxInFlight being the maximum number
+     *  of events held in memory by the scheduler. Means and variances are
+     *  exponentially weighted, so the estimate follows the workload drifts.
+     */
+    class QueueDepthEstimator {
+    public:
+      /**
+       *  @brief  Settings struct
+       */
+      struct Settings {
+        ///< The maximum number of events in flight (queued + processing + not retired)
+        std::size_t          _maxInFlight {4} ;
+        ///< The number of events used for the exponential averages
+        std::size_t          _window {100} ;
+        ///< The number of standard deviations of buffer for service time fluctuations
+        double               _safety {2.} ;
+        ///< The polling latency of the reader when the queue is full, in seconds
+        double               _pollLatency {0.001} ;
+        ///< The number of service time samples before the first estimate
+        std::size_t          _minSamples {10} ;
+      };
+
+    public:
+      QueueDepthEstimator() = delete ;
+      ~QueueDepthEstimator() = default ;
+      QueueDepthEstimator( const QueueDepthEstimator & ) = delete ;
+      QueueDepthEstimator &operator=( const QueueDepthEstimator & ) = delete ;
+
+      /**
+       *  @brief  Constructor
+       *
+       *  @param  settings the estimator settings
+       */
+      QueueDepthEstimator( const Settings &settings ) ;
+
+      /**
+       *  @brief  Add the service time of a finished event
+       *
+       *  @param  seconds the event service time
+       */
+      void addServiceTime( double seconds ) ;
+
+      /**
+       *  @brief  Add a reader latency sample
+       *
+       *  @param  seconds the time spent to read and prepare an event
+       */
+      void addReaderTime( double seconds ) ;
+
+      /**
+       *  @brief  Whether enough samples were collected to estimate the queue depth
+       */
+      bool ready() const ;
+
+      /**
+       *  @brief  Estimate the queue depth for a number of active workers
+       *
+       *  @param  workers the number of active workers
+       */
+      std::size_t estimate( std::size_t workers ) const ;
+
+      /**
+       *  @brief  Get the mean service time (seconds)
+       */
+      double serviceMean() const ;
+
+      /**
+       *  @brief  Get the standard deviation of the service time (seconds)
+       */
+      double serviceSigma() const ;
+
+      /**
+       *  @brief  Get the mean reader latency (seconds)
+       */
+      double readerMean() const ;
+
+    private:
+      ///< The estimator settings
+      Settings               _settings {} ;
+      ///< The exponential weight of a new sample
+      double                 _alpha {0.} ;
+      ///< The number of service time samples
+      std::size_t            _nServiceSamples {0} ;
+      ///< The service time mean
+      double                 _serviceMean {0.} ;
+      ///< The service time variance
+      double                 _serviceVariance {0.} ;
+      ///< The number of reader latency samples
+      std::size_t            _nReaderSamples {0} ;
+      ///< The reader latency mean
+      double                 _readerMean {0.} ;
+    };
+
+  }
+
+}
+
+#endif
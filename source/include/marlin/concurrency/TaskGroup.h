@@ -0,0 +1,198 @@
+#ifndef MARLIN_CONCURRENCY_TASKGROUP_h
+#define MARLIN_CONCURRENCY_TASKGROUP_h 1
+
+// -- std headers
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <utility>
+
+namespace marlin {
+
+  namespace concurrency {
+
+    class TaskGroup ;
+
+    /**
+     *  @brief  TaskQueue class
+     *  A queue of small tasks spawned by processors (see TaskGroup and
+     *  ProcessorApi::parallelFor). The tasks are executed by the idle
+     *  workers of the event thread pool and by the threads waiting for
+     *  their tasks to complete. No additional thread is created.
+     */
+    class TaskQueue {
+    public:
+      using Task = std::function<void()> ;
+      using Notifier = std::function<void()> ;
+
+    public:
+      TaskQueue() = default ;
+      ~TaskQueue() = default ;
+      TaskQueue( const TaskQueue & ) = delete ;
+      TaskQueue &operator=( const TaskQueue & ) = delete ;
+
+      /**
+       *  @brief  Push a task in the queue and notify the idle workers
+       *
+       *  @param  task the task to push
+       *  @param  group the group of the task, if any
+       */
+      void push( Task task, const TaskGroup *group = nullptr ) ;
+
+      /**
+       *  @brief  Pop a task and run it in the calling thread.
+       *  Returns false if the queue was empty (or had no task of the group)
+       *
+       *  @param  group if not null, only pop a task of this group
+       */
+      bool runOne( const TaskGroup *group = nullptr ) ;
+
+      /**
+       *  @brief  Whether the queue is empty
+       */
+      bool empty() const ;
+
+      /**
+       *  @brief  Set the function called after each push, to wake up idle workers.
+       *  Must not be called while tasks are being pushed
+       *
+       *  @param  notifier the notifier function
+       */
+      void setNotifier( Notifier notifier ) ;
+
+    private:
+      ///< The task queue, with the group of each task
+      std::deque<std::pair<const TaskGroup*, Task>> _tasks {} ;
+      ///< The synchronization mutex
+      mutable std::mutex         _mutex {} ;
+      ///< The notifier function
+      Notifier                   _notifier {nullptr} ;
+    };
+
+    //--------------------------------------------------------------------------
+    //--------------------------------------------------------------------------
+
+    /**
+     *  @brief  TaskGroup class
+     *  A group of tasks pushed in a TaskQueue. wait() blocks until all the
+     *  tasks of the group are done. While waiting, the calling thread runs
+     *  queued tasks itself (by default possibly from other groups), so that
+     *  waiting never deadlocks, even without any idle worker.
+     *  The first exception thrown by a task is rethrown by wait().
+     *  The destructor waits for the remaining tasks but never throws.
+     */
+    class TaskGroup {
+    public:
+      TaskGroup() = delete ;
+      TaskGroup( const TaskGroup & ) = delete ;
+      TaskGroup &operator=( const TaskGroup & ) = delete ;
+
+      /**
+       *  @brief  Constructor
+       *
+       *  @param  queue the task queue to push tasks in
+       */
+      TaskGroup( TaskQueue &queue ) ;
+
+      /**
+       *  @brief  Destructor. Wait for the remaining tasks
+       */
+      ~TaskGroup() ;
+
+      /**
+       *  @brief  Run a function as a task of the group
+       *
+       *  @param  function the function to run
+       */
+      void run( std::function<void()> function ) ;
+
+      /**
+       *  @brief  Wait for all tasks of the group, helping with queued tasks
+       *  meanwhile. Rethrows the first exception thrown by a task.
+       *  A thread that must not be held by unrelated tasks (e.g a reader thread)
+       *  only runs the queued tasks of this group
+       *
+       *  @param  helpOthers whether to run the queued tasks of other groups too
+       */
+      void wait( bool helpOthers = true ) ;
+
+    private:
+      /**
+       *  @brief  Wait for all tasks of the group without rethrowing
+       *
+       *  @param  helpOthers whether to run the queued tasks of other groups too
+       */
+      void waitNoThrow( bool helpOthers = true ) ;
+
+      /**
+       *  @brief  Mark a task as done
+       *
+       *  @param  exception the exception thrown by the task, if any
+       */
+      void taskDone( std::exception_ptr exception ) ;
+
+    private:
+      ///< The task queue
+      TaskQueue                   &_queue ;
+      ///< The number of pending tasks
+      std::atomic<std::size_t>     _pending {0} ;
+      ///< The synchronization mutex
+      std::mutex                   _mutex {} ;
+      ///< The condition variable notified when a task is done
+      std::condition_variable      _conditionVariable {} ;
+      ///< The first exception thrown by a task
+      std::exception_ptr           _exception {nullptr} ;
+    };
+
+    //--------------------------------------------------------------------------
+    //--------------------------------------------------------------------------
+
+    /**
+     *  @brief  Run a function over the range [begin, end) split in chunks of grain
+     *  elements. The function signature must be void(std::size_t first, std::size_t last)
+     *  and is called for each chunk [first, last). The first chunk is run by the
+     *  calling thread, the others are pushed as tasks in the queue.
+     *  Returns once all chunks are processed. Rethrows the first exception
+     *
+     *  @param  queue the task queue
+     *  @param  begin the range begin
+     *  @param  end the range end
+     *  @param  grain the chunk size (at least 1)
+     *  @param  function the function to run on each chunk
+     */
+    template <typename FUNCTION>
+    inline void parallelFor( TaskQueue &queue, std::size_t begin, std::size_t end, std::size_t grain, FUNCTION function ) {
+      if( end <= begin ) {
+        return ;
+      }
+      grain = std::max( grain, std::size_t(1) ) ;
+      TaskGroup group( queue ) ;
+      for( std::size_t first = begin + grain ; first < end ; first += grain ) {
+        const std::size_t last = std::min( first + grain, end ) ;
+        group.run( [&function, first, last]() {
+          function( first, last ) ;
+        }) ;
+      }
+      std::exception_ptr exception {nullptr} ;
+      try {
+        function( begin, std::min( begin + grain, end ) ) ;
+      }
+      catch( ... ) {
+        exception = std::current_exception() ;
+      }
+      // the tasks reference the function: always wait before leaving
+      group.wait() ;
+      if( nullptr != exception ) {
+        std::rethrow_exception( exception ) ;
+      }
+    }
+
+  }
+
+}
+
+#endif
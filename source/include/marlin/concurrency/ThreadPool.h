@@ -11,11 +11,13 @@
 #include <memory>
 #include <future>
 #include <condition_variable>
+#include <algorithm>
 
 // -- marlin headers
 #include "marlin/Exceptions.h"
 #include "marlin/concurrency/Queue.h"
 #include "marlin/concurrency/QueueElement.h"
+#include "marlin/concurrency/TaskGroup.h"
 
 namespace marlin {
 
@@ -68,6 +70,24 @@ namespace marlin {
       template <typename WORKER, typename ...Args>
       void addWorker(Args &&...args) ;
 
+      /**
+       *  @brief  Set the CPUs on which a worker thread runs.
+       *  Must be called before start()
+       *
+       *  @param  index the worker index
+       *  @param  cpus the list of CPUs (empty for no pinning)
+       */
+      void setWorkerAffinity( std::size_t index, const std::vector<int> &cpus ) ;
+
+      /**
+       *  @brief  Set the queue of processor tasks to help with.
+       *  Workers with no element to process run the queued tasks
+       *  instead of waiting. Must be called before start()
+       *
+       *  @param  queue the task queue (nullptr to disable)
+       */
+      void setTaskQueue( TaskQueue *queue ) ;
+
       /**
        *  @brief  Start the worker threads
        */
@@ -88,10 +108,35 @@ namespace marlin {
        */
       std::size_t nRunning() const ;
 
+      /**
+       *  @brief  Set the number of active (not parked) workers.
+       *  Workers with an index greater or equal to n are parked: they finish
+       *  their current task and stop taking new ones. At least one worker
+       *  stays active. Can be called while the pool is running
+       *
+       *  @param  n the number of active workers
+       */
+      void setActiveWorkers( std::size_t n ) ;
+
+      /**
+       *  @brief  Get the number of active (not parked) workers
+       */
+      std::size_t activeWorkers() const ;
+
       /**
        *  @brief  Get the number of free slots in the task queue
        */
       std::size_t freeSlots() const ;
+
+      /**
+       *  @brief  Get the number of tasks in the queue
+       */
+      std::size_t queueSize() const ;
+
+      /**
+       *  @brief  Get the maximum queue size
+       */
+      std::size_t maxQueueSize() const ;
       
       /**
        *  @brief  Whether the queue is empty
@@ -150,6 +195,23 @@ namespace marlin {
       template <class = typename std::enable_if<not std::is_same<IN,void>::value>::type>
       PushResult push( PushPolicy policy, IN && input ) ;
 
+    private:
+      /**
+       *  @brief  Wake up waiting workers after a push
+       */
+      void notifyWorkers() ;
+
+      /**
+       *  @brief  Run a task from the task queue, if any.
+       *  Returns true if a task was run
+       */
+      bool runTask() ;
+
+      /**
+       *  @brief  Whether the task queue has tasks to run
+       */
+      bool hasTask() const ;
+
     private:
       ///< The synchronization mutex
       std::mutex               _mutex {} ;
@@ -167,6 +229,10 @@ namespace marlin {
       std::atomic<bool>        _isRunning {false} ;
       ///< Whether the thread pool accepts push action
       std::atomic<bool>        _acceptPush {true} ;
+      ///< The number of parked workers
+      std::atomic<std::size_t> _nParked {0} ;
+      ///< The processor task queue to help with
+      TaskQueue               *_taskQueue {nullptr} ;
     };
 
   }
@@ -200,6 +266,34 @@ namespace marlin {
 
     //--------------------------------------------------------------------------
 
+    template <typename IN, typename OUT>
+    inline void ThreadPool<IN,OUT>::setWorkerAffinity( std::size_t index, const std::vector<int> &cpus ) {
+      if( _isRunning ) {
+        throw Exception( "ThreadPool::setWorkerAffinity: thread pool is running, can't set affinity!" ) ;
+      }
+      _pool.at( index )->setAffinity( cpus ) ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename IN, typename OUT>
+    inline void ThreadPool<IN,OUT>::setTaskQueue( TaskQueue *queue ) {
+      if( _isRunning ) {
+        throw Exception( "ThreadPool::setTaskQueue: thread pool is running, can't set task queue!" ) ;
+      }
+      if( nullptr != _taskQueue ) {
+        _taskQueue->setNotifier( nullptr ) ;
+      }
+      _taskQueue = queue ;
+      if( nullptr != _taskQueue ) {
+        _taskQueue->setNotifier( [this](){
+          notifyWorkers() ;
+        }) ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+
     template <typename IN, typename OUT>
     inline void ThreadPool<IN,OUT>::start() {
       if( _isRunning ) {
@@ -207,7 +301,7 @@ namespace marlin {
       }
       // Start the worker threads
       for (size_t i=0 ; i<_pool.size() ; i++) {
-        _pool[i]->start() ;
+        _pool[i]->start( i ) ;
       }
       _isRunning = true ;
     }
@@ -241,10 +335,51 @@ namespace marlin {
 
     //--------------------------------------------------------------------------
 
+    template <typename IN, typename OUT>
+    inline void ThreadPool<IN,OUT>::setActiveWorkers( std::size_t n ) {
+      n = std::max( n, std::size_t(1) ) ;
+      for( std::size_t i=0 ; i<_pool.size() ; ++i ) {
+        _pool[i]->park( i >= n ) ;
+      }
+      _nParked = ( n < _pool.size() ) ? _pool.size() - n : 0 ;
+      // wake up unparked workers
+      std::unique_lock<std::mutex> lock(_mutex) ;
+      _conditionVariable.notify_all() ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename IN, typename OUT>
+    inline std::size_t ThreadPool<IN,OUT>::activeWorkers() const {
+      std::size_t count = 0 ;
+      for( auto &worker : _pool ) {
+        if( not worker->parked() ) {
+          ++count ;
+        }
+      }
+      return count ;
+    }
+
+    //--------------------------------------------------------------------------
+
     template <typename IN, typename OUT>
     inline std::size_t ThreadPool<IN,OUT>::freeSlots() const {
       return _queue.freeSlots() ;
     }
+
+    //--------------------------------------------------------------------------
+
+    template <typename IN, typename OUT>
+    inline std::size_t ThreadPool<IN,OUT>::queueSize() const {
+      return _queue.size() ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename IN, typename OUT>
+    inline std::size_t ThreadPool<IN,OUT>::maxQueueSize() const {
+      return _queue.maxSize() ;
+    }
     
     //--------------------------------------------------------------------------
     
@@ -323,6 +458,10 @@ namespace marlin {
       for (auto &worker : _pool) {  // wait for the computing threads to finish
         worker->join() ;
       }
+      if( nullptr != _taskQueue ) {
+        _taskQueue->setNotifier( nullptr ) ;
+        _taskQueue = nullptr ;
+      }
       _queue.clear() ;
       _pool.clear() ;
       _isRunning = false ;
@@ -358,11 +497,39 @@ namespace marlin {
         }
         _queue.push(element) ;
       }
-      std::unique_lock<std::mutex> lock(_mutex) ;
-      _conditionVariable.notify_one() ;
+      notifyWorkers() ;
       return std::move(result) ;
     }
 
+    //--------------------------------------------------------------------------
+
+    template <typename IN, typename OUT>
+    inline void ThreadPool<IN,OUT>::notifyWorkers() {
+      std::unique_lock<std::mutex> lock(_mutex) ;
+      // a parked worker may consume a single notification without
+      // taking the element: wake up everybody in this case
+      if( _nParked.load() > 0 ) {
+        _conditionVariable.notify_all() ;
+      }
+      else {
+        _conditionVariable.notify_one() ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename IN, typename OUT>
+    inline bool ThreadPool<IN,OUT>::runTask() {
+      return ( nullptr != _taskQueue ) && _taskQueue->runOne() ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename IN, typename OUT>
+    inline bool ThreadPool<IN,OUT>::hasTask() const {
+      return ( nullptr != _taskQueue ) && ( not _taskQueue->empty() ) ;
+    }
+
   } // end namespace concurrency
 
 } // end namespace marlin
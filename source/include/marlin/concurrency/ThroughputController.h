@@ -0,0 +1,128 @@
+#ifndef MARLIN_CONCURRENCY_THROUGHPUTCONTROLLER_h
+#define MARLIN_CONCURRENCY_THROUGHPUTCONTROLLER_h 1
+
+// -- std headers
+#include <string>
+#include <map>
+
+// -- marlin headers
+#include <marlin/Utils.h>
+
+namespace marlin {
+
+  namespace concurrency {
+
+    /**
+     *  @brief  ThroughputController class
+     *  Hill-climbing controller of the number of active workers of a thread pool.
+     *
+     *  The scheduler feeds the controller with finished events (with the time
+     *  spent in processors and the time spent waiting on critical sections).
+     *  At the end of each measurement interval,
+     *  the controller computes the throughput (events/s) and:
+     *   - if the last move made the throughput worse, reverts it, reverses the
+     *     search direction and holds for a few intervals,
+     *   - else keeps moving in the same direction, or starts a new probe after
+     *     holding. The search goes downwards first when the lock-wait fraction
+     *     is high (critical sections saturate).
+     *  The number of workers is bounded by [1, maxWorkers]. The queue depth
+     *  is handled separately, see QueueDepthEstimator.
+     */
+    class ThroughputController {
+    public:
+      /**
+       *  @brief  Settings struct
+       */
+      struct Settings {
+        ///< The maximum number of workers (the steering Concurrency)
+        std::size_t          _maxWorkers {1} ;
+        ///< The measurement interval, in seconds
+        double               _interval {2.} ;
+        ///< The relative throughput change considered as significant
+        double               _tolerance {0.05} ;
+        ///< The lock-wait fraction above which the search goes downwards
+        double               _lockThreshold {0.3} ;
+        ///< The number of intervals to hold after a reverted move
+        unsigned int         _holdIntervals {5} ;
+        ///< The minimum number of events in an interval to take a decision
+        std::size_t          _minEvents {10} ;
+      };
+
+      /**
+       *  @brief  Decision struct
+       */
+      struct Decision {
+        ///< The number of active workers
+        std::size_t          _workers {1} ;
+        ///< The measured throughput (events/s)
+        double               _throughput {0.} ;
+        ///< The measured lock-wait fraction
+        double               _lockFraction {0.} ;
+        ///< The decision explanation
+        std::string          _reason {} ;
+      };
+
+    public:
+      ThroughputController() = delete ;
+      ~ThroughputController() = default ;
+      ThroughputController( const ThroughputController & ) = delete ;
+      ThroughputController &operator=( const ThroughputController & ) = delete ;
+
+      /**
+       *  @brief  Constructor. Starts with all workers active
+       *
+       *  @param  settings the controller settings
+       */
+      ThroughputController( const Settings &settings ) ;
+
+      /**
+       *  @brief  Add a finished event
+       *
+       *  @param  appTime the time spent in the sequence, including locks
+       *  @param  procTime the time spent in the processors
+       */
+      void addEvent( clock::duration_rep appTime, clock::duration_rep procTime ) ;
+
+      /**
+       *  @brief  Update the controller. If the measurement interval is over,
+       *  take a decision and return true, else return false
+       *
+       *  @param  decision the decision to receive
+       */
+      bool update( Decision &decision ) ;
+
+      /**
+       *  @brief  Get the current number of active workers
+       */
+      std::size_t workers() const ;
+
+    private:
+      ///< The controller settings
+      Settings                         _settings {} ;
+      ///< The current number of active workers
+      std::size_t                      _workers {1} ;
+      ///< The number of workers before the last move
+      std::size_t                      _previousWorkers {1} ;
+      ///< The search direction (+1 or -1)
+      int                              _direction {-1} ;
+      ///< Whether the last interval was a probe (move to evaluate)
+      bool                             _probing {false} ;
+      ///< The number of intervals left to hold
+      unsigned int                     _holdCounter {0} ;
+      ///< The smoothed throughput per number of workers
+      std::map<std::size_t, double>    _throughputs {} ;
+      ///< The start of the current interval
+      clock::time_point                _intervalStart {} ;
+      ///< The number of events in the current interval
+      std::size_t                      _nEvents {0} ;
+      ///< The total sequence time in the current interval
+      double                           _appTime {0.} ;
+      ///< The total processor time in the current interval
+      double                           _procTime {0.} ;
+    };
+
+  }
+
+}
+
+#endif
@@ -15,7 +15,10 @@
 
 // -- marlin headers
 #include "marlin/Exceptions.h"
+#include "marlin/Logging.h"
+#include "marlin/WorkerLocal.h"
 #include "marlin/concurrency/QueueElement.h"
+#include "marlin/concurrency/CPUTopology.h"
 
 namespace marlin {
 
@@ -150,10 +153,25 @@ namespace marlin {
       template <typename IMPL, class = typename std::enable_if<std::is_base_of<Impl,IMPL>::value>::type>
       Worker( Pool &pool, std::unique_ptr<IMPL> impl ) ;
 
+      /**
+       *  @brief  Set the CPUs on which the worker thread runs.
+       *  Applied when the thread starts. An empty list means no pinning
+       *
+       *  @param  cpus the list of CPUs
+       */
+      void setAffinity( const CPUTopology::CPUList &cpus ) ;
+
+      /**
+       *  @brief  Get the CPUs on which the worker thread runs
+       */
+      const CPUTopology::CPUList &affinity() const ;
+
       /**
        *  @brief  Start the worker thread
+       *
+       *  @param  index the worker index in the pool (see WorkerLocalBase::currentWorkerIndex())
        */
-      void start() ;
+      void start( std::size_t index ) ;
 
       /**
        *  @brief  The method executing in the worker thread
@@ -176,6 +194,21 @@ namespace marlin {
        */
       bool waiting() const ;
 
+      /**
+       *  @brief  Park or unpark the worker. A parked worker finishes its current
+       *  task and then waits without taking new tasks from the queue, until
+       *  it is unparked or the pool stops. The caller must notify the pool
+       *  condition variable on unpark (see ThreadPool::setActiveWorkers())
+       *
+       *  @param  park whether to park the worker
+       */
+      void park( bool park ) ;
+
+      /**
+       *  @brief  Whether the worker is parked
+       */
+      bool parked() const ;
+
       /**
        *  @brief  Join the worker thread
        */
@@ -190,8 +223,12 @@ namespace marlin {
       std::atomic<bool>            _stopFlag {false} ;
       ///< Whether the worker thread is waiting for data
       std::atomic<bool>            _waitingFlag {false} ;
+      ///< Whether the worker is parked
+      std::atomic<bool>            _parkedFlag {false} ;
       ///< The worker implementation
       std::unique_ptr<Impl>        _impl {nullptr} ;
+      ///< The CPUs on which the worker thread runs
+      CPUTopology::CPUList         _cpus {} ;
     };
 
   }
@@ -216,8 +253,35 @@ namespace marlin {
     //--------------------------------------------------------------------------
 
     template <typename IN, typename OUT>
-    inline void Worker<IN,OUT>::start() {
-      _thread = std::thread( &Worker::run, this ) ;
+    inline void Worker<IN,OUT>::setAffinity( const CPUTopology::CPUList &cpus ) {
+      if( running() ) {
+        throw Exception( "Worker::setAffinity: worker is running, can't set affinity!" ) ;
+      }
+      _cpus = cpus ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename IN, typename OUT>
+    inline const CPUTopology::CPUList &Worker<IN,OUT>::affinity() const {
+      return _cpus ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename IN, typename OUT>
+    inline void Worker<IN,OUT>::start( std::size_t index ) {
+      // pin the thread before it touches any memory, so that
+      // its allocations are placed on the local NUMA node
+      _thread = std::thread( [this,index]() {
+        if( not _cpus.empty() and not CPUTopology::pinCurrentThread( _cpus ) ) {
+          Logging::createLogger( "Worker" )->log<WARNING>() << "Worker " << index << ": couldn't pin the thread on CPU(s) "
+            << CPUTopology::toString( _cpus ) << ", running unpinned" << std::endl ;
+        }
+        // before any task: the tasks may use worker local storage
+        WorkerLocalBase::setCurrentWorkerIndex( index ) ;
+        run() ;
+      }) ;
     }
 
     //--------------------------------------------------------------------------
@@ -225,7 +289,7 @@ namespace marlin {
     template <typename IN, typename OUT>
     inline void Worker<IN,OUT>::run() {
       QueueElement<IN,OUT> element ;
-      bool isPop = _threadPool._queue.pop( element ) ;
+      bool isPop = ( not _parkedFlag.load() ) && _threadPool._queue.pop( element ) ;
       while (true) {
         // if there is anything in the queue
         while (isPop) {
@@ -233,19 +297,32 @@ namespace marlin {
           // the thread is wanted to stop, return even if the queue is not empty yet
           if (_stopFlag.load())
             return;
+          // parked: don't take new elements
+          else if (_parkedFlag.load())
+            isPop = false ;
           else
             isPop = _threadPool._queue.pop( element ) ;
         }
-        // the queue is empty here, wait for the next command
+        // no element to process: help with the processor tasks before waiting
+        if ( not _parkedFlag.load() && _threadPool.runTask() ) {
+          if (_stopFlag.load())
+            return;
+          isPop = ( not _parkedFlag.load() ) && _threadPool._queue.pop( element ) ;
+          continue ;
+        }
+        // the queue is empty (or the worker is parked) here, wait for the next command
+        bool hasTask = false ;
         std::unique_lock<std::mutex> lock(_threadPool._mutex);
         _waitingFlag = true ;
-        _threadPool._conditionVariable.wait(lock, [this, &element, &isPop](){
-          isPop = _threadPool._queue.pop( element ) ;
-          return isPop || _threadPool._isDone || _stopFlag ;
+        _threadPool._conditionVariable.wait(lock, [this, &element, &isPop, &hasTask](){
+          isPop = ( not _parkedFlag.load() ) && _threadPool._queue.pop( element ) ;
+          hasTask = ( not _parkedFlag.load() ) && _threadPool.hasTask() ;
+          return isPop || hasTask || _threadPool._isDone || _stopFlag ;
         }) ;
         _waitingFlag = false ;
-        // if the queue is empty and this->isDone == true or *flag then return
-        if ( not isPop ) {
+        // if the queue is empty and this->isDone == true or *flag then return.
+        // Remaining tasks belong to events in flight: their workers finish them
+        if ( not isPop && ( not hasTask || _threadPool._isDone || _stopFlag ) ) {
           return ;
         }
       }
@@ -274,6 +351,20 @@ namespace marlin {
 
     //--------------------------------------------------------------------------
 
+    template <typename IN, typename OUT>
+    inline void Worker<IN,OUT>::park( bool park ) {
+      _parkedFlag = park ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename IN, typename OUT>
+    inline bool Worker<IN,OUT>::parked() const {
+      return _parkedFlag.load() ;
+    }
+
+    //--------------------------------------------------------------------------
+
     template <typename IN, typename OUT>
     inline void Worker<IN,OUT>::join() {
       if( _thread.joinable() ) {
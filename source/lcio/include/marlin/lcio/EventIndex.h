@@ -0,0 +1,153 @@
+#ifndef MARLIN_EVENTINDEX_h
+#define MARLIN_EVENTINDEX_h 1
+
+// -- std headers
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <cstdint>
+
+namespace marlin {
+
+  /**
+   *  @brief  EventIndex class.
+   *
+   *  Maps the events of a LCIO file, by ordinal position and by (run, event)
+   *  numbers, to their offset in the file. The index is built by scanning the
+   *  SIO record headers and decoding only the event header records, so it is
+   *  much faster than reading the file with LCIO. It is saved in a sidecar file
+   *  (by default <file>.idx) next to the LCIO file, a text file with one line
+   *  per record:
+   *
+   *    MarlinEventIndex <version> <file size> <file modification time>
+   *    R <run> <offset>
+   *    E <run> <event> <offset>
+   *
+   *  The file size and modification time are used to detect a stale index.
+   */
+  class EventIndex {
+  public:
+    ///< The sidecar file format version
+    static constexpr unsigned int Version = 1 ;
+    ///< The sidecar file extension
+    static constexpr const char *Extension = ".idx" ;
+
+    /**
+     *  @brief  Entry struct
+     */
+    struct Entry {
+      ///< The run number
+      int                  _run {0} ;
+      ///< The event number (unused for a run header)
+      int                  _event {0} ;
+      ///< The offset of the event (or run) header record in the file
+      std::uint64_t        _offset {0} ;
+      ///< The number of run headers preceding the record in the file
+      std::size_t          _runHeaders {0} ;
+    };
+
+  public:
+    EventIndex() = default ;
+    ~EventIndex() = default ;
+    EventIndex( const EventIndex & ) = default ;
+    EventIndex &operator=( const EventIndex & ) = default ;
+    EventIndex( EventIndex && ) = default ;
+    EventIndex &operator=( EventIndex && ) = default ;
+
+    /**
+     *  @brief  Build the index of a LCIO file
+     *
+     *  @param  fname the LCIO file name
+     */
+    static EventIndex build( const std::string &fname ) ;
+
+    /**
+     *  @brief  Load the index of a LCIO file from its sidecar file.
+     *  Throw if the sidecar file doesn't exist or is stale
+     *
+     *  @param  fname the LCIO file name
+     *  @param  indexFile the sidecar file name (default: <fname>.idx)
+     */
+    static EventIndex load( const std::string &fname, const std::string &indexFile = "" ) ;
+
+    /**
+     *  @brief  Whether the sidecar file of a LCIO file exists and is up to date
+     *
+     *  @param  fname the LCIO file name
+     *  @param  indexFile the sidecar file name (default: <fname>.idx)
+     */
+    static bool upToDate( const std::string &fname, const std::string &indexFile = "" ) ;
+
+    /**
+     *  @brief  Get the default sidecar file name of a LCIO file
+     *
+     *  @param  fname the LCIO file name
+     */
+    static std::string indexFileName( const std::string &fname ) ;
+
+    /**
+     *  @brief  Save the index in a sidecar file
+     *
+     *  @param  indexFile the sidecar file name (default: <file>.idx)
+     */
+    void save( const std::string &indexFile = "" ) const ;
+
+    /**
+     *  @brief  Get the indexed LCIO file name
+     */
+    const std::string &fileName() const ;
+
+    /**
+     *  @brief  Get the event entries, in file order
+     */
+    const std::vector<Entry> &events() const ;
+
+    /**
+     *  @brief  Get the run header entries, in file order
+     */
+    const std::vector<Entry> &runHeaders() const ;
+
+    /**
+     *  @brief  Find the ordinal position of an event. Returns -1 if not found.
+     *  If the (run, event) pair is not unique, the first event is returned
+     *
+     *  @param  run the run number
+     *  @param  event the event number
+     */
+    long find( int run, int event ) const ;
+
+    /**
+     *  @brief  Get the number of (run, event) pairs found more than once in the file
+     */
+    std::size_t duplicates() const ;
+
+  private:
+    /**
+     *  @brief  Add an entry and update the lookup table
+     *
+     *  @param  entry the entry to add
+     *  @param  runHeader whether the entry is a run header
+     */
+    void add( Entry entry, bool runHeader ) ;
+
+  private:
+    ///< The LCIO file name
+    std::string                                _fileName {} ;
+    ///< The LCIO file size
+    std::uint64_t                              _fileSize {0} ;
+    ///< The LCIO file modification time
+    std::int64_t                               _fileTime {0} ;
+    ///< The event entries
+    std::vector<Entry>                         _events {} ;
+    ///< The run header entries
+    std::vector<Entry>                         _runHeaders {} ;
+    ///< The (run, event) lookup table
+    std::map<std::pair<int, int>, std::size_t> _lookup {} ;
+    ///< The number of duplicated (run, event) pairs
+    std::size_t                                _duplicates {0} ;
+  };
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef MARLIN_MAPPEDFILE_h
+#define MARLIN_MAPPEDFILE_h 1
+
+// -- std headers
+#include <string>
+#include <cstdint>
+
+namespace marlin {
+
+  /**
+   *  @brief  MappedFile class.
+   *
+   *  A read-only memory mapping of a whole file. The file content is
+   *  accessed in place, without copy through a stream buffer. The kernel
+   *  readahead and the page cache usage are driven by advices on ranges
+   *  of the file: prefetch() the ranges about to be read and release()
+   *  the ranges already consumed.
+   */
+  class MappedFile {
+  public:
+    MappedFile() = delete ;
+    MappedFile( const MappedFile & ) = delete ;
+    MappedFile &operator=( const MappedFile & ) = delete ;
+
+    /**
+     *  @brief  Constructor. Open and map the file
+     *
+     *  @param  fname the file name
+     */
+    MappedFile( const std::string &fname ) ;
+
+    /**
+     *  @brief  Destructor. Unmap and close the file
+     */
+    ~MappedFile() ;
+
+    /**
+     *  @brief  Get the file name
+     */
+    const std::string &fileName() const ;
+
+    /**
+     *  @brief  Get the mapped file content (nullptr for an empty file)
+     */
+    const unsigned char *data() const ;
+
+    /**
+     *  @brief  Get the file size
+     */
+    std::uint64_t size() const ;
+
+    /**
+     *  @brief  Advise the kernel that the file is read sequentially:
+     *  aggressive readahead, pages dropped soon after being read
+     */
+    void adviseSequential() ;
+
+    /**
+     *  @brief  Start reading a range of the file in the page cache
+     *
+     *  @param  offset the range offset
+     *  @param  length the range length
+     */
+    void prefetch( std::uint64_t offset, std::uint64_t length ) ;
+
+    /**
+     *  @brief  Release the pages of a consumed range of the file, from
+     *  the mapping and from the page cache. Only the pages fully inside
+     *  the range are released
+     *
+     *  @param  offset the range offset
+     *  @param  length the range length
+     */
+    void release( std::uint64_t offset, std::uint64_t length ) ;
+
+  private:
+    ///< The file name
+    std::string              _fileName {} ;
+    ///< The file descriptor
+    int                      _fd {-1} ;
+    ///< The mapped file content
+    unsigned char           *_data {nullptr} ;
+    ///< The file size
+    std::uint64_t            _size {0} ;
+  };
+
+}
+
+#endif
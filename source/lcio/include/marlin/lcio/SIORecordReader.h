@@ -0,0 +1,162 @@
+#ifndef MARLIN_SIORECORDREADER_h
+#define MARLIN_SIORECORDREADER_h 1
+
+// -- std headers
+#include <string>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <memory>
+
+namespace marlin {
+
+  class MappedFile ;
+
+  /**
+   *  @brief  SIORecord struct
+   *  The location of a raw SIO record in a file
+   */
+  struct SIORecord {
+    ///< The record name (e.g LCEventHeader, LCEvent, LCRunHeader)
+    std::string          _name {} ;
+    ///< The record offset in the file
+    std::uint64_t        _offset {0} ;
+    ///< The record size in the file (header + padded data)
+    std::uint64_t        _size {0} ;
+    ///< The record options (compression flag)
+    std::uint32_t        _options {0} ;
+    ///< The record header length (offset of the data in the record)
+    std::uint32_t        _headerLength {0} ;
+    ///< The record data length in the file
+    std::uint32_t        _dataLength {0} ;
+    ///< The uncompressed record data length
+    std::uint32_t        _ucmpLength {0} ;
+  };
+
+  /**
+   *  @brief  SIORecordReader class.
+   *
+   *  Scans the records of a SIO (LCIO) file without decoding them: only
+   *  the record headers are read and the record data are skipped. The raw
+   *  records can be copied to another stream, e.g to concatenate files.
+   *  A SIO record is a header followed by the (possibly compressed) data,
+   *  padded to 4 bytes. All header words are big endian:
+   *
+   *    header length, record marker (0xabadcafe), options,
+   *    data length, uncompressed data length, name length, name (padded)
+   *
+   *  In mapped mode, the file is memory mapped (see MappedFile) and read
+   *  sequentially: the records are accessed in place, without copy.
+   */
+  class SIORecordReader {
+  public:
+    ///< The SIO record marker
+    static constexpr std::uint32_t RecordMarker = 0xabadcafe ;
+    ///< The SIO block marker
+    static constexpr std::uint32_t BlockMarker = 0xdeadbeef ;
+    ///< The SIO record option flag for zlib compressed data
+    static constexpr std::uint32_t CompressOption = 0x00000001 ;
+    ///< The LCIO random access record name
+    static constexpr const char *RandomAccessRecord = "LCIORandomAccess" ;
+    ///< The LCIO index record name
+    static constexpr const char *IndexRecord = "LCIOIndex" ;
+
+  public:
+    SIORecordReader() = delete ;
+    ~SIORecordReader() ;
+    SIORecordReader( const SIORecordReader & ) = delete ;
+    SIORecordReader &operator=( const SIORecordReader & ) = delete ;
+
+    /**
+     *  @brief  Constructor. Open the file
+     *
+     *  @param  fname the SIO file name
+     *  @param  mapped whether to memory map the file
+     */
+    SIORecordReader( const std::string &fname, bool mapped = false ) ;
+
+    /**
+     *  @brief  Read the next record header and skip its data.
+     *  Returns false at the end of the file
+     *
+     *  @param  record the record to receive
+     */
+    bool next( SIORecord &record ) ;
+
+    /**
+     *  @brief  Read all the remaining records
+     */
+    std::vector<SIORecord> readAll() ;
+
+    /**
+     *  @brief  Copy a raw record to an output stream
+     *
+     *  @param  record the record to copy
+     *  @param  stream the output stream
+     */
+    void copy( const SIORecord &record, std::ostream &stream ) ;
+
+    /**
+     *  @brief  Read the data of a record, uncompressed if needed
+     *
+     *  @param  record the record to read
+     *  @param  data the uncompressed record data to receive
+     */
+    void readData( const SIORecord &record, std::vector<unsigned char> &data ) ;
+
+    /**
+     *  @brief  Get the raw (possibly compressed) data of a record, in place
+     *  in the mapped file. Mapped mode only
+     *
+     *  @param  record the record
+     */
+    const unsigned char *view( const SIORecord &record ) const ;
+
+    /**
+     *  @brief  Get the mapped file (nullptr if not in mapped mode)
+     */
+    MappedFile *mappedFile() const ;
+
+    /**
+     *  @brief  Whether the record is a LCIO random access or index record.
+     *  These records point to absolute file offsets and must be dropped
+     *  when records are moved to another file
+     *
+     *  @param  record the record to check
+     */
+    static bool isRandomAccess( const SIORecord &record ) ;
+
+    /**
+     *  @brief  Read a big endian 32 bits word
+     *
+     *  @param  bytes the first byte of the word
+     */
+    static std::uint32_t readWord( const unsigned char *bytes ) ;
+
+  private:
+    /**
+     *  @brief  Get a range of the file, in place in mapped mode or read in a buffer.
+     *  Returns nullptr if the range is beyond the end of the file
+     *
+     *  @param  offset the range offset
+     *  @param  length the range length
+     *  @param  buffer the buffer to read into (not mapped mode)
+     */
+    const unsigned char *fetch( std::uint64_t offset, std::uint64_t length, std::vector<unsigned char> &buffer ) ;
+
+  private:
+    ///< The file name
+    std::string              _fileName {} ;
+    ///< The input file stream
+    std::ifstream            _file {} ;
+    ///< The current offset in the file
+    std::uint64_t            _offset {0} ;
+    ///< The copy buffer
+    std::vector<unsigned char> _buffer {} ;
+    ///< The mapped file (mapped mode only)
+    std::unique_ptr<MappedFile> _mappedFile {nullptr} ;
+  };
+
+}
+
+#endif
@@ -0,0 +1,74 @@
+// -- std headers
+#include <iostream>
+#include <string>
+#include <vector>
+
+// -- marlin headers
+#include <marlin/lcio/EventIndex.h>
+#include <marlin/Exceptions.h>
+
+using namespace marlin ;
+
+void printUsage( const std::string &program ) {
+  std::cout << " Usage: " << program << " [--force] [--print] file.slcio ..." << std::endl
+    << "   Build the event index files (file.slcio" << EventIndex::Extension << ") of LCIO files," << std::endl
+    << "   used by the LCIO data source (UseEventIndex) for random access." << std::endl
+    << "   --force: rebuild the index files even if they are up to date" << std::endl
+    << "   --print: print the run and event numbers with their file offsets" << std::endl ;
+}
+
+int main( int argc, char **argv ) {
+  const std::string program = argv[0] ;
+  bool force {false}, print {false} ;
+  std::vector<std::string> files ;
+  for( int i=1 ; i<argc ; ++i ) {
+    const std::string arg = argv[i] ;
+    if( arg == "-h" or arg == "-?" ) {
+      printUsage( program ) ;
+      return 0 ;
+    }
+    if( arg == "--force" ) {
+      force = true ;
+      continue ;
+    }
+    if( arg == "--print" ) {
+      print = true ;
+      continue ;
+    }
+    files.push_back( arg ) ;
+  }
+  if( files.empty() ) {
+    printUsage( program ) ;
+    return 1 ;
+  }
+  try {
+    for( auto &fname : files ) {
+      EventIndex index {} ;
+      if( not force and EventIndex::upToDate( fname ) ) {
+        index = EventIndex::load( fname ) ;
+      }
+      else {
+        index = EventIndex::build( fname ) ;
+        index.save() ;
+      }
+      std::cout << fname << ": " << index.events().size() << " events, "
+        << index.runHeaders().size() << " run headers" ;
+      if( index.duplicates() > 0 ) {
+        std::cout << ", " << index.duplicates() << " duplicated (run, event) numbers" ;
+      }
+      std::cout << std::endl ;
+      if( print ) {
+        for( std::size_t e=0 ; e<index.events().size() ; ++e ) {
+          auto &entry = index.events()[e] ;
+          std::cout << "  " << e << ": run " << entry._run << ", event " << entry._event
+            << ", offset " << entry._offset << std::endl ;
+        }
+      }
+    }
+  }
+  catch( marlin::Exception &e ) {
+    std::cerr << "Couldn't index files: " << e.what() << std::endl ;
+    return 1 ;
+  }
+  return 0 ;
+}
@@ -0,0 +1,176 @@
+// -- std headers
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+// -- marlin headers
+#include <marlin/lcio/SIORecordReader.h>
+#include <marlin/Exceptions.h>
+
+using namespace marlin ;
+
+/**
+ *  @brief  Item struct
+ *  A run header or an event (event header + event records) of a shard
+ */
+struct Item {
+  ///< Whether the item is a run header
+  bool                     _runHeader {false} ;
+  ///< The input index of the item (ordered mode)
+  std::size_t              _index {0} ;
+  ///< The run segment of the item: the number of run headers up to this item in its shard
+  std::size_t              _segment {0} ;
+  ///< The shard index
+  std::size_t              _shard {0} ;
+  ///< The item records
+  std::vector<SIORecord>   _records {} ;
+};
+
+void printUsage( const std::string &program ) {
+  std::cout << " Usage: " << program << " [--ordered] output.slcio shard.0.slcio shard.1.slcio ..." << std::endl
+    << "   Merge the LCIO shard files written by the LCIOOutputProcessor (ShardedWrite)" << std::endl
+    << "   by concatenating their records, without decoding them." << std::endl
+    << "   The run headers are taken from the first shard only, the events of each" << std::endl
+    << "   shard are placed after the run header they follow in their shard." << std::endl
+    << "   --ordered: restore the input order from the shard.slcio.order files" << std::endl ;
+}
+
+std::vector<Item> readItems( SIORecordReader &reader, std::size_t shard, const std::string &fname ) {
+  std::vector<Item> items ;
+  std::size_t segment {0} ;
+  SIORecord record ;
+  while( reader.next( record ) ) {
+    if( SIORecordReader::isRandomAccess( record ) ) {
+      continue ;
+    }
+    if( "LCEvent" == record._name and not items.empty() and not items.back()._runHeader
+      and 1 == items.back()._records.size() and "LCEventHeader" == items.back()._records.front()._name ) {
+      items.back()._records.push_back( record ) ;
+      continue ;
+    }
+    if( "LCRunHeader" != record._name and "LCEventHeader" != record._name ) {
+      throw Exception( "Unexpected record '" + record._name + "' in file '" + fname + "'" ) ;
+    }
+    Item item ;
+    item._runHeader = ( "LCRunHeader" == record._name ) ;
+    if( item._runHeader ) {
+      ++ segment ;
+    }
+    item._segment = segment ;
+    item._shard = shard ;
+    item._records.push_back( record ) ;
+    items.push_back( item ) ;
+  }
+  return items ;
+}
+
+void readOrder( std::vector<Item> &items, const std::string &fname ) {
+  std::ifstream file( fname ) ;
+  if( not file ) {
+    throw Exception( "Couldn't open order file '" + fname + "'" ) ;
+  }
+  std::string kind ;
+  std::size_t index {0}, count {0} ;
+  while( file >> kind >> index ) {
+    if( count >= items.size() or ( "R" == kind ) != items[count]._runHeader ) {
+      throw Exception( "Order file '" + fname + "' doesn't match its shard" ) ;
+    }
+    items[count++]._index = index ;
+  }
+  if( count != items.size() ) {
+    throw Exception( "Order file '" + fname + "' doesn't match its shard" ) ;
+  }
+}
+
+int main( int argc, char **argv ) {
+  const std::string program = argv[0] ;
+  bool ordered {false} ;
+  std::vector<std::string> files ;
+  for( int i=1 ; i<argc ; ++i ) {
+    const std::string arg = argv[i] ;
+    if( arg == "-h" or arg == "-?" ) {
+      printUsage( program ) ;
+      return 0 ;
+    }
+    if( arg == "--ordered" ) {
+      ordered = true ;
+      continue ;
+    }
+    files.push_back( arg ) ;
+  }
+  if( files.size() < 2 ) {
+    printUsage( program ) ;
+    return 1 ;
+  }
+  try {
+    std::vector<std::unique_ptr<SIORecordReader>> readers ;
+    std::vector<Item> items ;
+    std::size_t nShardRuns {0} ;
+    for( std::size_t s=1 ; s<files.size() ; ++s ) {
+      readers.push_back( std::make_unique<SIORecordReader>( files[s], true ) ) ;
+      auto shardItems = readItems( *readers.back(), readers.size() - 1, files[s] ) ;
+      if( ordered ) {
+        readOrder( shardItems, files[s] + ".order" ) ;
+      }
+      // all shards hold all run headers
+      const std::size_t runs = std::count_if( shardItems.begin(), shardItems.end(), []( const Item &item ) {
+        return item._runHeader ;
+      }) ;
+      if( 1 == s ) {
+        nShardRuns = runs ;
+      }
+      else if( runs != nShardRuns ) {
+        throw Exception( "Shard '" + files[s] + "' doesn't hold the same run headers as '" + files[1] + "'" ) ;
+      }
+      for( auto &item : shardItems ) {
+        if( 1 == s or not item._runHeader ) {
+          items.push_back( std::move( item ) ) ;
+        }
+      }
+    }
+    if( ordered ) {
+      // run headers go before the event of the same index
+      std::stable_sort( items.begin(), items.end(), []( const Item &lhs, const Item &rhs ) {
+        if( lhs._index != rhs._index ) {
+          return lhs._index < rhs._index ;
+        }
+        return lhs._runHeader and not rhs._runHeader ;
+      }) ;
+    }
+    else {
+      // the run headers of the first shard are kept only: put the events of
+      // each shard back in the run they were processed in, shard by shard
+      std::stable_sort( items.begin(), items.end(), []( const Item &lhs, const Item &rhs ) {
+        if( lhs._segment != rhs._segment ) {
+          return lhs._segment < rhs._segment ;
+        }
+        return lhs._runHeader and not rhs._runHeader ;
+      }) ;
+    }
+    std::ofstream output( files[0], std::ios::binary ) ;
+    if( not output ) {
+      throw Exception( "Couldn't open output file '" + files[0] + "'" ) ;
+    }
+    std::size_t nEvents {0}, nRuns {0} ;
+    for( auto &item : items ) {
+      for( auto &record : item._records ) {
+        readers[item._shard]->copy( record, output ) ;
+      }
+      ( item._runHeader ? nRuns : nEvents ) ++ ;
+    }
+    output.close() ;
+    if( not output ) {
+      throw Exception( "Couldn't write output file '" + files[0] + "'" ) ;
+    }
+    std::cout << "Merged " << nEvents << " events and " << nRuns << " run headers from "
+      << readers.size() << " shard(s) in " << files[0] << std::endl ;
+  }
+  catch( marlin::Exception &e ) {
+    std::cerr << "Couldn't merge shards: " << e.what() << std::endl ;
+    return 1 ;
+  }
+  return 0 ;
+}
@@ -1,6 +1,7 @@
 
 // -- marlin headers
 #include <marlin/Processor.h>
+#include <marlin/ProcessorApi.h>
 #include <marlin/PluginManager.h>
 
 // -- lcio headers
@@ -52,6 +53,7 @@ namespace marlin {
   void DumpEventProcessor::init() {
   	// Print the initial parameters
   	printParameters() ;
+    ProcessorApi::requireAllCollections( this ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -67,5 +69,5 @@ namespace marlin {
   }
 
   // plugin declaration
-  MARLIN_DECLARE_PROCESSOR( DumpEventProcessor )
+  MARLIN_DECLARE_PROCESSOR_NAME( DumpEventProcessor, "DumpEvent" )
 }
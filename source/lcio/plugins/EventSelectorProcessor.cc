@@ -16,6 +16,9 @@ namespace marlin {
 
   /** Simple event selector processor. Returns true if the given event
    *  was specified in the EvenList parameter.
+   *  If it is the first active processor and the next processors only run
+   *  if it returns true, the selection is done by the data source instead
+   *  (see ProcessorApi::registerEventFilter()).
    *
    *  <h4>Output</h4>
    *  returns true or false
@@ -59,6 +62,8 @@ namespace marlin {
   void EventSelectorProcessor::init() {
     // usually a good idea to
     printParameters() ;
+    // no collection used
+    ProcessorApi::requireCollections( this, {} ) ;
     unsigned int nEvts = _evtList.size() ;
     if( nEvts % 2 != 0 ) {
       throw Exception( "EventSelectorProcessor: event list size should be even (list of run / event ids)" ) ;
@@ -66,6 +71,12 @@ namespace marlin {
     for( unsigned i=0 ; i <nEvts ; i+=2 ) {
       _evtSet.insert( std::make_pair( _evtList[i] , _evtList[ i+1 ] ) ) ;
     }
+    if( not _evtSet.empty() ) {
+      auto evtSet = _evtSet ;
+      ProcessorApi::registerEventFilter( this, [evtSet]( const EventHeader &header ) {
+        return ( evtSet.end() != evtSet.find( std::make_pair( header._eventNumber, header._runNumber ) ) ) ;
+      }) ;
+    }
   }
 
   //--------------------------------------------------------------------------
@@ -88,5 +99,5 @@ namespace marlin {
   }
 
   // plugin declaration
-  MARLIN_DECLARE_PROCESSOR( EventSelectorProcessor )
+  MARLIN_DECLARE_PROCESSOR_NAME( EventSelectorProcessor, "EventSelector" )
 }
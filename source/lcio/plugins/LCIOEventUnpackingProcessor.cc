@@ -40,6 +40,8 @@ namespace marlin {
 
   void LCIOEventUnpackingProcessor::init() {
     log<DEBUG>() << "LCIOEventUnpackingProcessor::init() called" << std::endl ;
+    // only unpacks the collections read anyway
+    ProcessorApi::requireCollections( this, {} ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -54,5 +56,5 @@ namespace marlin {
   }
 
   // processor declaration
-  MARLIN_DECLARE_PROCESSOR( LCIOEventUnpackingProcessor )
+  MARLIN_DECLARE_PROCESSOR_NAME( LCIOEventUnpackingProcessor, "LCIOEventUnpacking" )
 }
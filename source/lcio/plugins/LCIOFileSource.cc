@@ -2,23 +2,34 @@
 #define MARLIN_LCIOFILESOURCE_h 1
 
 #include <marlin/lcio/ReaderListener.h>
+#include <marlin/lcio/EventIndex.h>
+#include <marlin/lcio/SIORecordReader.h>
+#include <marlin/lcio/MappedFile.h>
 
 // -- marlin headers
 #include <marlin/DataSourcePlugin.h>
+#include <marlin/Application.h>
 #include <marlin/PluginManager.h>
 #include <marlin/Logging.h>
 #include <marlin/EventStore.h>
 #include <marlin/RunHeader.h>
+#include <marlin/concurrency/TaskGroup.h>
 #include <jenkinsHash.h>
 
 // -- lcio headers
 #include <EVENT/LCEvent.h>
 #include <EVENT/LCRunHeader.h>
+#include <EVENT/LCCollection.h>
 #include <MT/LCReader.h>
 #include <MT/LCReaderListener.h>
 
 // -- std headers
 #include <functional>
+#include <algorithm>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <sstream>
 
 using namespace std::placeholders ;
 
@@ -26,11 +37,81 @@ namespace marlin {
 
   /**
    *  @brief  LCIOFileSource class
+   *
+   *  With UseEventIndex, the event index sidecar files of the input files
+   *  are loaded (and built if missing or out of date, see EventIndex) and
+   *  the events are read by random access: SkipNEvents doesn't read the
+   *  skipped events, and EventList / EventRange select the events to read
+   *  without decoding the other ones. The run header preceding each selected
+   *  event is read when its run changes. As the events are read by (run, event)
+   *  number, only the first of duplicated numbers in a file is selected.
+   *
+   *  With AutoReadCollectionNames, only the collections used by the active
+   *  processors are read (see InputCollections), unless LCIOReadCollectionNames
+   *  is given. If a processor uses all the collections (e.g output), the
+   *  collections of the first event of each file are checked against the
+   *  collections it doesn't use.
+   *
+   *  With LazyUnpack and ParallelUnpack, each event is unpacked by an idle
+   *  worker while it waits in the scheduler queue, instead of by the first
+   *  processor accessing a collection.
+   *
+   *  With UseEventIndex and ParallelRead, the events are read ahead by worker
+   *  tasks: each task reads, decompresses and builds one event with its own
+   *  file reader (random access). The reader thread only reads the run headers
+   *  and hands the events over in input order.
+   *
+   *  With MappedInput, the current input file is memory mapped to drive the
+   *  kernel readahead: the records of the next events in flight are prefetched
+   *  (MaxEventsInFlight + ParallelRead events) and the pages of the events
+   *  already read are released. In sequential mode, the read position is
+   *  followed by walking the record headers in the mapped file.
+   *
+   *  For job checkpoints, the read position is the next selected event (file
+   *  and position in the file) with UseEventIndex, else the number of events
+   *  read from the input files. In sequential mode, a resumed job reads the
+   *  committed events again but drops them, with their run headers except the
+   *  one of the first processed event.
    */
   class LCIOFileSource : public DataSourcePlugin {
     using FileReader = MT::LCReader ;
     using FileReaderPtr = std::shared_ptr<FileReader> ;
 
+    /**
+     *  @brief  Selection struct
+     *  An event selected with the event index
+     */
+    struct Selection {
+      ///< The input file index
+      std::size_t         _file {0} ;
+      ///< The event ordinal position in the file
+      std::size_t         _event {0} ;
+    };
+
+    /**
+     *  @brief  PendingRead struct
+     *  An event read ahead by a worker task (ParallelRead only).
+     *  A dropped read is waited for without running unrelated tasks,
+     *  as the TaskGroup destructor would do in the reader thread
+     */
+    struct PendingRead {
+      ~PendingRead() {
+        if( nullptr != _task ) {
+          try {
+            _task->wait( false ) ;
+          }
+          catch( ... ) {
+            // the event is dropped anyway
+          }
+        }
+      }
+
+      ///< The event, once read
+      std::shared_ptr<EVENT::LCEvent>           _event {nullptr} ;
+      ///< The read task
+      std::unique_ptr<concurrency::TaskGroup>   _task {nullptr} ;
+    };
+
   public:
     LCIOFileSource() ;
     ~LCIOFileSource() = default ;
@@ -38,10 +119,29 @@ namespace marlin {
     // from DataSourcePlugin
     void init() ;
     bool readOne() ;
+    bool supportsEventFilter() const { return true ; }
+    bool supportsResume() const { return true ; }
+    std::string position() const ;
+    void resume( const std::string &pos ) ;
 
   private:
     void onLCEventRead( std::shared_ptr<EVENT::LCEvent> event ) ;
     void onLCRunHeaderRead( std::shared_ptr<EVENT::LCRunHeader> rhdr ) ;
+    void onEventRead( std::shared_ptr<EventStore> event ) ;
+    void onRunHeaderRead( std::shared_ptr<RunHeader> rhdr ) ;
+    void initReadCollections() ;
+    void initEventIndex() ;
+    void openIndexedFile( std::size_t file ) ;
+    bool readOneIndexed() ;
+    FileReaderPtr openReader( std::size_t file ) const ;
+    std::shared_ptr<EVENT::LCEvent> readIndexedEvent( const Selection &selection, FileReader &reader ) const ;
+    FileReaderPtr acquireReader( std::size_t file ) ;
+    void releaseReader( std::size_t file, FileReaderPtr reader ) ;
+    void scheduleReads() ;
+    void mapInputFile( std::size_t file ) ;
+    void adviseMapping( std::uint64_t consumed, std::uint64_t ahead ) ;
+    void adviseIndexedMapping() ;
+    void trackMappedRecord( const std::string &name ) ;
 
   private:
     Property<std::vector<std::string>> _inputFileNames {this, "LCIOInputFiles",
@@ -59,12 +159,80 @@ namespace marlin {
     Property<bool> _lazyUnpack {this, "LazyUnpack",
                 "Set to true to perform a lazy unpacking after reading out an event", false } ;
 
+    Property<bool> _parallelUnpack {this, "ParallelUnpack",
+                "With LazyUnpack, unpack the events on idle workers while they wait to be processed", true } ;
+
+    Property<bool> _autoReadCollectionNames {this, "AutoReadCollectionNames",
+                "Only read the collections used by the active processors, if LCIOReadCollectionNames is not set", true } ;
+
+    Property<bool> _useEventIndex {this, "UseEventIndex",
+                "Use the event index files (<file>.idx, built if missing) to access the events randomly", false } ;
+
+    Property<std::vector<int>> _eventList {this, "EventList",
+                "Only read the given events - pairs of EventNumber RunNumber (requires UseEventIndex)" } ;
+
+    Property<std::vector<int>> _eventRange {this, "EventRange",
+                "Only read a range of events: first event (position over all input files) and number of events (requires UseEventIndex)" } ;
+
+    Property<int> _parallelRead {this, "ParallelRead",
+                "The number of events read ahead (decompressed and built) by worker tasks, 0 to read in the reader thread (requires UseEventIndex)", 0 } ;
+
+    Property<bool> _mappedInput {this, "MappedInput",
+                "Memory map the input files to prefetch the events in flight and release the pages of the read events", false } ;
+
     ///< The LCIO file listener
     ReaderListener              _listener {} ;
     ///< The LCIO file reader
     FileReaderPtr               _fileReader {nullptr} ;
     ///< The current number of read records
     int                         _currentReadRecords {0} ;
+    ///< The collections to read (all if empty)
+    std::vector<std::string>    _collectionNames {} ;
+    ///< Whether to unpack the events in preparation tasks
+    bool                        _prepareUnpack {false} ;
+    ///< The input file indices (UseEventIndex only)
+    std::vector<EventIndex>     _indices {} ;
+    ///< The selected events (UseEventIndex only)
+    std::vector<Selection>      _selection {} ;
+    ///< The next selected event to read
+    std::size_t                 _nextSelection {0} ;
+    ///< The currently opened input file (UseEventIndex only)
+    std::size_t                 _currentFile {0} ;
+    ///< The number of run headers read in the current file
+    std::size_t                 _runHeadersRead {0} ;
+    ///< The run header reader of the current file (UseEventIndex only)
+    FileReaderPtr               _runHeaderReader {nullptr} ;
+    ///< The number of events read ahead by worker tasks
+    std::size_t                 _readAhead {0} ;
+    ///< The next selected event to schedule for reading (ParallelRead only)
+    std::size_t                 _nextScheduled {0} ;
+    ///< The synchronization mutex of the reader pool
+    std::mutex                  _readerMutex {} ;
+    ///< The idle file readers of the worker tasks, with their opened file
+    std::vector<std::pair<std::size_t, FileReaderPtr>> _readerPool {} ;
+    ///< The number of events to prefetch in the mapped input file (MappedInput only)
+    std::size_t                 _prefetchEvents {0} ;
+    ///< The mapped input file, walked in sequential mode (MappedInput only)
+    std::unique_ptr<SIORecordReader> _mappedReader {nullptr} ;
+    ///< The index of the mapped input file
+    std::size_t                 _mappedFile {0} ;
+    ///< The number of events read in the mapped input file
+    std::size_t                 _mappedEvents {0} ;
+    ///< The mapped input file offset up to which the pages have been released
+    std::uint64_t               _released {0} ;
+    ///< The mapped input file offset up to which the pages have been prefetched
+    std::uint64_t               _prefetched {0} ;
+    ///< The next selected event to prefetch (MappedInput and UseEventIndex only)
+    std::size_t                 _nextPrefetch {0} ;
+    ///< The number of events read from the input files, skipped ones included (sequential mode)
+    std::size_t                 _fileEvents {0} ;
+    ///< The number of events committed by the previous job (resumed job, sequential mode)
+    std::size_t                 _resumeEvents {0} ;
+    ///< The last run header read while dropping the committed events (resumed job)
+    std::shared_ptr<RunHeader>  _pendingRunHeader {nullptr} ;
+    ///< The events being read ahead, in selection order. Last member: the
+    ///< pending tasks are waited for before the readers are destroyed
+    std::deque<std::unique_ptr<PendingRead>> _pendingReads {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -78,22 +246,62 @@ namespace marlin {
   //--------------------------------------------------------------------------
 
   void LCIOFileSource::init() {
+    _listener.onRunHeaderRead( std::bind( &LCIOFileSource::onRunHeaderRead, this, _1 ) ) ;
+    _listener.onEventRead( std::bind( &LCIOFileSource::onEventRead, this, _1 ) ) ;
+
+    if( _inputFileNames.empty() ) {
+      throw Exception( "LCIOFileSource::init: LCIO input file list is empty" ) ;
+    }
+    initReadCollections() ;
+    // a single thread can't unpack while processing
+    _prepareUnpack = ( _lazyUnpack and _parallelUnpack and app().concurrency() > 1 ) ;
+    if( _useEventIndex ) {
+      // a single thread can't read ahead either
+      if( _parallelRead > 0 and app().concurrency() > 1 ) {
+        _readAhead = static_cast<std::size_t>( _parallelRead.get() ) ;
+      }
+    }
+    if( _mappedInput ) {
+      // the events in flight in the scheduler, see PEPScheduler
+      const std::size_t concurrency = app().concurrency() ;
+      _prefetchEvents = app().globalParameters()->getValue<std::size_t>( "MaxEventsInFlight", 4 * concurrency ) + _readAhead ;
+      logger()->log<MESSAGE>() << "Mapped input: prefetching " << _prefetchEvents << " event(s)" << std::endl ;
+    }
+    if( _useEventIndex ) {
+      initEventIndex() ;
+      return ;
+    }
+    if( _parallelRead > 0 ) {
+      logger()->log<WARNING>() << "ParallelRead requires UseEventIndex, reading events in the reader thread" << std::endl ;
+    }
+    if( not _eventList.empty() or not _eventRange.empty() ) {
+      throw Exception( "LCIOFileSource::init: EventList and EventRange require UseEventIndex" ) ;
+    }
     auto flag = FileReader::directAccess ;
     if( _lazyUnpack ) {
       flag |= FileReader::lazyUnpack ;
     }
     _fileReader = std::make_shared<FileReader>( flag ) ;
-    _listener.onRunHeaderRead( std::bind( &LCIOFileSource::processRunHeader, this, _1 ) ) ;
-    _listener.onEventRead( std::bind( &LCIOFileSource::processEvent, this, _1 ) ) ;
-
-    if( _inputFileNames.empty() ) {
-      throw Exception( "LCIOFileSource::init: LCIO input file list is empty" ) ;
-    }
     _fileReader->open( _inputFileNames ) ;
+    if( _mappedInput ) {
+      mapInputFile( 0 ) ;
+    }
     if ( _skipNEvents > 0 ) {
       logger()->log<WARNING>() << " --- Will skip first " << _skipNEvents << " event(s)" << std::endl ;
       _fileReader->skipNEvents( _skipNEvents ) ;
+      _fileEvents = _skipNEvents ;
+      for( int i=0 ; _mappedInput and i<_skipNEvents ; ++i ) {
+        trackMappedRecord( "LCEvent" ) ;
+      }
+    }
+    if ( not _collectionNames.empty() ) {
+      _fileReader->setReadCollectionNames( _collectionNames ) ;
     }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOFileSource::initReadCollections() {
     if ( not _readCollectionNames.empty() ) {
       logger()->log<WARNING>()
         << " *********** Parameter LCIOReadCollectionNames given - will only read the following collections: **** "
@@ -103,13 +311,467 @@ namespace marlin {
       }
       logger()->log<WARNING>()
         << " *************************************************************************************************** " << std::endl ;
-      _fileReader->setReadCollectionNames( _readCollectionNames ) ;
+      _collectionNames = _readCollectionNames ;
+      return ;
+    }
+    auto &inputs = inputCollections() ;
+    // nothing declared by the processors: nothing known, read everything
+    if( not _autoReadCollectionNames or inputs.empty() ) {
+      return ;
+    }
+    // a processor not declaring its inputs may use any collection
+    const auto undeclared = inputs.undeclaredProcessors() ;
+    if( not undeclared.empty() ) {
+      logger()->log<MESSAGE>() << "Reading all the collections (see AutoReadCollectionNames), the following processor(s) don't declare their input collections:" << std::endl ;
+      for( auto &processor : undeclared ) {
+        logger()->log<MESSAGE>() << "     " << processor << std::endl ;
+      }
+      return ;
+    }
+    std::set<std::string> names( inputs.names() ) ;
+    if( inputs.allCollections() ) {
+      for( auto &fname : _inputFileNames.get() ) {
+        FileReader reader( FileReader::directAccess ) ;
+        reader.open( fname ) ;
+        std::unique_ptr<EVENT::LCEvent> event {nullptr} ;
+        try {
+          event = reader.readNextEvent() ;
+        }
+        catch( IO::EndOfDataException &e ) {}
+        reader.close() ;
+        if( nullptr == event ) {
+          continue ;
+        }
+        for( auto &name : *event->getCollectionNames() ) {
+          if( inputs.isUsed( name, event->getCollection( name )->getTypeName() ) ) {
+            names.insert( name ) ;
+          }
+        }
+      }
+    }
+    if( names.empty() ) {
+      return ;
+    }
+    _collectionNames.assign( names.begin(), names.end() ) ;
+    logger()->log<MESSAGE>() << "Reading only the " << _collectionNames.size()
+      << " collection(s) used by the active processors (see AutoReadCollectionNames):" << std::endl ;
+    for( auto &name : _collectionNames ) {
+      logger()->log<MESSAGE>() << "     " << name << std::endl ;
     }
   }
 
   //--------------------------------------------------------------------------
 
+  void LCIOFileSource::initEventIndex() {
+    for( auto &fname : _inputFileNames.get() ) {
+      if( EventIndex::upToDate( fname ) ) {
+        _indices.push_back( EventIndex::load( fname ) ) ;
+      }
+      else {
+        logger()->log<MESSAGE>() << "Building event index of file " << fname << std::endl ;
+        _indices.push_back( EventIndex::build( fname ) ) ;
+        try {
+          _indices.back().save() ;
+        }
+        catch( Exception &e ) {
+          logger()->log<WARNING>() << "Couldn't save event index: " << e.what() << std::endl ;
+        }
+      }
+      if( _indices.back().duplicates() > 0 ) {
+        logger()->log<WARNING>() << "File " << fname << " contains " << _indices.back().duplicates()
+          << " duplicated (run, event) number(s), only the first ones can be read by random access: the others are skipped" << std::endl ;
+      }
+    }
+    if( not _eventList.empty() ) {
+      if( _eventList.size() % 2 != 0 ) {
+        throw Exception( "LCIOFileSource::init: EventList size should be even (list of event / run numbers)" ) ;
+      }
+      for( std::size_t i=0 ; i<_eventList.size() ; i+=2 ) {
+        bool found = false ;
+        for( std::size_t f=0 ; f<_indices.size() and not found ; ++f ) {
+          const auto position = _indices[f].find( _eventList[i+1], _eventList[i] ) ;
+          if( position >= 0 ) {
+            _selection.push_back( { f, static_cast<std::size_t>( position ) } ) ;
+            found = true ;
+          }
+        }
+        if( not found ) {
+          logger()->log<WARNING>() << "Event " << _eventList[i] << " of run " << _eventList[i+1]
+            << " not found in input files" << std::endl ;
+        }
+      }
+      // read in file order
+      std::sort( _selection.begin(), _selection.end(), []( const Selection &lhs, const Selection &rhs ) {
+        return ( lhs._file != rhs._file ) ? lhs._file < rhs._file : lhs._event < rhs._event ;
+      }) ;
+      _selection.erase( std::unique( _selection.begin(), _selection.end(), []( const Selection &lhs, const Selection &rhs ) {
+        return lhs._file == rhs._file and lhs._event == rhs._event ;
+      }), _selection.end() ) ;
+    }
+    else {
+      for( std::size_t f=0 ; f<_indices.size() ; ++f ) {
+        auto &events = _indices[f].events() ;
+        for( std::size_t e=0 ; e<events.size() ; ++e ) {
+          // the events are read by (run, event) number: a duplicate would be read as the first one
+          if( _indices[f].find( events[e]._run, events[e]._event ) == static_cast<long>( e ) ) {
+            _selection.push_back( { f, e } ) ;
+          }
+        }
+      }
+    }
+    if( not _eventRange.empty() ) {
+      if( _eventRange.size() != 2 or _eventRange[0] < 0 or _eventRange[1] < 0 ) {
+        throw Exception( "LCIOFileSource::init: EventRange should be: first event, number of events" ) ;
+      }
+      const std::size_t first = std::min( static_cast<std::size_t>( _eventRange[0] ), _selection.size() ) ;
+      const std::size_t last = std::min( first + static_cast<std::size_t>( _eventRange[1] ), _selection.size() ) ;
+      _selection = std::vector<Selection>( _selection.begin() + first, _selection.begin() + last ) ;
+    }
+    if( _skipNEvents > 0 ) {
+      logger()->log<WARNING>() << " --- Will skip first " << _skipNEvents << " event(s)" << std::endl ;
+      _selection.erase( _selection.begin(), _selection.begin() + std::min( static_cast<std::size_t>( _skipNEvents.get() ), _selection.size() ) ) ;
+    }
+    if( hasEventFilter() ) {
+      // pushed down event selection: the rejected events are never read
+      _selection.erase( std::remove_if( _selection.begin(), _selection.end(), [this]( const Selection &selection ) {
+        auto &entry = _indices[selection._file].events()[selection._event] ;
+        return not acceptEvent( { entry._run, entry._event } ) ;
+      }), _selection.end() ) ;
+    }
+    logger()->log<MESSAGE>() << "Event index: " << _selection.size() << " event(s) selected" << std::endl ;
+    if( not _selection.empty() ) {
+      openIndexedFile( _selection.front()._file ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOFileSource::openIndexedFile( std::size_t file ) {
+    auto &fname = _indices[file].fileName() ;
+    // with ParallelRead, the events are read by the worker tasks readers
+    if( 0 == _readAhead ) {
+      _fileReader = openReader( file ) ;
+    }
+    _runHeaderReader = std::make_shared<FileReader>( FileReader::directAccess ) ;
+    _runHeaderReader->open( fname ) ;
+    _currentFile = file ;
+    _runHeadersRead = 0 ;
+    if( _mappedInput ) {
+      mapInputFile( file ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool LCIOFileSource::readOneIndexed() {
+    if( _nextSelection >= _selection.size() ) {
+      return false ;
+    }
+    auto &selection = _selection[_nextSelection] ;
+    if( selection._file != _currentFile ) {
+      openIndexedFile( selection._file ) ;
+    }
+    auto &index = _indices[_currentFile] ;
+    auto &entry = index.events()[selection._event] ;
+    MT::LCReaderListener &listener = _listener ;
+    if( _runHeadersRead < entry._runHeaders ) {
+      // skip the run headers of the unselected runs, process the one of this event
+      std::unique_ptr<EVENT::LCRunHeader> rhdr {nullptr} ;
+      while( _runHeadersRead < entry._runHeaders ) {
+        rhdr = _runHeaderReader->readNextRunHeader() ;
+        if( nullptr == rhdr ) {
+          throw Exception( "LCIOFileSource::readOne: missing run header in file '" + index.fileName() + "', event index out of date ?" ) ;
+        }
+        ++_runHeadersRead ;
+      }
+      listener.processRunHeader( std::shared_ptr<EVENT::LCRunHeader>( std::move( rhdr ) ) ) ;
+      return true ;
+    }
+    if( _mappedInput ) {
+      adviseIndexedMapping() ;
+    }
+    std::shared_ptr<EVENT::LCEvent> event {nullptr} ;
+    if( _readAhead > 0 ) {
+      // the front pending read is the one of this event
+      scheduleReads() ;
+      auto pending = std::move( _pendingReads.front() ) ;
+      _pendingReads.pop_front() ;
+      scheduleReads() ;
+      // only run this read if no worker took it yet: the reader thread
+      // must not be held by unrelated (e.g processor) tasks
+      pending->_task->wait( false ) ;
+      event = pending->_event ;
+    }
+    else {
+      event = readIndexedEvent( selection, *_fileReader ) ;
+    }
+    ++_nextSelection ;
+    listener.processEvent( event ) ;
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  LCIOFileSource::FileReaderPtr LCIOFileSource::openReader( std::size_t file ) const {
+    auto flag = FileReader::directAccess ;
+    if( _lazyUnpack ) {
+      flag |= FileReader::lazyUnpack ;
+    }
+    auto reader = std::make_shared<FileReader>( flag ) ;
+    reader->open( _indices[file].fileName() ) ;
+    if ( not _collectionNames.empty() ) {
+      reader->setReadCollectionNames( _collectionNames ) ;
+    }
+    return reader ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::shared_ptr<EVENT::LCEvent> LCIOFileSource::readIndexedEvent( const Selection &selection, FileReader &reader ) const {
+    auto &index = _indices[selection._file] ;
+    auto &entry = index.events()[selection._event] ;
+    auto event = reader.readEvent( entry._run, entry._event ) ;
+    if( nullptr == event ) {
+      throw Exception( "LCIOFileSource::readOne: couldn't read event " + std::to_string( entry._event )
+        + " of run " + std::to_string( entry._run ) + " in file '" + index.fileName() + "'" ) ;
+    }
+    return std::shared_ptr<EVENT::LCEvent>( std::move( event ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  LCIOFileSource::FileReaderPtr LCIOFileSource::acquireReader( std::size_t file ) {
+    {
+      std::lock_guard<std::mutex> lock( _readerMutex ) ;
+      auto iter = std::find_if( _readerPool.begin(), _readerPool.end(), [file]( const std::pair<std::size_t, FileReaderPtr> &slot ) {
+        return slot.first == file ;
+      }) ;
+      if( _readerPool.end() != iter ) {
+        auto reader = iter->second ;
+        _readerPool.erase( iter ) ;
+        return reader ;
+      }
+      // the events are read in file order: the readers of the previous files are not needed any more
+      _readerPool.erase( std::remove_if( _readerPool.begin(), _readerPool.end(), [file]( const std::pair<std::size_t, FileReaderPtr> &slot ) {
+        return slot.first < file ;
+      }), _readerPool.end() ) ;
+    }
+    return openReader( file ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOFileSource::releaseReader( std::size_t file, FileReaderPtr reader ) {
+    std::lock_guard<std::mutex> lock( _readerMutex ) ;
+    _readerPool.push_back( { file, reader } ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOFileSource::scheduleReads() {
+    while( _pendingReads.size() < _readAhead and _nextScheduled < _selection.size() ) {
+      const auto selection = _selection[_nextScheduled++] ;
+      auto pending = std::make_unique<PendingRead>() ;
+      pending->_task = std::make_unique<concurrency::TaskGroup>( app().taskQueue() ) ;
+      auto target = pending.get() ;
+      // a reader failing to read is dropped, not released
+      pending->_task->run( [this, target, selection]() {
+        auto reader = acquireReader( selection._file ) ;
+        target->_event = readIndexedEvent( selection, *reader ) ;
+        releaseReader( selection._file, reader ) ;
+      }) ;
+      _pendingReads.push_back( std::move( pending ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOFileSource::mapInputFile( std::size_t file ) {
+    if( nullptr != _mappedReader ) {
+      // the previous file is fully read
+      adviseMapping( _mappedReader->mappedFile()->size(), 0 ) ;
+    }
+    _mappedReader = std::make_unique<SIORecordReader>( _inputFileNames.get()[file], true ) ;
+    _mappedFile = file ;
+    _mappedEvents = 0 ;
+    _released = 0 ;
+    _prefetched = 0 ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOFileSource::adviseMapping( std::uint64_t consumed, std::uint64_t ahead ) {
+    auto mapping = _mappedReader->mappedFile() ;
+    if( consumed > _released ) {
+      mapping->release( _released, consumed - _released ) ;
+      _released = consumed ;
+    }
+    if( ahead > _prefetched ) {
+      const auto first = std::max( _prefetched, consumed ) ;
+      mapping->prefetch( first, ahead - first ) ;
+      _prefetched = ahead ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOFileSource::adviseIndexedMapping() {
+    auto &index = _indices[_currentFile] ;
+    auto &events = index.events() ;
+    const auto fileSize = _mappedReader->mappedFile()->size() ;
+    // the records of an event extend to the next event (or the end of the file)
+    auto eventEnd = [&]( std::size_t event ) {
+      return ( event + 1 < events.size() ) ? events[event+1]._offset : fileSize ;
+    } ;
+    adviseMapping( events[_selection[_nextSelection]._event]._offset, 0 ) ;
+    // only the selected events of the current file, skipping the others
+    _nextPrefetch = std::max( _nextPrefetch, _nextSelection ) ;
+    const std::size_t last = std::min( _nextSelection + _prefetchEvents, _selection.size() ) ;
+    for( ; _nextPrefetch < last and _selection[_nextPrefetch]._file == _currentFile ; ++_nextPrefetch ) {
+      const auto event = _selection[_nextPrefetch]._event ;
+      _mappedReader->mappedFile()->prefetch( events[event]._offset, eventEnd( event ) - events[event]._offset ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOFileSource::trackMappedRecord( const std::string &name ) {
+    SIORecord record ;
+    while( true ) {
+      if( _mappedReader->next( record ) ) {
+        if( name == record._name ) {
+          break ;
+        }
+        continue ;
+      }
+      // LCIO went on with the next file. Out of files: the advices are only hints, ignore
+      if( _mappedFile + 1 >= _inputFileNames.size() ) {
+        return ;
+      }
+      mapInputFile( _mappedFile + 1 ) ;
+    }
+    const std::uint64_t consumed = record._offset + record._size ;
+    if( "LCEvent" == name ) {
+      ++_mappedEvents ;
+    }
+    // prefetch the next events in flight, from the mean event size in this file
+    const std::uint64_t eventSize = consumed / std::max( _mappedEvents, std::size_t(1) ) ;
+    adviseMapping( consumed, consumed + _prefetchEvents * eventSize ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOFileSource::onRunHeaderRead( std::shared_ptr<RunHeader> rhdr ) {
+    if( _mappedInput and not _useEventIndex ) {
+      trackMappedRecord( "LCRunHeader" ) ;
+    }
+    if( _fileEvents < _resumeEvents ) {
+      // resumed job: only the run header of the first processed event is needed
+      _pendingRunHeader = rhdr ;
+      return ;
+    }
+    processRunHeader( rhdr ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOFileSource::onEventRead( std::shared_ptr<EventStore> event ) {
+    if( _mappedInput and not _useEventIndex ) {
+      trackMappedRecord( "LCEvent" ) ;
+    }
+    if( not _useEventIndex ) {
+      ++_fileEvents ;
+      // resumed job: drop the events committed by the previous job
+      if( _fileEvents <= _resumeEvents ) {
+        return ;
+      }
+      if( nullptr != _pendingRunHeader ) {
+        processRunHeader( std::move( _pendingRunHeader ) ) ;
+        _pendingRunHeader = nullptr ;
+      }
+    }
+    // pushed down event selection (sequential read): the rejected events are read but not processed
+    if( hasEventFilter() ) {
+      auto lcevent = event->event<EVENT::LCEvent>() ;
+      if( not acceptEvent( { lcevent->getRunNumber(), lcevent->getEventNumber() } ) ) {
+        return ;
+      }
+    }
+    if( _prepareUnpack ) {
+      // the task holds the LCIO event only: the event store owns the task.
+      // LCIO unpacks all the (read) collections on the first access
+      auto lcevent = event->event<EVENT::LCEvent>() ;
+      event->prepare( app().taskQueue(), [lcevent]() {
+        auto colnames = lcevent->getCollectionNames() ;
+        if( not colnames->empty() ) {
+          lcevent->getCollection( colnames->front() ) ;
+        }
+      }) ;
+    }
+    processEvent( event ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::string LCIOFileSource::position() const {
+    if( not _useEventIndex ) {
+      return "events " + std::to_string( _fileEvents ) ;
+    }
+    // the next selected event, independent of the selection parameters
+    if( _nextSelection >= _selection.size() ) {
+      return "index " + std::to_string( _indices.size() ) + " 0" ;
+    }
+    auto &next = _selection[_nextSelection] ;
+    return "index " + std::to_string( next._file ) + " " + std::to_string( next._event ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOFileSource::resume( const std::string &pos ) {
+    std::istringstream stream( pos ) ;
+    std::string mode ;
+    stream >> mode ;
+    if( _useEventIndex and "index" == mode ) {
+      Selection next {} ;
+      if( not ( stream >> next._file >> next._event ) ) {
+        throw Exception( "LCIOFileSource::resume: invalid position '" + pos + "'" ) ;
+      }
+      auto iter = std::lower_bound( _selection.begin(), _selection.end(), next, []( const Selection &lhs, const Selection &rhs ) {
+        return ( lhs._file != rhs._file ) ? lhs._file < rhs._file : lhs._event < rhs._event ;
+      }) ;
+      _nextSelection = _nextScheduled = _nextPrefetch = ( iter - _selection.begin() ) ;
+      if( _selection.end() != iter ) {
+        // the run header of the next event is read again
+        openIndexedFile( iter->_file ) ;
+      }
+      logger()->log<MESSAGE>() << "Resuming at event " << _nextSelection << " of " << _selection.size() << " selected event(s)" << std::endl ;
+      return ;
+    }
+    if( not _useEventIndex and "events" == mode ) {
+      if( not ( stream >> _resumeEvents ) ) {
+        throw Exception( "LCIOFileSource::resume: invalid position '" + pos + "'" ) ;
+      }
+      logger()->log<MESSAGE>() << "Resuming after " << _resumeEvents << " event(s), the previous events are read and dropped" << std::endl ;
+      return ;
+    }
+    throw Exception( "LCIOFileSource::resume: position '" + pos + "' doesn't match the read mode (UseEventIndex changed ?)" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
   bool LCIOFileSource::readOne() {
+    if( _useEventIndex ) {
+      if( not readOneIndexed() ) {
+        return false ;
+      }
+      ++_currentReadRecords ;
+      if( (_maxRecordNumber > 0) and (_currentReadRecords >= _maxRecordNumber) ) {
+        // wait for the events read ahead for nothing, without helping (see PendingRead)
+        _pendingReads.clear() ;
+        return false ;
+      }
+      return true ;
+    }
     try {
       _fileReader->readNextRecord( &_listener ) ;
       ++_currentReadRecords ;
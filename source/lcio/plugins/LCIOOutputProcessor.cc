@@ -3,6 +3,9 @@
 #include <marlin/Processor.h>
 #include <marlin/ProcessorApi.h>
 #include <marlin/PluginManager.h>
+#include <marlin/Application.h>
+#include <marlin/WorkerLocal.h>
+#include <marlin/concurrency/CommitQueue.h>
 
 // -- lcio headers
 #include <lcio.h>
@@ -16,6 +19,13 @@
 #include <iostream>
 #include <algorithm>
 #include <bitset>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <iomanip>
+#include <future>
+#include <unistd.h>
+#include <sys/stat.h>
 
 namespace marlin {
 
@@ -45,6 +55,33 @@ namespace marlin {
    * @param LCIOWriteMode         write mode for output file:  WRITE_APPEND or WRITE_NEW
    * @param KeepCollectionNames   names of collections that are to be kept unconditionally
    * @param fullSubsetCollections optionally write all objects in subset collections to the file
+   * @param AsynchronousWrite     write the events in a dedicated thread instead of the worker threads
+   * @param OrderedWrite          write the events in input order (asynchronous write only)
+   * @param WriteQueueSize        maximum number of events waiting to be written (asynchronous write only)
+   * @param ShardedWrite          each worker writes its own file, to merge with MarlinMergeShards
+   * @param SplitFileSizekB       start a new output file when the current one exceeds this size
+   * @param SplitEventCount       start a new output file after this number of events
+   * @param ManifestFile          the JSON manifest listing the output files (split mode only)
+   *
+   * In asynchronous mode, the workers only select the collections to write and hand the event
+   * to a writer thread through a bounded queue (see concurrency::CommitQueue). In ordered mode, a
+   * reorder buffer commits the events and run headers in input order, making the output file
+   * independent of the thread scheduling.
+   *
+   * In sharded mode, there is no shared writer at all: each worker writes the events it processes
+   * in its own file <name>.<worker>.slcio and the run headers are written in all files. Next to each
+   * shard, a <name>.<worker>.slcio.order file lists the input index of its records, so that the
+   * merge tool can restore the input order without decoding the records.
+   *
+   * In split mode, the output is written in chunks <name>.000.slcio, <name>.001.slcio, ... A new
+   * chunk is started when the size or the event count threshold is reached, and the current run
+   * header is written again at its beginning. The manifest lists the chunks with their event
+   * ranges, so that downstream jobs can be run per chunk.
+   *
+   * With job checkpoints (global parameter CheckpointFile), the output file size is saved at each
+   * checkpoint: a marker in the ordered write queue closes the file once all the events committed
+   * by the checkpoint are written, and before the next ones. A resumed job truncates the file to
+   * this size and appends to it. This requires ordered asynchronous writes in a single file.
    *
    *
    * @author F. Gaede, DESY
@@ -55,6 +92,56 @@ namespace marlin {
     typedef std::vector< IMPL::LCCollectionVec* > SubSetVec ;
     typedef std::shared_ptr<MT::LCWriter> Writer ;
 
+    /**
+     *  @brief  WriteItem struct
+     *  An event or a run header to write
+     */
+    struct WriteItem {
+      ///< The event to write
+      std::shared_ptr<EVENT::LCEvent>                _event {nullptr} ;
+      ///< The event collections to write
+      std::set<std::string>                          _collections {} ;
+      ///< The run header to write
+      std::shared_ptr<IMPL::LCRunHeaderImpl>         _runHeader {nullptr} ;
+      ///< The event input index
+      std::size_t                                    _inputIndex {0} ;
+      ///< The checkpoint state to set (checkpoint marker only)
+      std::shared_ptr<std::promise<std::string>>     _checkpoint {nullptr} ;
+    };
+    typedef concurrency::CommitQueue<WriteItem> WriteQueue ;
+
+    /**
+     *  @brief  Shard struct
+     *  The output file of a worker in sharded mode
+     */
+    struct Shard {
+      ///< The shard writer
+      Writer                                         _writer {nullptr} ;
+      ///< The input indices of the written records
+      std::ofstream                                  _order {} ;
+      ///< Serializes the worker and the run header writes
+      std::mutex                                     _mutex {} ;
+    };
+
+    /**
+     *  @brief  Chunk struct
+     *  An output file in split mode
+     */
+    struct Chunk {
+      ///< The file name
+      std::string                                    _name {} ;
+      ///< The number of events
+      std::size_t                                    _events {0} ;
+      ///< The run and event numbers of the first event
+      std::pair<int, int>                            _first {0, 0} ;
+      ///< The run and event numbers of the last event
+      std::pair<int, int>                            _last {0, 0} ;
+      ///< The input index of the first event
+      std::size_t                                    _firstIndex {0} ;
+      ///< The input index of the last event
+      std::size_t                                    _lastIndex {0} ;
+    };
+
   public:
     LCIOOutputProcessor() ;
     LCIOOutputProcessor(const LCIOOutputProcessor&) = delete ;
@@ -80,6 +167,38 @@ namespace marlin {
   private:
     std::set<std::string> getWriteCollections( EVENT::LCEvent * evt ) const ;
 
+    /** Write an event or a run header (writer thread in asynchronous mode).
+     */
+    void write( WriteItem &item ) ;
+
+    /** Open a new writer on the given file using the configured write mode, or in append mode.
+     */
+    Writer openWriter( const std::string &fname, bool append = false ) const ;
+
+    /** Get the output file size after the events of lower input index (checkpoint).
+     */
+    std::string checkpoint( std::size_t watermark ) ;
+
+    /** Truncate the output file to its size at the checkpoint (resumed job).
+     */
+    void restore( const std::string &state ) ;
+
+    /** Close the current chunk and open the next one (split mode).
+     */
+    void nextChunk() ;
+
+    /** Write the JSON manifest of the chunks (split mode).
+     */
+    void writeManifest() const ;
+
+    /** The output file name without the .slcio extension.
+     */
+    std::string baseName() const ;
+
+    /** The output file name, with the .slcio extension.
+     */
+    std::string outputFileName() const ;
+
   private:
     Property<std::string> _lcioOutputFile {this, "LCIOOutputFile",
              "Name of the LCIO output file", "outputfile.slcio" } ;
@@ -96,13 +215,38 @@ namespace marlin {
     OptionalProperty<std::vector<std::string>> _keepCollectionNames {this, "KeepCollectionNames" ,
              "force keep of the named collections - overrules DropCollectionTypes (and DropCollectionNames)", {"MyPreciousSimTrackerHits"} } ;
 
-    // OptionalProperty<int> _splitFileSizekB {this, "SplitFileSizekB" ,
-    //          "will split output file if size in kB exceeds given value - doesn't work with APPEND and NEW", 1992294 } ;
+    Property<bool> _asyncWrite {this, "AsynchronousWrite" ,
+             "Write the events in a dedicated thread, off the worker threads", true } ;
+
+    Property<bool> _orderedWrite {this, "OrderedWrite" ,
+             "Write the events in input order (asynchronous write only)", false } ;
+
+    Property<int> _writeQueueSize {this, "WriteQueueSize" ,
+             "The maximum number of events waiting to be written (asynchronous write only)", 32 } ;
+
+    Property<bool> _shardedWrite {this, "ShardedWrite" ,
+             "Each worker writes its own file <name>.<worker>.slcio, to merge with MarlinMergeShards", false } ;
+
+    Property<int> _splitFileSizekB {this, "SplitFileSizekB" ,
+             "Start a new output file when its size in kB exceeds the given value (0: no split)", 0 } ;
+
+    Property<int> _splitEventCount {this, "SplitEventCount" ,
+             "Start a new output file after the given number of events (0: no split)", 0 } ;
+
+    Property<std::string> _manifestFile {this, "ManifestFile" ,
+             "The JSON manifest listing the output files in split mode (default: <name>.manifest.json)", "" } ;
 
     // runtime members
     Writer                _writer {nullptr} ;
+    std::unique_ptr<WriteQueue> _writeQueue {nullptr} ;
+    std::vector<std::unique_ptr<Shard>> _shards {} ;
+    bool                  _split {false} ;
+    std::vector<Chunk>    _chunks {} ;
+    std::shared_ptr<IMPL::LCRunHeaderImpl> _currentRunHeader {nullptr} ;
+    std::mutex            _writeMutex {} ;
     std::atomic<int>      _nRuns {0} ;
     std::atomic<int>      _nEvents {0} ;
+    bool                  _resumed {false} ;
   };
 
   //--------------------------------------------------------------------------
@@ -121,15 +265,73 @@ namespace marlin {
 
   void LCIOOutputProcessor::init() {
     printParameters() ;
-    _writer = std::make_shared<Writer::element_type>() ;
-    if ( _lcioWriteMode == "WRITE_APPEND" ) {
-      _writer->open( _lcioOutputFile , EVENT::LCIO::WRITE_APPEND ) ;
+    // all the input collections are written, except the dropped ones
+    std::set<std::string> exceptNames, exceptTypes ;
+    if( _dropCollectionNames.isSet() ) {
+      exceptNames.insert( _dropCollectionNames.get().begin(), _dropCollectionNames.get().end() ) ;
     }
-    else if ( _lcioWriteMode == "WRITE_NEW" ) {
-      _writer->open( _lcioOutputFile , EVENT::LCIO::WRITE_NEW ) ;
+    if( _dropCollectionTypes.isSet() ) {
+      exceptTypes.insert( _dropCollectionTypes.get().begin(), _dropCollectionTypes.get().end() ) ;
+    }
+    if( _keepCollectionNames.isSet() ) {
+      for( auto &name : _keepCollectionNames.get() ) {
+        exceptNames.erase( name ) ;
+      }
+      ProcessorApi::requireCollections( this, _keepCollectionNames.get() ) ;
+    }
+    ProcessorApi::requireAllCollections( this, exceptNames, exceptTypes ) ;
+    _split = ( _splitFileSizekB > 0 or _splitEventCount > 0 ) ;
+    if( app().checkpointing() ) {
+      // the file holds exactly the committed events only if written in input order
+      if( _shardedWrite or _split or not _asyncWrite or not _orderedWrite ) {
+        throw Exception( "LCIOOutputProcessor::init: checkpoints require AsynchronousWrite and OrderedWrite, without ShardedWrite nor split files" ) ;
+      }
+      ProcessorApi::registerCheckpoint( this,
+        [this]( std::size_t watermark ) { return checkpoint( watermark ) ; },
+        [this]( const std::string &state ) { restore( state ) ; } ) ;
+    }
+    if( _shardedWrite ) {
+      if( _split ) {
+        log<WARNING>() << "SplitFileSizekB and SplitEventCount are ignored in sharded mode" << std::endl ;
+        _split = false ;
+      }
+      const std::string base = baseName() ;
+      const std::string extension = ".slcio" ;
+      for( std::size_t i=0 ; i<app().concurrency() ; ++i ) {
+        const std::string fname = base + "." + std::to_string( i ) + extension ;
+        auto shard = std::make_unique<Shard>() ;
+        shard->_writer = openWriter( fname ) ;
+        shard->_order.open( fname + ".order" ) ;
+        if( not shard->_order ) {
+          throw Exception( "LCIOOutputProcessor::init: couldn't open file '" + fname + ".order'" ) ;
+        }
+        _shards.push_back( std::move( shard ) ) ;
+      }
+      log<MESSAGE>() << "Writing " << _shards.size() << " shard(s) " << base << ".<worker>" << extension << std::endl ;
+      return ;
+    }
+    if( _split ) {
+      nextChunk() ;
+    }
+    else if( _resumed ) {
+      _writer = openWriter( outputFileName(), true ) ;
     }
     else {
-      _writer->open( _lcioOutputFile ) ;
+      _writer = openWriter( _lcioOutputFile ) ;
+    }
+    if( _asyncWrite ) {
+      WriteQueue::Settings settings {} ;
+      settings._capacity = std::max( _writeQueueSize.get(), 1 ) ;
+      settings._ordered = _orderedWrite ;
+      auto &application = app() ;
+      _writeQueue = std::make_unique<WriteQueue>(
+        [this]( WriteItem &item ) { write( item ) ; },
+        settings,
+        [&application]() { return application.processedWatermark() ; }
+      ) ;
+    }
+    else if( _orderedWrite ) {
+      log<WARNING>() << "OrderedWrite requires AsynchronousWrite, events written in processing order" << std::endl ;
     }
   }
 
@@ -169,8 +371,25 @@ namespace marlin {
       }
     }
 
-    _writer->writeRunHeader( rhdr.release() ) ;
-    _nRuns++ ;
+    if( not _shards.empty() ) {
+      // every shard must be a valid LCIO file on its own
+      for( auto &shard : _shards ) {
+        std::lock_guard<std::mutex> lock( shard->_mutex ) ;
+        shard->_writer->writeRunHeader( rhdr.get() ) ;
+        shard->_order << "R " << app().eventsRead() << "\n" ;
+      }
+      _nRuns++ ;
+      return ;
+    }
+    WriteItem item {} ;
+    item._runHeader = std::move( rhdr ) ;
+    if( nullptr != _writeQueue ) {
+      // written before the next event read
+      _writeQueue->push( app().eventsRead(), std::move( item ), false ) ;
+    }
+    else {
+      write( item ) ;
+    }
   }
 
   //--------------------------------------------------------------------------
@@ -206,23 +425,232 @@ namespace marlin {
     if( nullptr == lcevent ) {
       ProcessorApi::abort( this, "Event is not an LCEvent" ) ;
     }
-    auto writeCols = getWriteCollections( lcevent.get() ) ;
-    _writer->writeEvent( lcevent.get(), writeCols ) ;
-    _nEvents ++ ;
+    WriteItem item {} ;
+    item._collections = getWriteCollections( lcevent.get() ) ;
+    item._event = lcevent ;
+    item._inputIndex = evt->inputIndex() ;
+    if( not _shards.empty() ) {
+      auto &shard = *_shards.at( WorkerLocalBase::currentWorkerIndex() ) ;
+      std::lock_guard<std::mutex> lock( shard._mutex ) ;
+      shard._writer->writeEvent( lcevent.get(), item._collections ) ;
+      shard._order << "E " << evt->inputIndex() << "\n" ;
+      _nEvents ++ ;
+      return ;
+    }
+    if( nullptr != _writeQueue ) {
+      _writeQueue->push( evt->inputIndex(), std::move( item ) ) ;
+    }
+    else {
+      write( item ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOOutputProcessor::write( WriteItem &item ) {
+    if( nullptr != item._checkpoint ) {
+      // all the events before the checkpoint are written, none of the next ones:
+      // close the file to complete it and get its size, then continue it
+      try {
+        _writer->close() ;
+        const std::string fname = outputFileName() ;
+        struct stat fileStat ;
+        if( 0 != ::stat( fname.c_str(), &fileStat ) ) {
+          throw Exception( "LCIOOutputProcessor::write: couldn't stat file '" + fname + "'" ) ;
+        }
+        _writer = openWriter( fname, true ) ;
+        item._checkpoint->set_value( std::to_string( fileStat.st_size ) ) ;
+      }
+      catch( ... ) {
+        item._checkpoint->set_exception( std::current_exception() ) ;
+        throw ;
+      }
+      return ;
+    }
+    if( not _split ) {
+      if( nullptr != item._runHeader ) {
+        _writer->writeRunHeader( item._runHeader.get() ) ;
+        _nRuns++ ;
+      }
+      if( nullptr != item._event ) {
+        _writer->writeEvent( item._event.get(), item._collections ) ;
+        _nEvents ++ ;
+      }
+      return ;
+    }
+    // split mode: the chunk bookkeeping is shared by the workers in synchronous mode
+    std::lock_guard<std::mutex> lock( _writeMutex ) ;
+    if( nullptr != item._runHeader ) {
+      // kept to be written again at the beginning of the next chunks
+      _currentRunHeader = item._runHeader ;
+      _writer->writeRunHeader( item._runHeader.get() ) ;
+      _nRuns++ ;
+    }
+    if( nullptr != item._event ) {
+      auto &chunk = _chunks.back() ;
+      if( chunk._events > 0 ) {
+        bool full = ( _splitEventCount > 0 and chunk._events >= static_cast<std::size_t>( _splitEventCount.get() ) ) ;
+        struct stat fileStat ;
+        if( not full and _splitFileSizekB > 0 and 0 == ::stat( chunk._name.c_str(), &fileStat ) ) {
+          full = ( fileStat.st_size >= static_cast<off_t>( _splitFileSizekB.get() ) * 1024 ) ;
+        }
+        if( full ) {
+          nextChunk() ;
+        }
+      }
+      _writer->writeEvent( item._event.get(), item._collections ) ;
+      _nEvents ++ ;
+      auto &current = _chunks.back() ;
+      const std::pair<int, int> id { item._event->getRunNumber(), item._event->getEventNumber() } ;
+      if( 0 == current._events ) {
+        current._first = id ;
+        current._firstIndex = item._inputIndex ;
+      }
+      current._last = id ;
+      current._lastIndex = item._inputIndex ;
+      current._events ++ ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  LCIOOutputProcessor::Writer LCIOOutputProcessor::openWriter( const std::string &fname, bool append ) const {
+    auto writer = std::make_shared<Writer::element_type>() ;
+    if ( append or _lcioWriteMode == "WRITE_APPEND" ) {
+      writer->open( fname , EVENT::LCIO::WRITE_APPEND ) ;
+    }
+    else if ( _lcioWriteMode == "WRITE_NEW" ) {
+      writer->open( fname , EVENT::LCIO::WRITE_NEW ) ;
+    }
+    else {
+      writer->open( fname ) ;
+    }
+    return writer ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::string LCIOOutputProcessor::checkpoint( std::size_t watermark ) {
+    auto promise = std::make_shared<std::promise<std::string>>() ;
+    auto state = promise->get_future() ;
+    WriteItem item {} ;
+    item._checkpoint = promise ;
+    _writeQueue->pushMarker( watermark, std::move( item ) ) ;
+    return state.get() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOOutputProcessor::restore( const std::string &state ) {
+    // no state: the processor was not in the previous job
+    if( state.empty() ) {
+      return ;
+    }
+    const std::string fname = outputFileName() ;
+    const auto size = std::stoull( state ) ;
+    // the events written after the checkpoint are processed again
+    if( 0 != ::truncate( fname.c_str(), size ) ) {
+      throw Exception( "LCIOOutputProcessor::restore: couldn't truncate file '" + fname + "'" ) ;
+    }
+    _resumed = true ;
+    log<MESSAGE>() << "Resuming output file " << fname << " at " << size << " bytes" << std::endl ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOOutputProcessor::nextChunk() {
+    if( nullptr != _writer ) {
+      _writer->close() ;
+    }
+    std::stringstream fname ;
+    fname << baseName() << "." << std::setw(3) << std::setfill('0') << _chunks.size() << ".slcio" ;
+    Chunk chunk {} ;
+    chunk._name = fname.str() ;
+    _chunks.push_back( chunk ) ;
+    _writer = openWriter( chunk._name ) ;
+    log<MESSAGE>() << "Writing output file " << chunk._name << std::endl ;
+    // each chunk must be readable on its own
+    if( nullptr != _currentRunHeader ) {
+      _writer->writeRunHeader( _currentRunHeader.get() ) ;
+    }
+    if( _chunks.size() > 1 ) {
+      writeManifest() ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void LCIOOutputProcessor::writeManifest() const {
+    const std::string fname = _manifestFile.get().empty() ? baseName() + ".manifest.json" : _manifestFile.get() ;
+    std::ofstream out( fname ) ;
+    if( not out ) {
+      throw Exception( "LCIOOutputProcessor::writeManifest: couldn't open file '" + fname + "'" ) ;
+    }
+    out << "{\n  \"files\": [" ;
+    for( std::size_t i=0 ; i<_chunks.size() ; ++i ) {
+      auto &chunk = _chunks[i] ;
+      out << ( i > 0 ? ",\n" : "\n" ) ;
+      out << "    {\n" ;
+      out << "      \"name\": " << StringUtil::jsonString( chunk._name ) << ",\n" ;
+      out << "      \"events\": " << chunk._events ;
+      if( chunk._events > 0 ) {
+        out << ",\n      \"first\": { \"run\": " << chunk._first.first << ", \"event\": " << chunk._first.second << ", \"index\": " << chunk._firstIndex << " }" ;
+        out << ",\n      \"last\": { \"run\": " << chunk._last.first << ", \"event\": " << chunk._last.second << ", \"index\": " << chunk._lastIndex << " }" ;
+      }
+      out << "\n    }" ;
+    }
+    out << "\n  ]\n}\n" ;
+    if( not out ) {
+      throw Exception( "LCIOOutputProcessor::writeManifest: couldn't write file '" + fname + "'" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::string LCIOOutputProcessor::baseName() const {
+    // LCIO appends the .slcio extension if missing
+    std::string base = _lcioOutputFile ;
+    const std::string extension = ".slcio" ;
+    if( base.size() > extension.size() and 0 == base.compare( base.size() - extension.size(), extension.size(), extension ) ) {
+      base.resize( base.size() - extension.size() ) ;
+    }
+    return base ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::string LCIOOutputProcessor::outputFileName() const {
+    return baseName() + ".slcio" ;
   }
 
   //--------------------------------------------------------------------------
 
   void LCIOOutputProcessor::end() {
+    if( nullptr != _writeQueue ) {
+      // write the remaining events
+      _writeQueue->stop() ;
+      _writeQueue = nullptr ;
+    }
     log<MESSAGE4>() << std::endl
   			      << "LCIOOutputProcessor::end()  " << name()
   			      << ": " << _nEvents.load() << " events in " << _nRuns.load() << " runs written to file  "
   			      <<  _lcioOutputFile
   			      << std::endl
   			      << std::endl ;
-    _writer->close() ;
-    _writer = nullptr ;
+    for( auto &shard : _shards ) {
+      shard->_writer->close() ;
+      shard->_order.close() ;
+    }
+    _shards.clear() ;
+    if( nullptr != _writer ) {
+      _writer->close() ;
+      _writer = nullptr ;
+    }
+    if( _split ) {
+      writeManifest() ;
+      log<MESSAGE>() << "Output written in " << _chunks.size() << " file(s)" << std::endl ;
+    }
   }
 
-  MARLIN_DECLARE_PROCESSOR( LCIOOutputProcessor )
+  MARLIN_DECLARE_PROCESSOR_NAME( LCIOOutputProcessor, "LCIOOutputProcessor" )
 }
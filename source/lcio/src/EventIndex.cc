@@ -0,0 +1,200 @@
+#include <marlin/lcio/EventIndex.h>
+
+// -- marlin headers
+#include <marlin/lcio/SIORecordReader.h>
+#include <marlin/Exceptions.h>
+
+// -- std headers
+#include <fstream>
+#include <cstdio>
+#include <sys/stat.h>
+
+namespace {
+
+  void fileStatus( const std::string &fname, std::uint64_t &size, std::int64_t &time ) {
+    struct stat fileStat ;
+    if( 0 != ::stat( fname.c_str(), &fileStat ) ) {
+      throw marlin::Exception( "EventIndex: couldn't stat file '" + fname + "'" ) ;
+    }
+    size = fileStat.st_size ;
+    time = fileStat.st_mtime ;
+  }
+
+}
+
+namespace marlin {
+
+  EventIndex EventIndex::build( const std::string &fname ) {
+    EventIndex index {} ;
+    index._fileName = fname ;
+    fileStatus( fname, index._fileSize, index._fileTime ) ;
+    SIORecordReader reader( fname, true ) ;
+    SIORecord record ;
+    std::vector<unsigned char> data ;
+    while( reader.next( record ) ) {
+      const bool runHeader = ( "LCRunHeader" == record._name ) ;
+      if( not runHeader and "LCEventHeader" != record._name ) {
+        continue ;
+      }
+      // the first block of the record: length, marker, version, name length, name (padded)
+      // followed by the run number and the event number (event header only)
+      reader.readData( record, data ) ;
+      if( data.size() < 16 or SIORecordReader::BlockMarker != SIORecordReader::readWord( data.data() + 4 ) ) {
+        throw Exception( "EventIndex::build: invalid block in record '" + record._name + "' in file '" + fname + "'" ) ;
+      }
+      const std::size_t nameLength = SIORecordReader::readWord( data.data() + 12 ) ;
+      const std::size_t dataOffset = 16 + ( ( nameLength + 3 ) & ~std::size_t(3) ) ;
+      const std::size_t nWords = runHeader ? 1 : 2 ;
+      if( data.size() < dataOffset + 4 * nWords ) {
+        throw Exception( "EventIndex::build: truncated block in record '" + record._name + "' in file '" + fname + "'" ) ;
+      }
+      Entry entry {} ;
+      entry._run = static_cast<int>( SIORecordReader::readWord( data.data() + dataOffset ) ) ;
+      if( not runHeader ) {
+        entry._event = static_cast<int>( SIORecordReader::readWord( data.data() + dataOffset + 4 ) ) ;
+      }
+      entry._offset = record._offset ;
+      index.add( entry, runHeader ) ;
+    }
+    return index ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  EventIndex EventIndex::load( const std::string &fname, const std::string &indexFile ) {
+    const std::string ifname = indexFile.empty() ? indexFileName( fname ) : indexFile ;
+    std::ifstream file( ifname ) ;
+    if( not file ) {
+      throw Exception( "EventIndex::load: couldn't open file '" + ifname + "'" ) ;
+    }
+    EventIndex index {} ;
+    index._fileName = fname ;
+    fileStatus( fname, index._fileSize, index._fileTime ) ;
+    std::string magic ;
+    unsigned int version {0} ;
+    std::uint64_t size {0} ;
+    std::int64_t time {0} ;
+    if( not ( file >> magic >> version >> size >> time ) or "MarlinEventIndex" != magic ) {
+      throw Exception( "EventIndex::load: invalid index file '" + ifname + "'" ) ;
+    }
+    if( Version != version ) {
+      throw Exception( "EventIndex::load: unsupported index file version in '" + ifname + "'" ) ;
+    }
+    if( size != index._fileSize or time != index._fileTime ) {
+      throw Exception( "EventIndex::load: index file '" + ifname + "' is out of date" ) ;
+    }
+    std::string kind ;
+    while( file >> kind ) {
+      Entry entry {} ;
+      bool valid = false ;
+      if( "R" == kind ) {
+        valid = static_cast<bool>( file >> entry._run >> entry._offset ) ;
+      }
+      else if( "E" == kind ) {
+        valid = static_cast<bool>( file >> entry._run >> entry._event >> entry._offset ) ;
+      }
+      if( not valid ) {
+        throw Exception( "EventIndex::load: invalid index file '" + ifname + "'" ) ;
+      }
+      index.add( entry, "R" == kind ) ;
+    }
+    return index ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool EventIndex::upToDate( const std::string &fname, const std::string &indexFile ) {
+    std::ifstream file( indexFile.empty() ? indexFileName( fname ) : indexFile ) ;
+    std::string magic ;
+    unsigned int version {0} ;
+    std::uint64_t size {0}, fileSize {0} ;
+    std::int64_t time {0}, fileTime {0} ;
+    if( not ( file >> magic >> version >> size >> time ) ) {
+      return false ;
+    }
+    fileStatus( fname, fileSize, fileTime ) ;
+    return ( "MarlinEventIndex" == magic and Version == version and size == fileSize and time == fileTime ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::string EventIndex::indexFileName( const std::string &fname ) {
+    return fname + Extension ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void EventIndex::save( const std::string &indexFile ) const {
+    const std::string ifname = indexFile.empty() ? indexFileName( _fileName ) : indexFile ;
+    // write a temporary file first: a concurrent job must never read a partial index
+    const std::string tmpname = ifname + ".tmp" ;
+    std::ofstream file( tmpname ) ;
+    if( not file ) {
+      throw Exception( "EventIndex::save: couldn't open file '" + tmpname + "'" ) ;
+    }
+    file << "MarlinEventIndex " << Version << " " << _fileSize << " " << _fileTime << "\n" ;
+    std::size_t runIndex {0} ;
+    for( auto &event : _events ) {
+      while( runIndex < event._runHeaders ) {
+        auto &rhdr = _runHeaders[runIndex++] ;
+        file << "R " << rhdr._run << " " << rhdr._offset << "\n" ;
+      }
+      file << "E " << event._run << " " << event._event << " " << event._offset << "\n" ;
+    }
+    while( runIndex < _runHeaders.size() ) {
+      auto &rhdr = _runHeaders[runIndex++] ;
+      file << "R " << rhdr._run << " " << rhdr._offset << "\n" ;
+    }
+    file.close() ;
+    if( not file or 0 != std::rename( tmpname.c_str(), ifname.c_str() ) ) {
+      std::remove( tmpname.c_str() ) ;
+      throw Exception( "EventIndex::save: couldn't write file '" + ifname + "'" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::string &EventIndex::fileName() const {
+    return _fileName ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::vector<EventIndex::Entry> &EventIndex::events() const {
+    return _events ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::vector<EventIndex::Entry> &EventIndex::runHeaders() const {
+    return _runHeaders ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  long EventIndex::find( int run, int event ) const {
+    auto iter = _lookup.find( { run, event } ) ;
+    return ( _lookup.end() == iter ) ? -1 : static_cast<long>( iter->second ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t EventIndex::duplicates() const {
+    return _duplicates ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void EventIndex::add( Entry entry, bool runHeader ) {
+    entry._runHeaders = _runHeaders.size() ;
+    if( runHeader ) {
+      _runHeaders.push_back( entry ) ;
+      return ;
+    }
+    if( not _lookup.insert( { { entry._run, entry._event }, _events.size() } ).second ) {
+      ++ _duplicates ;
+    }
+    _events.push_back( entry ) ;
+  }
+
+}
@@ -0,0 +1,109 @@
+#include <marlin/lcio/MappedFile.h>
+
+// -- marlin headers
+#include <marlin/Exceptions.h>
+
+// -- std headers
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+  std::uint64_t pageSize() {
+    static const std::uint64_t size = ::sysconf( _SC_PAGESIZE ) ;
+    return size ;
+  }
+
+}
+
+namespace marlin {
+
+  MappedFile::MappedFile( const std::string &fname ) :
+    _fileName(fname) {
+    _fd = ::open( fname.c_str(), O_RDONLY ) ;
+    if( _fd < 0 ) {
+      throw Exception( "MappedFile: couldn't open file '" + fname + "'" ) ;
+    }
+    struct stat fileStat ;
+    if( 0 != ::fstat( _fd, &fileStat ) ) {
+      ::close( _fd ) ;
+      throw Exception( "MappedFile: couldn't stat file '" + fname + "'" ) ;
+    }
+    _size = fileStat.st_size ;
+    if( 0 == _size ) {
+      return ;
+    }
+    void *data = ::mmap( nullptr, _size, PROT_READ, MAP_SHARED, _fd, 0 ) ;
+    if( MAP_FAILED == data ) {
+      ::close( _fd ) ;
+      throw Exception( "MappedFile: couldn't map file '" + fname + "'" ) ;
+    }
+    _data = static_cast<unsigned char*>( data ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  MappedFile::~MappedFile() {
+    if( nullptr != _data ) {
+      ::munmap( _data, _size ) ;
+    }
+    ::close( _fd ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::string &MappedFile::fileName() const {
+    return _fileName ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const unsigned char *MappedFile::data() const {
+    return _data ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::uint64_t MappedFile::size() const {
+    return _size ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void MappedFile::adviseSequential() {
+    if( nullptr != _data ) {
+      // advices are hints: failures are not errors
+      ::madvise( _data, _size, MADV_SEQUENTIAL ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void MappedFile::prefetch( std::uint64_t offset, std::uint64_t length ) {
+    const std::uint64_t end = std::min( offset + length, _size ) ;
+    // madvise needs a page aligned address
+    const std::uint64_t first = offset - ( offset % pageSize() ) ;
+    if( nullptr == _data or first >= end ) {
+      return ;
+    }
+    ::madvise( _data + first, end - first, MADV_WILLNEED ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void MappedFile::release( std::uint64_t offset, std::uint64_t length ) {
+    const std::uint64_t end = std::min( offset + length, _size ) ;
+    // the pages partially in the range may still be in use
+    const std::uint64_t first = ( offset + pageSize() - 1 ) / pageSize() * pageSize() ;
+    const std::uint64_t last = end - ( end % pageSize() ) ;
+    if( nullptr == _data or first >= last ) {
+      return ;
+    }
+    ::madvise( _data + first, last - first, MADV_DONTNEED ) ;
+    ::posix_fadvise( _fd, first, last - first, POSIX_FADV_DONTNEED ) ;
+  }
+
+}
@@ -0,0 +1,191 @@
+#include <marlin/lcio/SIORecordReader.h>
+
+// -- marlin headers
+#include <marlin/lcio/MappedFile.h>
+#include <marlin/Exceptions.h>
+
+// -- std headers
+#include <algorithm>
+
+// -- zlib headers
+#include <zlib.h>
+
+namespace {
+
+  std::uint64_t padded( std::uint64_t length ) {
+    return ( length + 3 ) & ~std::uint64_t(3) ;
+  }
+
+}
+
+namespace marlin {
+
+  SIORecordReader::SIORecordReader( const std::string &fname, bool mapped ) :
+    _fileName(fname) {
+    if( mapped ) {
+      _mappedFile = std::make_unique<MappedFile>( fname ) ;
+      _mappedFile->adviseSequential() ;
+      return ;
+    }
+    _file.open( fname, std::ios::binary ) ;
+    if( not _file ) {
+      throw Exception( "SIORecordReader: couldn't open file '" + fname + "'" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  SIORecordReader::~SIORecordReader() = default ;
+
+  //--------------------------------------------------------------------------
+
+  const unsigned char *SIORecordReader::fetch( std::uint64_t offset, std::uint64_t length, std::vector<unsigned char> &buffer ) {
+    if( nullptr != _mappedFile ) {
+      if( offset + length > _mappedFile->size() ) {
+        return nullptr ;
+      }
+      return _mappedFile->data() + offset ;
+    }
+    buffer.resize( length ) ;
+    _file.clear() ;
+    _file.seekg( offset ) ;
+    _file.read( reinterpret_cast<char*>( buffer.data() ), length ) ;
+    if( static_cast<std::uint64_t>( _file.gcount() ) != length ) {
+      return nullptr ;
+    }
+    return buffer.data() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool SIORecordReader::next( SIORecord &record ) {
+    const std::uint64_t fileSize = ( nullptr != _mappedFile ) ? _mappedFile->size() : 0 ;
+    if( nullptr != _mappedFile and _offset >= fileSize ) {
+      return false ;
+    }
+    unsigned char headerBuffer[24] ;
+    const unsigned char *header = headerBuffer ;
+    if( nullptr != _mappedFile ) {
+      if( _offset + sizeof(headerBuffer) > fileSize ) {
+        throw Exception( "SIORecordReader::next: truncated record header in file '" + _fileName + "'" ) ;
+      }
+      header = _mappedFile->data() + _offset ;
+    }
+    else {
+      _file.clear() ;
+      _file.seekg( _offset ) ;
+      _file.read( reinterpret_cast<char*>( headerBuffer ), sizeof(headerBuffer) ) ;
+      if( 0 == _file.gcount() and _file.eof() ) {
+        return false ;
+      }
+      if( _file.gcount() != sizeof(headerBuffer) ) {
+        throw Exception( "SIORecordReader::next: truncated record header in file '" + _fileName + "'" ) ;
+      }
+    }
+    const auto headerLength = readWord( header ) ;
+    const auto marker = readWord( header + 4 ) ;
+    const auto options = readWord( header + 8 ) ;
+    const auto dataLength = readWord( header + 12 ) ;
+    const auto ucmpLength = readWord( header + 16 ) ;
+    const auto nameLength = readWord( header + 20 ) ;
+    if( RecordMarker != marker ) {
+      throw Exception( "SIORecordReader::next: invalid record marker in file '" + _fileName + "' at offset " + std::to_string( _offset ) ) ;
+    }
+    if( headerLength < sizeof(headerBuffer) + nameLength ) {
+      throw Exception( "SIORecordReader::next: invalid record header length in file '" + _fileName + "'" ) ;
+    }
+    auto name = fetch( _offset + sizeof(headerBuffer), nameLength, _buffer ) ;
+    if( nullptr == name ) {
+      throw Exception( "SIORecordReader::next: truncated record name in file '" + _fileName + "'" ) ;
+    }
+    record._name.assign( reinterpret_cast<const char*>( name ), nameLength ) ;
+    record._offset = _offset ;
+    record._options = options ;
+    record._headerLength = headerLength ;
+    record._dataLength = dataLength ;
+    record._ucmpLength = ucmpLength ;
+    record._size = headerLength + padded( dataLength ) ;
+    _offset += record._size ;
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::vector<SIORecord> SIORecordReader::readAll() {
+    std::vector<SIORecord> records ;
+    SIORecord record ;
+    while( next( record ) ) {
+      records.push_back( record ) ;
+    }
+    return records ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void SIORecordReader::copy( const SIORecord &record, std::ostream &stream ) {
+    // read by chunks, unless mapped
+    const std::uint64_t chunkSize = ( nullptr != _mappedFile ) ? record._size : ( 1 << 20 ) ;
+    std::uint64_t offset = record._offset ;
+    const std::uint64_t end = record._offset + record._size ;
+    while( offset < end ) {
+      const auto size = std::min( end - offset, chunkSize ) ;
+      auto bytes = fetch( offset, size, _buffer ) ;
+      if( nullptr == bytes ) {
+        throw Exception( "SIORecordReader::copy: truncated record '" + record._name + "' in file '" + _fileName + "'" ) ;
+      }
+      stream.write( reinterpret_cast<const char*>( bytes ), size ) ;
+      offset += size ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void SIORecordReader::readData( const SIORecord &record, std::vector<unsigned char> &data ) {
+    auto raw = fetch( record._offset + record._headerLength, record._dataLength, _buffer ) ;
+    if( nullptr == raw ) {
+      throw Exception( "SIORecordReader::readData: truncated record '" + record._name + "' in file '" + _fileName + "'" ) ;
+    }
+    if( 0 == ( record._options & CompressOption ) ) {
+      data.assign( raw, raw + record._dataLength ) ;
+      return ;
+    }
+    // in mapped mode, inflate directly from the mapped file
+    data.resize( record._ucmpLength ) ;
+    uLongf length = data.size() ;
+    if( Z_OK != ::uncompress( data.data(), &length, raw, record._dataLength ) or length != data.size() ) {
+      throw Exception( "SIORecordReader::readData: couldn't uncompress record '" + record._name + "' in file '" + _fileName + "'" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  const unsigned char *SIORecordReader::view( const SIORecord &record ) const {
+    if( nullptr == _mappedFile ) {
+      throw Exception( "SIORecordReader::view: file '" + _fileName + "' is not mapped" ) ;
+    }
+    if( record._offset + record._headerLength + record._dataLength > _mappedFile->size() ) {
+      throw Exception( "SIORecordReader::view: truncated record '" + record._name + "' in file '" + _fileName + "'" ) ;
+    }
+    return _mappedFile->data() + record._offset + record._headerLength ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  MappedFile *SIORecordReader::mappedFile() const {
+    return _mappedFile.get() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::uint32_t SIORecordReader::readWord( const unsigned char *bytes ) {
+    return ( std::uint32_t(bytes[0]) << 24 ) | ( std::uint32_t(bytes[1]) << 16 ) |
+      ( std::uint32_t(bytes[2]) << 8 ) | std::uint32_t(bytes[3]) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool SIORecordReader::isRandomAccess( const SIORecord &record ) {
+    return ( record._name == RandomAccessRecord or record._name == IndexRecord ) ;
+  }
+
+}
@@ -0,0 +1,58 @@
+// -- std headers
+#include <iostream>
+#include <string>
+
+// -- marlin headers
+#include <marlin/SteeringCache.h>
+#include <marlin/Exceptions.h>
+#include <marlin/Utils.h>
+
+using namespace marlin ;
+
+void printUsage( const std::string &program ) {
+  std::cout << " Usage: " << program << " [--section.parameter=value ...] steer.xml cache.bin" << std::endl
+    << "   Compile a steering file into a binary cache file for faster startup." << std::endl
+    << "   The command line options must match the ones used at runtime, e.g:" << std::endl
+    << "     " << program << " --global.MaxRecordNumber=10 steer.xml steer.bin" << std::endl
+    << "     MarlinMT -s steer.bin --global.MaxRecordNumber=10 steer.xml" << std::endl ;
+}
+
+int main( int argc, char **argv ) {
+  const std::string program = argv[0] ;
+  CommandLineParametersMap cmdLineOptions ;
+  std::vector<std::string> files ;
+  for( int i=1 ; i<argc ; ++i ) {
+    const std::string arg = argv[i] ;
+    if( arg == "-h" or arg == "-?" ) {
+      printUsage( program ) ;
+      return 0 ;
+    }
+    if( arg.substr( 0, 2 ) == "--" ) {
+      auto argVec = StringUtil::split<std::string>( arg.substr( 2 ) , "=" ) ;
+      auto argKey = ( argVec.size() == 2 ) ? StringUtil::split<std::string>( argVec[0] , "." ) : std::vector<std::string>() ;
+      if( argKey.size() != 2 ) {
+        std::cerr << "*** invalid command line option: " << arg << std::endl ;
+        printUsage( program ) ;
+        return 1 ;
+      }
+      cmdLineOptions[ argKey[0] ][ argKey[1] ] = argVec[1] ;
+      continue ;
+    }
+    files.push_back( arg ) ;
+  }
+  if( files.size() != 2 ) {
+    printUsage( program ) ;
+    return 1 ;
+  }
+  try {
+    SteeringCache cache( files[0], files[1] ) ;
+    cache.setCmdLineParameters( cmdLineOptions ) ;
+    cache.compile() ;
+  }
+  catch( marlin::Exception &e ) {
+    std::cerr << "Couldn't compile steering file: " << e.what() << std::endl ;
+    return 1 ;
+  }
+  std::cout << "Steering file " << files[0] << " compiled in " << files[1] << std::endl ;
+  return 0 ;
+}
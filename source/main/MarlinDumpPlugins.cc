@@ -1,5 +1,7 @@
 // -- std headers
 #include <memory>
+#include <string>
+#include <iostream>
 
 // -- marlin headers
 #include <marlin/Logging.h>
@@ -8,13 +10,32 @@
 
 using namespace marlin ;
 
-int main() {
+int main( int argc, char **argv ) {
+  std::string manifest ;
+  for ( int i=1 ; i<argc ; ++i ) {
+    const std::string arg = argv[i] ;
+    if ( arg == "-m" and i+1 < argc ) {
+      manifest = argv[++i] ;
+    }
+    else {
+      std::cout << " Usage: " << argv[0] << " [-m manifest]" << std::endl
+        << "   Dump the plugins found in MARLIN_DLL libraries." << std::endl
+        << "   With -m, also write the plugin manifest used for lazy loading" << std::endl
+        << "   of libraries at startup (export MARLIN_PLUGIN_MANIFEST=manifest)" << std::endl ;
+      return ( arg == "-h" ) ? 0 : 1 ;
+    }
+  }
   // load plugins first
   auto &mgr = PluginManager::instance() ;
   mgr.logger()->setLevel<MESSAGE>();
-  if ( not mgr.loadLibraries() ) {
+  // the manifest must be generated from the libraries, not from itself
+  if ( not mgr.loadLibraries( "MARLIN_DLL", "" ) ) {
     throw Exception( "Couldn't load shared libraries from MARLIN_DLL !" ) ;
   }
   mgr.dump() ;
+  if ( not manifest.empty() ) {
+    mgr.writeManifest( manifest ) ;
+    mgr.logger()->log<MESSAGE>() << "Plugin manifest written in " << manifest << std::endl ;
+  }
   return 0 ;
 }
@@ -5,6 +5,7 @@
 #include <marlin/Utils.h>
 #include <marlin/DataSourcePlugin.h>
 #include <marlin/XMLParser.h>
+#include <marlin/SteeringCache.h>
 #include <marlin/MarlinConfig.h>
 #include <marlin/EventExtensions.h>
 #include <marlin/IScheduler.h>
@@ -15,6 +16,9 @@
 
 // -- std headers
 #include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
 
 using namespace std::placeholders ;
 
@@ -47,8 +51,16 @@ namespace marlin {
       logger()->log<MESSAGE>() << "No scheduler set. Using SimpleScheduler (single threaded program)" << std::endl ;
       _scheduler = std::make_shared<SimpleScheduler>() ;
     }
+    // random seeds. The event seeds are derived from the global seed
+    if( globals->isParameterSet( "RandomSeed" ) ) {
+      _randomSeedMgr.setGlobalSeed( globals->getValue<RandomSeedManager::SeedType>( "RandomSeed" ) ) ;
+    }
+    // read the checkpoint to resume from before the processors register to checkpoints
+    initCheckpoint() ;
     // initialize geometry
     _geometryMgr.init( this ) ;
+    // initialize book store, before the processors book histograms
+    _bookStore.init( this ) ;
     // initialize scheduler
     _scheduler->init( this ) ;
     // initialize data source
@@ -59,10 +71,6 @@ namespace marlin {
     if( nullptr == _dataSource ) {
       throw Exception( "Data source of type '" + dstype + "' not found in plugins" ) ;
     }
-    _dataSource->init( this ) ;
-    // setup callbacks
-    _dataSource->onEventRead( std::bind( &Application::onEventRead, this, _1 ) ) ;
-    _dataSource->onRunHeaderRead( std::bind( &Application::onRunHeaderRead, this, _1 ) ) ;
     // store processor conditions
     auto activeProcs = activeProcessors() ;
     auto processorConds = processorConditions() ;
@@ -72,6 +80,30 @@ namespace marlin {
         _conditions[ activeProcs[i] ] = processorConds[i] ;
       }
     }
+    // push the event selection down to the data source, before it is initialized
+    auto filter = globals->getValue<bool>( "EventFilterPushdown", true ) ? pushdownEventFilter() : nullptr ;
+    if( nullptr != filter ) {
+      if( _dataSource->supportsEventFilter() ) {
+        logger()->log<MESSAGE>() << "Event selection of processor '" << activeProcs.front() << "' pushed down to the data source" << std::endl ;
+        _dataSource->setEventFilter( filter ) ;
+      }
+      else {
+        logger()->log<MESSAGE>() << "Data source doesn't support event filters, event selection not pushed down" << std::endl ;
+      }
+    }
+    _dataSource->setInputCollections( _inputCollections ) ;
+    _dataSource->init( this ) ;
+    if( checkpointing() ) {
+      if( not _dataSource->supportsResume() ) {
+        throw Exception( "Data source of type '" + dstype + "' doesn't support checkpoints (global parameter CheckpointFile)" ) ;
+      }
+      if( _resume ) {
+        _dataSource->resume( _resumeCheckpoint._position ) ;
+      }
+    }
+    // setup callbacks
+    _dataSource->onEventRead( std::bind( &Application::onEventRead, this, _1 ) ) ;
+    _dataSource->onRunHeaderRead( std::bind( &Application::onRunHeaderRead, this, _1 ) ) ;
     _initialized = true ;
   }
 
@@ -93,8 +125,20 @@ namespace marlin {
           << std::endl ;
       throw e ;
     }
+    if( _dataSource->filteredEvents() > 0 ) {
+      logger()->log<MESSAGE>() << _dataSource->filteredEvents() << " event(s) filtered out by the data source" << std::endl ;
+    }
     _geometryMgr.clear() ;
     _scheduler->end() ;
+    if( _resume and not _bookStore.histograms().empty() ) {
+      logger()->log<WARNING>() << "Resumed job: the book store file only holds the histograms of the events processed after the checkpoint" << std::endl ;
+    }
+    _bookStore.end() ;
+    if( checkpointing() ) {
+      // the job is complete: a later resume must not skip anything
+      std::remove( _checkpointFile.c_str() ) ;
+      logger()->log<MESSAGE>() << "Job complete, checkpoint file " << _checkpointFile << " removed" << std::endl ;
+    }
     // end() ;
   }
 
@@ -109,6 +153,8 @@ namespace marlin {
     << std::endl
     << "   " << _programName << " [-h/-?]             \t print this help information" << std::endl
     << "   " << _programName << " -x [steer.xml]      \t print an example steering file to output file file (default: marlin_steer.xml)" << std::endl
+    << "   " << _programName << " -s cache.bin steer.xml\t use (or create) a compiled steering file cache for faster startup" << std::endl
+    << "   " << _programName << " -r steer.xml        \t resume a job from its checkpoint file (global parameter CheckpointFile)" << std::endl
     // << "   " << _programName << " -c steer.xml        \t check the given steering file for consistency" << std::endl
     // << "   " << _programName << " -u old.xml new.xml  \t consistency check with update of xml file"  << std::endl
     // << "   " << _programName << " -d steer.xml flow.dot\t create a program flow diagram (see: http://www.graphviz.org)" << std::endl
@@ -131,6 +177,7 @@ namespace marlin {
   void Application::parseCommandLine() {
     logger()->log<MESSAGE>() << "Parsing command line ..." << std::endl ;
     _steeringFileName.clear() ;
+    _steeringCacheFile.clear() ;
     _cmdLineOptions.clear() ;
     auto cmdLineArgs = _arguments ;
     if ( cmdLineArgs.empty() ) {
@@ -194,6 +241,21 @@ namespace marlin {
         XMLTools::dumpRegisteredProcessors( fname ) ;
         ::exit( 0 ) ;
       }
+      // compiled steering file cache
+      else if( arg == "-s" ) {
+        auto nextarg = std::next( iter ) ;
+        if( nextarg == cmdLineArgs.end() ) {
+          printUsage() ;
+          logger()->log<ERROR>() << "*** option -s requires a cache file name" << std::endl ;
+          ::exit( 1 ) ;
+        }
+        _steeringCacheFile = *nextarg ;
+        iter = nextarg ;
+      }
+      // resume from the checkpoint file
+      else if( arg == "-r" ) {
+        _resume = true ;
+      }
       // last argument is steering file
       else if( std::next( iter ) == cmdLineArgs.end() ) {
         _steeringFileName = arg ;
@@ -309,12 +371,26 @@ namespace marlin {
     while( _scheduler->freeSlots() == 0 ) {
       _scheduler->popFinishedEvents( events ) ;
       if( not events.empty() ) {
+        // retiring events may free slots: check again before sleeping
         processFinishedEvents( events ) ;
         events.clear() ;
-        break;
+        continue ;
       }
       std::this_thread::sleep_for( std::chrono::milliseconds(1) ) ;
     }
+    // input index, to restore the input order downstream if needed
+    const std::size_t inputIndex = _eventsRead.load() ;
+    event->setInputIndex( inputIndex ) ;
+    _inFlightIndices.insert( inputIndex ) ;
+    {
+      std::lock_guard<std::mutex> lock( _processingMutex ) ;
+      _processingIndices.insert( inputIndex ) ;
+      _eventsRead.store( inputIndex + 1 ) ;
+    }
+    if( checkpointing() ) {
+      // where to resume if this event is the last committed one
+      _sourcePositions[ inputIndex ] = _dataSource->position() ;
+    }
     // prepare event extensions for users
     // random seeds extension
     auto seeds = _randomSeedMgr.generateRandomSeeds( event.get() ) ;
@@ -323,6 +399,8 @@ namespace marlin {
     // runtime conditions extension
     auto procCondExtension = new ProcessorConditionsExtension( _conditions ) ;
     event->extensions().add<extensions::ProcessorConditions>( procCondExtension )  ;
+    // cancellation flag, set by the event watchdog
+    event->extensions().add<extensions::Cancellation>( new CancellationExtension() ) ;
     // first event flag
     *( event->extensions().create<extensions::IsFirstEvent, bool>( true ) ) = _isFirstEvent ;
     _isFirstEvent = false ;
@@ -332,6 +410,7 @@ namespace marlin {
     if( not events.empty() ) {
       processFinishedEvents( events ) ;
     }
+    checkpoint() ;
   }
 
   //--------------------------------------------------------------------------
@@ -361,12 +440,212 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  const BookStore &Application::bookStore() const {
+    return _bookStore ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  BookStore &Application::bookStore() {
+    return _bookStore ;
+  }
+
+  //--------------------------------------------------------------------------
+
   void Application::setScheduler( Scheduler scheduler ) {
     _scheduler = scheduler ;
   }
 
   //--------------------------------------------------------------------------
 
+  std::size_t Application::concurrency() const {
+    return ( nullptr != _scheduler ) ? _scheduler->concurrency() : 1 ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  concurrency::TaskQueue &Application::taskQueue() const {
+    return _taskQueue ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t Application::eventsRead() const {
+    return _eventsRead.load() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t Application::retiredWatermark() const {
+    return _retiredWatermark.load() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t Application::processedWatermark() const {
+    return _processedWatermark.load() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Application::eventProcessed( std::size_t inputIndex ) {
+    std::lock_guard<std::mutex> lock( _processingMutex ) ;
+    _processingIndices.erase( inputIndex ) ;
+    _processedWatermark.store( _processingIndices.empty() ? _eventsRead.load() : *_processingIndices.begin() ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Application::registerEventFilter( const std::string &processor, EventFilter filter ) {
+    std::lock_guard<std::mutex> lock( _registrationMutex ) ;
+    // processor clones register the same filter
+    _eventFilters[ processor ] = filter ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Application::registerInputCollections( const std::string &processor, const std::vector<std::string> &names ) {
+    std::lock_guard<std::mutex> lock( _registrationMutex ) ;
+    _inputCollections.addCollections( processor, names ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Application::registerAllInputCollections( const std::string &processor, const InputCollections::NameSet &exceptNames, const InputCollections::NameSet &exceptTypes ) {
+    std::lock_guard<std::mutex> lock( _registrationMutex ) ;
+    _inputCollections.addAllCollections( processor, exceptNames, exceptTypes ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Application::registerInputProcessor( const std::string &processor ) {
+    std::lock_guard<std::mutex> lock( _registrationMutex ) ;
+    _inputCollections.addProcessor( processor ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool Application::checkpointing() const {
+    return not _checkpointFile.empty() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Application::registerCheckpoint( const std::string &name, Checkpoint::SaveFunction save, Checkpoint::RestoreFunction restore ) {
+    std::lock_guard<std::mutex> lock( _registrationMutex ) ;
+    if( not _checkpointParticipants.insert( { name, save } ).second ) {
+      throw Exception( "Application::registerCheckpoint: participant '" + name + "' already registered" ) ;
+    }
+    if( _resume ) {
+      auto iter = _resumeCheckpoint._states.find( name ) ;
+      restore( _resumeCheckpoint._states.end() != iter ? iter->second : "" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Application::initCheckpoint() {
+    auto globals = globalParameters() ;
+    _checkpointFile = globals->getValue<std::string>( "CheckpointFile", "" ) ;
+    const double interval = globals->getValue<double>( "CheckpointInterval", 600. ) ;
+    _checkpointInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( interval ) ) ;
+    _lastCheckpoint = std::chrono::steady_clock::now() ;
+    if( not _resume ) {
+      return ;
+    }
+    if( _checkpointFile.empty() ) {
+      throw Exception( "Application::init: resuming a job (-r) requires the global parameter CheckpointFile" ) ;
+    }
+    if( not std::ifstream( _checkpointFile ) ) {
+      logger()->log<WARNING>() << "No checkpoint file " << _checkpointFile << ", starting the job from the beginning" << std::endl ;
+      _resume = false ;
+      return ;
+    }
+    _resumeCheckpoint = Checkpoint::load( _checkpointFile ) ;
+    _committedBefore = _resumeCheckpoint._watermark ;
+    if( globals->isParameterSet( "RandomSeed" ) and _resumeCheckpoint._randomSeed != _randomSeedMgr.globalSeed() ) {
+      logger()->log<WARNING>() << "RandomSeed differs from the checkpoint one, using the checkpoint random seed" << std::endl ;
+    }
+    _randomSeedMgr.setGlobalSeed( _resumeCheckpoint._randomSeed ) ;
+    logger()->log<MESSAGE>() << "Resuming from checkpoint " << _checkpointFile << ": "
+      << _committedBefore << " event(s) already committed" << std::endl ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Application::checkpoint() {
+    if( not checkpointing() ) {
+      return ;
+    }
+    const auto now = std::chrono::steady_clock::now() ;
+    if( now - _lastCheckpoint < _checkpointInterval ) {
+      return ;
+    }
+    _lastCheckpoint = now ;
+    // the histograms are not saved: a resumed job would overwrite the book
+    // store file with the histograms of the remaining events only
+    if( not _bookStore.histograms().empty() ) {
+      if( not _checkpointsRefused ) {
+        logger()->log<WARNING>() << "Histograms booked, no checkpoint written: a resumed job would lose the histograms of the committed events" << std::endl ;
+        _checkpointsRefused = true ;
+      }
+      return ;
+    }
+    // all events below the watermark are retired, so written by the ordered outputs
+    const std::size_t watermark = _retiredWatermark.load() ;
+    if( 0 == watermark or watermark == _checkpointWatermark ) {
+      return ;
+    }
+    auto positionIter = _sourcePositions.find( watermark - 1 ) ;
+    if( _sourcePositions.end() == positionIter ) {
+      throw Exception( "Application::checkpoint: no data source position for event index " + std::to_string( watermark - 1 ) ) ;
+    }
+    Checkpoint checkpoint {} ;
+    checkpoint._watermark = _committedBefore + watermark ;
+    checkpoint._randomSeed = _randomSeedMgr.globalSeed() ;
+    checkpoint._position = positionIter->second ;
+    for( auto &participant : _checkpointParticipants ) {
+      checkpoint._states[ participant.first ] = participant.second( watermark ) ;
+    }
+    checkpoint.save( _checkpointFile ) ;
+    _checkpointWatermark = watermark ;
+    logger()->log<MESSAGE>() << "Checkpoint written: " << checkpoint._watermark << " event(s) committed" << std::endl ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  EventFilter Application::pushdownEventFilter() const {
+    auto activeProcs = activeProcessors() ;
+    if( activeProcs.empty() or _conditions.size() != activeProcs.size() ) {
+      return nullptr ;
+    }
+    const auto &selector = activeProcs.front() ;
+    auto filterIter = _eventFilters.find( selector ) ;
+    if( _eventFilters.end() == filterIter ) {
+      return nullptr ;
+    }
+    // the selector must run on all events
+    auto selectorCondition = StringUtil::split<std::string>( _conditions.find( selector )->second, " \t\n" ) ;
+    if( 1 != selectorCondition.size() or "true" != selectorCondition.front() ) {
+      return nullptr ;
+    }
+    // all other processors must require the selector: a plain conjunction
+    // of conditions, one of them being the selector return value
+    for( std::size_t i=1 ; i<activeProcs.size() ; ++i ) {
+      const auto &expression = _conditions.find( activeProcs[i] )->second ;
+      if( expression.find_first_of( "|!" ) != std::string::npos ) {
+        return nullptr ;
+      }
+      auto terms = StringUtil::split<std::string>( expression, "&() \t\n" ) ;
+      if( terms.end() == std::find( terms.begin(), terms.end(), selector ) ) {
+        return nullptr ;
+      }
+    }
+    return filterIter->second ;
+  }
+
+  //--------------------------------------------------------------------------
+
   std::shared_ptr<IParser> Application::parser() const {
     return _parser ;
   }
@@ -374,6 +653,11 @@ namespace marlin {
   //--------------------------------------------------------------------------
 
   std::shared_ptr<IParser> Application::createParser() const {
+    if( not _steeringCacheFile.empty() ) {
+      auto parser = std::make_shared<SteeringCache>( _steeringFileName, _steeringCacheFile ) ;
+      parser->setCmdLineParameters( _cmdLineOptions ) ;
+      return parser ;
+    }
     auto parser = std::make_shared<XMLParser>( _steeringFileName ) ;
     // tell parser to take into account any options defined on the command line
     parser->setCmdLineParameters( _cmdLineOptions ) ;
@@ -388,6 +672,15 @@ namespace marlin {
       logger()->log<MESSAGE9>()
         << "Event uid " << event->uid()
         << " finished" << std::endl ;
+      // the event is retired: give its transient memory back
+      event->releaseArena() ;
+      _inFlightIndices.erase( event->inputIndex() ) ;
+    }
+    const std::size_t watermark = _inFlightIndices.empty() ? _eventsRead.load() : *_inFlightIndices.begin() ;
+    _retiredWatermark.store( watermark ) ;
+    // only the position after the last retired event is needed for a checkpoint
+    if( watermark > 0 ) {
+      _sourcePositions.erase( _sourcePositions.begin(), _sourcePositions.lower_bound( watermark - 1 ) ) ;
     }
   }
 
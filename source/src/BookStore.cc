@@ -0,0 +1,483 @@
+#include <marlin/BookStore.h>
+
+// -- marlin headers
+#include <marlin/Application.h>
+#include <marlin/StringParameters.h>
+#include <marlin/Exceptions.h>
+#include <marlin/Utils.h>
+
+// -- std headers
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <cmath>
+#include <sstream>
+
+#ifdef MARLIN_BOOK
+// -- root headers
+#include <TFile.h>
+#include <TDirectory.h>
+#include <TH1D.h>
+#include <TH2D.h>
+#include <TProfile.h>
+#endif
+
+namespace marlin {
+
+  namespace {
+
+    /// Write a list of doubles as JSON array. Non finite values are written as null
+    void jsonArray( std::ostream &out, const std::vector<double> &values ) {
+      out << '[' ;
+      for( std::size_t i=0 ; i<values.size() ; ++i ) {
+        if( i > 0 ) {
+          out << ',' ;
+        }
+        if( std::isfinite( values[i] ) ) {
+          out << values[i] ;
+        }
+        else {
+          out << "null" ;
+        }
+      }
+      out << ']' ;
+    }
+
+    /// Get the histogram type name as written in output files
+    std::string typeName( HistogramType type ) {
+      switch( type ) {
+        case HistogramType::H1: return "H1" ;
+        case HistogramType::H2: return "H2" ;
+        case HistogramType::Profile1: return "Profile1" ;
+      }
+      return "Unknown" ;
+    }
+
+    /// Whether the string ends with the suffix
+    bool endsWith( const std::string &str, const std::string &suffix ) {
+      return ( str.size() >= suffix.size() and 0 == str.compare( str.size() - suffix.size(), suffix.size(), suffix ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  HistogramAxis::HistogramAxis( std::size_t nbins, double min, double max ) :
+    _nbins(nbins),
+    _min(min),
+    _max(max) {
+    if( 0 == _nbins or not ( _max > _min ) ) {
+      throw Exception( "HistogramAxis: invalid binning (nbins=0 or max <= min)" ) ;
+    }
+    _scale = _nbins / ( _max - _min ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  HistogramAxis::HistogramAxis( const std::vector<double> &edges ) :
+    _edges(edges) {
+    if( _edges.size() < 2 ) {
+      throw Exception( "HistogramAxis: at least 2 bin edges are required" ) ;
+    }
+    for( std::size_t i=1 ; i<_edges.size() ; ++i ) {
+      if( not ( _edges[i] > _edges[i-1] ) ) {
+        throw Exception( "HistogramAxis: bin edges must be strictly increasing" ) ;
+      }
+    }
+    _nbins = _edges.size() - 1 ;
+    _min = _edges.front() ;
+    _max = _edges.back() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t HistogramAxis::nbins() const {
+    return _nbins ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  double HistogramAxis::min() const {
+    return _min ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  double HistogramAxis::max() const {
+    return _max ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool HistogramAxis::variable() const {
+    return not _edges.empty() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::vector<double> &HistogramAxis::edges() const {
+    return _edges ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool HistogramAxis::operator==( const HistogramAxis &rhs ) const {
+    return ( _nbins == rhs._nbins and _min == rhs._min and _max == rhs._max and _edges == rhs._edges ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  HistogramData::HistogramData( HistogramType type, const Axes &axes ) :
+    _type(type),
+    _axes(axes) {
+    const std::size_t naxes = ( HistogramType::H2 == _type ) ? 2 : 1 ;
+    if( _axes.size() != naxes ) {
+      throw Exception( "HistogramData: expected " + std::to_string( naxes ) + " axis, got " + std::to_string( _axes.size() ) ) ;
+    }
+    std::size_t nbins = 1 ;
+    for( auto &axis : _axes ) {
+      nbins *= ( axis.nbins() + 2 ) ;
+    }
+    _sumw.resize( nbins, 0. ) ;
+    _sumw2.resize( nbins, 0. ) ;
+    if( HistogramType::Profile1 == _type ) {
+      _sumwy.resize( nbins, 0. ) ;
+      _sumwy2.resize( nbins, 0. ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  HistogramType HistogramData::type() const {
+    return _type ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const HistogramData::Axes &HistogramData::axes() const {
+    return _axes ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void HistogramData::add( const HistogramData &other ) {
+    if( _type != other._type or _axes != other._axes ) {
+      throw Exception( "HistogramData::add: histograms have different types or binning" ) ;
+    }
+    _entries += other._entries ;
+    for( std::size_t i=0 ; i<_sumw.size() ; ++i ) {
+      _sumw[i] += other._sumw[i] ;
+      _sumw2[i] += other._sumw2[i] ;
+    }
+    for( std::size_t i=0 ; i<_sumwy.size() ; ++i ) {
+      _sumwy[i] += other._sumwy[i] ;
+      _sumwy2[i] += other._sumwy2[i] ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned long long HistogramData::entries() const {
+    return _entries ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const HistogramData::Bins &HistogramData::sumw() const {
+    return _sumw ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const HistogramData::Bins &HistogramData::sumw2() const {
+    return _sumw2 ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const HistogramData::Bins &HistogramData::sumwy() const {
+    return _sumwy ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const HistogramData::Bins &HistogramData::sumwy2() const {
+    return _sumwy2 ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  Histogram::Histogram( const std::string &path, const std::string &title, const HistogramData &prototype, std::size_t nworkers ) :
+    _path(path),
+    _title(title),
+    _prototype(prototype),
+    _buffers(nworkers, [prototype]( std::size_t ) {
+      return std::unique_ptr<HistogramData>( new HistogramData( prototype ) ) ;
+    }) {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::string &Histogram::path() const {
+    return _path ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::string &Histogram::title() const {
+    return _title ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  HistogramType Histogram::type() const {
+    return _prototype.type() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const HistogramData::Axes &Histogram::axes() const {
+    return _prototype.axes() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  HistogramData Histogram::merged() const {
+    HistogramData result( _prototype ) ;
+    _buffers.forEach( [&result]( std::size_t, HistogramData &data ) {
+      result.add( data ) ;
+    }) ;
+    return result ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  BookStore::BookStore() {
+    _logger = Logging::createLogger( "BookStore" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void BookStore::init( const Application *app ) {
+    _application = app ;
+    _logger = _application->createLogger( "BookStore" ) ;
+    _outputFile = _application->globalParameters()->getValue<std::string>( "BookStoreFile", "MarlinBookStore.json" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void BookStore::init( std::size_t nworkers, const std::string &outputFile ) {
+    if( 0 == nworkers ) {
+      throw Exception( "BookStore::init: number of workers must be > 0" ) ;
+    }
+    _application = nullptr ;
+    _nworkers = nworkers ;
+    _outputFile = outputFile ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  T &BookStore::book( const std::string &path, const std::string &title, HistogramType type, const HistogramData::Axes &axes ) {
+    if( nullptr == _application and 0 == _nworkers ) {
+      throw Exception( "BookStore::book: book store not initialized" ) ;
+    }
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    auto iter = _histograms.find( path ) ;
+    if( _histograms.end() != iter ) {
+      if( iter->second->type() != type or iter->second->axes() != axes ) {
+        throw Exception( "BookStore::book: histogram '" + path + "' already booked with a different type or binning" ) ;
+      }
+      _logger->log<DEBUG2>() << "Histogram " << path << " already booked, sharing it" << std::endl ;
+      return static_cast<T&>( *iter->second ) ;
+    }
+    auto histogram = std::make_shared<T>( path, title, HistogramData( type, axes ), ( nullptr != _application ) ? _application->concurrency() : _nworkers ) ;
+    _histograms.insert( { path, histogram } ) ;
+    _logger->log<DEBUG2>() << "Booked histogram " << path << std::endl ;
+    return *histogram ;
+  }
+
+
+  //--------------------------------------------------------------------------
+
+  Histogram1D &BookStore::book1D( const std::string &path, const std::string &title, const HistogramAxis &axis ) {
+    return book<Histogram1D>( path, title, HistogramType::H1, { axis } ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  Histogram2D &BookStore::book2D( const std::string &path, const std::string &title, const HistogramAxis &xaxis, const HistogramAxis &yaxis ) {
+    return book<Histogram2D>( path, title, HistogramType::H2, { xaxis, yaxis } ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  Profile1D &BookStore::bookProfile1D( const std::string &path, const std::string &title, const HistogramAxis &axis ) {
+    return book<Profile1D>( path, title, HistogramType::Profile1, { axis } ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const BookStore::HistogramMap &BookStore::histograms() const {
+    return _histograms ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void BookStore::end() {
+    if( _histograms.empty() or _outputFile.empty() ) {
+      return ;
+    }
+    if( endsWith( _outputFile, ".root" ) ) {
+      writeROOT( _outputFile ) ;
+    }
+    else {
+      writeJSON( _outputFile ) ;
+    }
+    _logger->log<MESSAGE>() << "Wrote " << _histograms.size() << " histogram(s) to " << _outputFile << std::endl ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void BookStore::writeJSON( const std::string &fname ) const {
+    std::ofstream out( fname ) ;
+    if( not out ) {
+      throw Exception( "BookStore::writeJSON: couldn't open file '" + fname + "'" ) ;
+    }
+    out << std::setprecision( std::numeric_limits<double>::max_digits10 ) ;
+    out << "{\n  \"histograms\": [" ;
+    bool first = true ;
+    for( auto &entry : _histograms ) {
+      auto &histogram = entry.second ;
+      auto data = histogram->merged() ;
+      out << ( first ? "\n" : ",\n" ) ;
+      first = false ;
+      out << "    {\n" ;
+      out << "      \"path\": " << StringUtil::jsonString( histogram->path() ) << ",\n" ;
+      out << "      \"title\": " << StringUtil::jsonString( histogram->title() ) << ",\n" ;
+      out << "      \"type\": " << StringUtil::jsonString( typeName( histogram->type() ) ) << ",\n" ;
+      out << "      \"entries\": " << data.entries() << ",\n" ;
+      out << "      \"axes\": [" ;
+      for( std::size_t a=0 ; a<data.axes().size() ; ++a ) {
+        auto &axis = data.axes()[a] ;
+        out << ( a > 0 ? ", " : "" ) << "{ \"nbins\": " << axis.nbins() << ", \"min\": " << axis.min() << ", \"max\": " << axis.max() ;
+        if( axis.variable() ) {
+          out << ", \"edges\": " ;
+          jsonArray( out, axis.edges() ) ;
+        }
+        out << " }" ;
+      }
+      out << "],\n" ;
+      out << "      \"sumw\": " ;
+      jsonArray( out, data.sumw() ) ;
+      out << ",\n      \"sumw2\": " ;
+      jsonArray( out, data.sumw2() ) ;
+      if( HistogramType::Profile1 == data.type() ) {
+        out << ",\n      \"sumwy\": " ;
+        jsonArray( out, data.sumwy() ) ;
+        out << ",\n      \"sumwy2\": " ;
+        jsonArray( out, data.sumwy2() ) ;
+      }
+      out << "\n    }" ;
+    }
+    out << "\n  ]\n}\n" ;
+    if( not out ) {
+      throw Exception( "BookStore::writeJSON: couldn't write file '" + fname + "'" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+#ifdef MARLIN_BOOK
+  namespace {
+    /// Get the bin edges of an axis, also for fixed binning
+    std::vector<double> rootEdges( const HistogramAxis &axis ) {
+      if( axis.variable() ) {
+        return axis.edges() ;
+      }
+      std::vector<double> edges( axis.nbins() + 1 ) ;
+      for( std::size_t i=0 ; i<=axis.nbins() ; ++i ) {
+        edges[i] = axis.min() + i * ( axis.max() - axis.min() ) / axis.nbins() ;
+      }
+      return edges ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void BookStore::writeROOT( const std::string &fname ) const {
+    std::unique_ptr<TFile> file( TFile::Open( fname.c_str(), "RECREATE" ) ) ;
+    if( nullptr == file or file->IsZombie() ) {
+      throw Exception( "BookStore::writeROOT: couldn't open file '" + fname + "'" ) ;
+    }
+    for( auto &entry : _histograms ) {
+      auto &histogram = entry.second ;
+      auto data = histogram->merged() ;
+      // create the directory structure from the histogram path
+      const auto pos = histogram->path().find_last_of( '/' ) ;
+      const auto name = ( std::string::npos == pos ) ? histogram->path() : histogram->path().substr( pos + 1 ) ;
+      TDirectory *directory = file.get() ;
+      if( std::string::npos != pos ) {
+        const auto dirName = histogram->path().substr( 0, pos ) ;
+        directory = file->GetDirectory( dirName.c_str() ) ;
+        if( nullptr == directory ) {
+          directory = file->mkdir( dirName.c_str() ) ;
+        }
+      }
+      directory->cd() ;
+      auto &xaxis = data.axes()[0] ;
+      std::unique_ptr<TH1> rootHistogram {nullptr} ;
+      if( HistogramType::H2 == data.type() ) {
+        auto &yaxis = data.axes()[1] ;
+        if( xaxis.variable() or yaxis.variable() ) {
+          const auto xedges = rootEdges( xaxis ) ;
+          const auto yedges = rootEdges( yaxis ) ;
+          rootHistogram.reset( new TH2D( name.c_str(), histogram->title().c_str(), xaxis.nbins(), xedges.data(), yaxis.nbins(), yedges.data() ) ) ;
+        }
+        else {
+          rootHistogram.reset( new TH2D( name.c_str(), histogram->title().c_str(), xaxis.nbins(), xaxis.min(), xaxis.max(), yaxis.nbins(), yaxis.min(), yaxis.max() ) ) ;
+        }
+      }
+      else if( HistogramType::Profile1 == data.type() ) {
+        auto profile = xaxis.variable() ?
+          new TProfile( name.c_str(), histogram->title().c_str(), xaxis.nbins(), xaxis.edges().data() ) :
+          new TProfile( name.c_str(), histogram->title().c_str(), xaxis.nbins(), xaxis.min(), xaxis.max() ) ;
+        rootHistogram.reset( profile ) ;
+        profile->Sumw2() ;
+        for( std::size_t i=0 ; i<data.sumw().size() ; ++i ) {
+          profile->SetBinEntries( i, data.sumw()[i] ) ;
+          profile->GetBinSumw2()->fArray[i] = data.sumw2()[i] ;
+          profile->TH1D::SetBinContent( i, data.sumwy()[i] ) ;
+          profile->GetSumw2()->fArray[i] = data.sumwy2()[i] ;
+        }
+      }
+      else {
+        rootHistogram = xaxis.variable() ?
+          std::unique_ptr<TH1>( new TH1D( name.c_str(), histogram->title().c_str(), xaxis.nbins(), xaxis.edges().data() ) ) :
+          std::unique_ptr<TH1>( new TH1D( name.c_str(), histogram->title().c_str(), xaxis.nbins(), xaxis.min(), xaxis.max() ) ) ;
+      }
+      if( HistogramType::Profile1 != data.type() ) {
+        rootHistogram->Sumw2() ;
+        for( std::size_t i=0 ; i<data.sumw().size() ; ++i ) {
+          rootHistogram->SetBinContent( i, data.sumw()[i] ) ;
+          rootHistogram->SetBinError( i, std::sqrt( data.sumw2()[i] ) ) ;
+        }
+      }
+      rootHistogram->SetEntries( data.entries() ) ;
+      rootHistogram->SetDirectory( nullptr ) ;
+      directory->WriteTObject( rootHistogram.get() ) ;
+    }
+    file->Close() ;
+  }
+#else
+  void BookStore::writeROOT( const std::string &fname ) const {
+    throw Exception( "BookStore::writeROOT: can't write '" + fname + "', Marlin was built without ROOT support (MARLIN_BOOK=OFF)" ) ;
+  }
+#endif
+
+
+}
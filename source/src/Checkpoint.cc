@@ -0,0 +1,75 @@
+#include <marlin/Checkpoint.h>
+
+// -- marlin headers
+#include <marlin/Exceptions.h>
+
+// -- std headers
+#include <fstream>
+#include <cstdio>
+
+namespace marlin {
+
+  Checkpoint Checkpoint::load( const std::string &fname ) {
+    std::ifstream file( fname ) ;
+    if( not file ) {
+      throw Exception( "Checkpoint::load: couldn't open file '" + fname + "'" ) ;
+    }
+    std::string magic ;
+    unsigned int version {0} ;
+    if( not ( file >> magic >> version ) or "MarlinCheckpoint" != magic ) {
+      throw Exception( "Checkpoint::load: invalid checkpoint file '" + fname + "'" ) ;
+    }
+    if( Version != version ) {
+      throw Exception( "Checkpoint::load: unsupported checkpoint file version in '" + fname + "'" ) ;
+    }
+    Checkpoint checkpoint {} ;
+    std::string kind ;
+    while( file >> kind ) {
+      bool valid = false ;
+      if( "W" == kind ) {
+        valid = static_cast<bool>( file >> checkpoint._watermark ) ;
+      }
+      else if( "S" == kind ) {
+        valid = static_cast<bool>( file >> checkpoint._randomSeed ) ;
+      }
+      else if( "P" == kind ) {
+        // the rest of the line, without the separating space
+        file.get() ;
+        valid = static_cast<bool>( std::getline( file, checkpoint._position ) ) ;
+      }
+      else if( "X" == kind ) {
+        std::string name ;
+        valid = static_cast<bool>( file >> name ) ;
+        file.get() ;
+        valid = valid and static_cast<bool>( std::getline( file, checkpoint._states[name] ) ) ;
+      }
+      if( not valid ) {
+        throw Exception( "Checkpoint::load: invalid checkpoint file '" + fname + "'" ) ;
+      }
+    }
+    return checkpoint ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Checkpoint::save( const std::string &fname ) const {
+    const std::string tmpname = fname + ".tmp" ;
+    std::ofstream file( tmpname ) ;
+    if( not file ) {
+      throw Exception( "Checkpoint::save: couldn't open file '" + tmpname + "'" ) ;
+    }
+    file << "MarlinCheckpoint " << Version << "\n" ;
+    file << "W " << _watermark << "\n" ;
+    file << "S " << _randomSeed << "\n" ;
+    file << "P " << _position << "\n" ;
+    for( auto &state : _states ) {
+      file << "X " << state.first << " " << state.second << "\n" ;
+    }
+    file.close() ;
+    if( not file or 0 != std::rename( tmpname.c_str(), fname.c_str() ) ) {
+      std::remove( tmpname.c_str() ) ;
+      throw Exception( "Checkpoint::save: couldn't write file '" + fname + "'" ) ;
+    }
+  }
+
+}
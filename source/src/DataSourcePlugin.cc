@@ -15,6 +15,7 @@ namespace marlin {
   //--------------------------------------------------------------------------
 
   void DataSourcePlugin::init( const Application *app ) {
+    _application = app ;
     _logger = app->createLogger( "Data source '" + _type + "'" ) ;
     setParameters( app->dataSourceParameters() ) ;
     logger()->log<MESSAGE>() << "----------------------------------------------------------" << std::endl ;
@@ -63,6 +64,67 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  void DataSourcePlugin::setEventFilter( EventFilter filter ) {
+    _eventFilter = filter ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t DataSourcePlugin::filteredEvents() const {
+    return _filteredEvents ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::string DataSourcePlugin::position() const {
+    throw Exception( "DataSourcePlugin::position: data source '" + type() + "' doesn't support checkpoints" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void DataSourcePlugin::resume( const std::string &/*pos*/ ) {
+    throw Exception( "DataSourcePlugin::resume: data source '" + type() + "' doesn't support checkpoints" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void DataSourcePlugin::setInputCollections( const InputCollections &collections ) {
+    _inputCollections = collections ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const InputCollections &DataSourcePlugin::inputCollections() const {
+    return _inputCollections ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool DataSourcePlugin::acceptEvent( const EventHeader &header ) {
+    if( nullptr == _eventFilter or _eventFilter( header ) ) {
+      return true ;
+    }
+    ++_filteredEvents ;
+    return false ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const Application &DataSourcePlugin::app() const {
+    if( nullptr == _application ) {
+      throw Exception( "DataSourcePlugin::app: plugin not initialized" ) ;
+    }
+    return *_application ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool DataSourcePlugin::hasEventFilter() const {
+    return ( nullptr != _eventFilter ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
   void DataSourcePlugin::processRunHeader( std::shared_ptr<RunHeader> rhdr ) {
     if( nullptr == _onRunHeaderRead ) {
       throw Exception( "DataSourcePlugin::processRunHeader: no callback function available" ) ;
@@ -0,0 +1,155 @@
+#include <marlin/EventArena.h>
+
+// -- marlin headers
+#include <marlin/WorkerLocal.h>
+
+// -- std headers
+#include <deque>
+#include <new>
+#include <algorithm>
+
+namespace marlin {
+
+  ArenaPool::~ArenaPool() {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    for( auto &block : _freeBlocks ) {
+      ::operator delete( block.second, std::align_val_t( BlockAlignment ) ) ;
+    }
+    _freeBlocks.clear() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t ArenaPool::sizeHint() const {
+    return _sizeHint.load() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ArenaPool::updateSizeHint( std::size_t usage ) {
+    // grow at once, shrink slowly
+    const std::size_t current = _sizeHint.load() ;
+    std::size_t hint = ( usage >= current ) ? usage : current - ( current - usage ) / 8 ;
+    // round up to the page size
+    hint = ( ( hint + 4095 ) / 4096 ) * 4096 ;
+    _sizeHint = std::max( hint, MinBlockSize ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t ArenaPool::cachedBlocks() const {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    return _freeBlocks.size() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  ArenaPool &ArenaPool::workerPool( std::size_t index ) {
+    static std::mutex poolsMutex ;
+    static std::deque<ArenaPool> pools ;
+    std::lock_guard<std::mutex> lock( poolsMutex ) ;
+    // the threads that are not workers share one pool
+    if( WorkerLocalBase::NoWorker == index ) {
+      static ArenaPool sharedPool ;
+      return sharedPool ;
+    }
+    while( pools.size() <= index ) {
+      pools.emplace_back() ;
+    }
+    return pools[ index ] ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void *ArenaPool::do_allocate( std::size_t bytes, std::size_t alignment ) {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    if( alignment <= BlockAlignment ) {
+      auto iter = _freeBlocks.lower_bound( bytes ) ;
+      if( _freeBlocks.end() != iter ) {
+        void *ptr = iter->second ;
+        _usedBlocks[ ptr ] = Block { iter->first, BlockAlignment } ;
+        _freeBlocks.erase( iter ) ;
+        return ptr ;
+      }
+    }
+    const std::size_t blockAlignment = std::max( alignment, BlockAlignment ) ;
+    void *ptr = ::operator new( bytes, std::align_val_t( blockAlignment ) ) ;
+    _usedBlocks[ ptr ] = Block { bytes, blockAlignment } ;
+    return ptr ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ArenaPool::do_deallocate( void *ptr, std::size_t /*bytes*/, std::size_t /*alignment*/ ) {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    auto iter = _usedBlocks.find( ptr ) ;
+    if( _usedBlocks.end() == iter ) {
+      return ;
+    }
+    const Block block = iter->second ;
+    _usedBlocks.erase( iter ) ;
+    if( block._alignment == BlockAlignment and _freeBlocks.size() < MaxCachedBlocks ) {
+      _freeBlocks.insert( { block._size, ptr } ) ;
+      return ;
+    }
+    ::operator delete( ptr, std::align_val_t( block._alignment ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool ArenaPool::do_is_equal( const std::pmr::memory_resource &other ) const noexcept {
+    return ( this == &other ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  EventArena::EventArena( ArenaPool &pool ) :
+    _pool(pool),
+    _resource(pool.sizeHint(), &pool) {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  EventArena::~EventArena() {
+    release() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void EventArena::release() {
+    if( 0 == _bytesAllocated ) {
+      return ;
+    }
+    _resource.release() ;
+    _pool.updateSizeHint( _bytesAllocated ) ;
+    _bytesAllocated = 0 ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t EventArena::bytesAllocated() const {
+    return _bytesAllocated ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void *EventArena::do_allocate( std::size_t bytes, std::size_t alignment ) {
+    _bytesAllocated += bytes ;
+    return _resource.allocate( bytes, alignment ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void EventArena::do_deallocate( void */*ptr*/, std::size_t /*bytes*/, std::size_t /*alignment*/ ) {
+    /* nop: memory is given back on release */
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool EventArena::do_is_equal( const std::pmr::memory_resource &other ) const noexcept {
+    return ( this == &other ) ;
+  }
+
+}
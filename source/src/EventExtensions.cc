@@ -51,4 +51,28 @@ namespace marlin {
     return _runtimeConditions->conditionIsTrue( name ) ;
   }
 
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  void CancellationExtension::cancel( const std::string &reason ) {
+    {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      _reason = reason ;
+    }
+    _cancelled = true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool CancellationExtension::cancelled() const {
+    return _cancelled.load( std::memory_order_relaxed ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::string CancellationExtension::reason() const {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    return _reason ;
+  }
+
 }
@@ -0,0 +1,150 @@
+#include <marlin/EventWatchdog.h>
+
+// -- marlin headers
+#include <marlin/EventExtensions.h>
+#include <marlin/Exceptions.h>
+
+// -- std headers
+#include <sstream>
+#include <chrono>
+
+namespace marlin {
+
+  EventWatchdog::EventWatchdog( std::size_t nslots, double eventBudget, Logger logger ) :
+    _eventBudget(eventBudget),
+    _logger(logger) {
+    if( 0 == nslots ) {
+      throw Exception( "EventWatchdog: number of slots must be > 0" ) ;
+    }
+    for( std::size_t i=0 ; i<nslots ; ++i ) {
+      _slots.push_back( std::unique_ptr<Slot>( new Slot() ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  EventWatchdog::~EventWatchdog() {
+    stop() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void EventWatchdog::start( double period ) {
+    if( _thread.joinable() ) {
+      throw Exception( "EventWatchdog::start: already running!" ) ;
+    }
+    if( period <= 0. ) {
+      throw Exception( "EventWatchdog::start: period must be > 0" ) ;
+    }
+    _period = period ;
+    _stopFlag = false ;
+    _thread = std::thread( &EventWatchdog::run, this ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void EventWatchdog::stop() {
+    {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      _stopFlag = true ;
+    }
+    _conditionVariable.notify_all() ;
+    if( _thread.joinable() ) {
+      _thread.join() ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void EventWatchdog::eventStarted( std::size_t slot, std::size_t uid, CancellationExtension *cancellation ) {
+    auto &s = *_slots.at( slot ) ;
+    std::lock_guard<std::mutex> lock( s._mutex ) ;
+    s._cancellation = cancellation ;
+    s._uid = uid ;
+    s._eventStart = clock::now() ;
+    s._processor = nullptr ;
+    s._processorBudget = 0. ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void EventWatchdog::processorStarted( std::size_t slot, const std::string &name, double budget ) {
+    auto &s = *_slots.at( slot ) ;
+    std::lock_guard<std::mutex> lock( s._mutex ) ;
+    s._processor = &name ;
+    s._processorStart = clock::now() ;
+    s._processorBudget = budget ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void EventWatchdog::eventFinished( std::size_t slot ) {
+    auto &s = *_slots.at( slot ) ;
+    std::lock_guard<std::mutex> lock( s._mutex ) ;
+    if( nullptr != s._cancellation and s._cancellation->cancelled() ) {
+      _logger->log<WARNING>() << "Event uid " << s._uid << " cancelled after "
+                              << clock::elapsed_since( s._eventStart ) << " s" << std::endl ;
+    }
+    s._cancellation = nullptr ;
+    s._processor = nullptr ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t EventWatchdog::nCancelled() const {
+    return _nCancelled.load() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void EventWatchdog::run() {
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( _period ) ) ;
+    std::unique_lock<std::mutex> lock( _mutex ) ;
+    while( not _stopFlag ) {
+      _conditionVariable.wait_for( lock, period, [this]() {
+        return _stopFlag ;
+      }) ;
+      if( _stopFlag ) {
+        break ;
+      }
+      lock.unlock() ;
+      check() ;
+      lock.lock() ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void EventWatchdog::check() {
+    const auto now = clock::now() ;
+    for( auto &slot : _slots ) {
+      auto &s = *slot ;
+      std::lock_guard<std::mutex> lock( s._mutex ) ;
+      if( nullptr == s._cancellation or s._cancellation->cancelled() ) {
+        continue ;
+      }
+      std::stringstream reason ;
+      const auto eventTime = clock::time_difference( s._eventStart, now ) ;
+      if( nullptr != s._processor and s._processorBudget > 0. ) {
+        const auto processorTime = clock::time_difference( s._processorStart, now ) ;
+        if( processorTime > s._processorBudget ) {
+          reason << "processor " << *s._processor << " exceeded its time budget ("
+                 << processorTime << " s > " << s._processorBudget << " s)" ;
+        }
+      }
+      if( reason.str().empty() and _eventBudget > 0. and eventTime > _eventBudget ) {
+        reason << "event time budget exceeded (" << eventTime << " s > " << _eventBudget << " s)" ;
+        if( nullptr != s._processor ) {
+          reason << " in processor " << *s._processor ;
+        }
+      }
+      if( reason.str().empty() ) {
+        continue ;
+      }
+      s._cancellation->cancel( reason.str() ) ;
+      ++ _nCancelled ;
+      _logger->log<WARNING>() << "Event uid " << s._uid << ": " << reason.str() << ", cancellation requested" << std::endl ;
+    }
+  }
+
+}
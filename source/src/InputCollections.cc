@@ -0,0 +1,71 @@
+#include <marlin/InputCollections.h>
+
+namespace marlin {
+
+  void InputCollections::addCollections( const std::string &processor, const std::vector<std::string> &names ) {
+    _declaredProcessors.insert( processor ) ;
+    for( auto &name : names ) {
+      if( not name.empty() ) {
+        _names.insert( name ) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void InputCollections::addAllCollections( const std::string &processor, const NameSet &exceptNames, const NameSet &exceptTypes ) {
+    _declaredProcessors.insert( processor ) ;
+    _allCollections.push_back( { exceptNames, exceptTypes } ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void InputCollections::addProcessor( const std::string &processor ) {
+    _processors.insert( processor ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  InputCollections::NameSet InputCollections::undeclaredProcessors() const {
+    NameSet undeclared ;
+    for( auto &processor : _processors ) {
+      if( _declaredProcessors.end() == _declaredProcessors.find( processor ) ) {
+        undeclared.insert( processor ) ;
+      }
+    }
+    return undeclared ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool InputCollections::empty() const {
+    return ( _names.empty() and _allCollections.empty() ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool InputCollections::allCollections() const {
+    return not _allCollections.empty() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const InputCollections::NameSet &InputCollections::names() const {
+    return _names ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool InputCollections::isUsed( const std::string &name, const std::string &type ) const {
+    if( _names.end() != _names.find( name ) ) {
+      return true ;
+    }
+    for( auto &all : _allCollections ) {
+      if( all._exceptNames.end() == all._exceptNames.find( name ) and all._exceptTypes.end() == all._exceptTypes.find( type ) ) {
+        return true ;
+      }
+    }
+    return false ;
+  }
+
+}
@@ -3,9 +3,12 @@
 // -- std headers
 #include <dlfcn.h>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <cstdlib>
 #include <algorithm>
 #include <set>
+#include <sys/stat.h>
 
 // -- marlin headers
 #include <marlin/Utils.h>
@@ -25,6 +28,27 @@ namespace marlin {
   void PluginManager::registerPlugin( PluginType type, const std::string &name,
     FactoryFunction factoryFunction, bool ignoreDuplicate ) {
     lock_type lock( _mutex ) ;
+    insertFactory( type, name, factoryFunction, ignoreDuplicate, _currentLibrary ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void PluginManager::registerPlugin( PluginType type, NameFunction nameFunction,
+    FactoryFunction factoryFunction, bool ignoreDuplicate ) {
+    lock_type lock( _mutex ) ;
+    PendingPlugin plugin ;
+    plugin._type = type ;
+    plugin._nameFunction = nameFunction ;
+    plugin._factoryFunction = factoryFunction ;
+    plugin._ignoreDuplicate = ignoreDuplicate ;
+    plugin._library = _currentLibrary ;
+    _pendingPlugins.push_back( plugin ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void PluginManager::insertFactory( PluginType type, const std::string &name,
+    FactoryFunction factoryFunction, bool ignoreDuplicate, const std::string &library ) const {
     auto typeIter = _pluginFactories.find( type ) ;
     auto factoryIter = typeIter->second.find( name ) ;
     if ( typeIter->second.end() != factoryIter ) {
@@ -36,6 +60,9 @@ namespace marlin {
     }
     else {
       typeIter->second.insert( FactoryMap::value_type( name, factoryFunction ) ) ;
+      if ( not library.empty() ) {
+        _pluginLibraries[ type ][ name ] = library ;
+      }
       auto typeStr = pluginTypeToString( type ) ;
       _logger->log<DEBUG5>() << "New plugin registered: type '" << typeStr << "', name '" << name << "'" <<std::endl ;
     }
@@ -43,8 +70,88 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  void PluginManager::resolvePendingPlugins() const {
+    // insert all the pending plugins before reporting the errors, so that
+    // a duplicate entry doesn't drop the plugins registered after it
+    std::vector<std::string> errors ;
+    while ( not _pendingPlugins.empty() ) {
+      // move out first: the name functions may register plugins too
+      PendingPluginList pendingPlugins ;
+      pendingPlugins.swap( _pendingPlugins ) ;
+      for ( auto &plugin : pendingPlugins ) {
+        try {
+          insertFactory( plugin._type, plugin._nameFunction(), plugin._factoryFunction, plugin._ignoreDuplicate, plugin._library ) ;
+        }
+        catch ( const std::exception &e ) {
+          errors.push_back( e.what() ) ;
+        }
+      }
+    }
+    if ( not errors.empty() ) {
+      throw Exception( "PluginManager::resolvePendingPlugins: " + StringUtil::join( errors, ", " ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool PluginManager::resolvePendingPlugin( PluginType type, const std::string &name ) const {
+    std::vector<std::string> errors ;
+    bool found = false ;
+    while ( not found and not _pendingPlugins.empty() ) {
+      // move out first: the name function may register plugins too
+      auto plugin = _pendingPlugins.front() ;
+      _pendingPlugins.erase( _pendingPlugins.begin() ) ;
+      try {
+        const auto pluginName = plugin._nameFunction() ;
+        found = ( plugin._type == type and pluginName == name ) ;
+        insertFactory( plugin._type, pluginName, plugin._factoryFunction, plugin._ignoreDuplicate, plugin._library ) ;
+      }
+      catch ( const std::exception &e ) {
+        errors.push_back( e.what() ) ;
+      }
+    }
+    if ( not errors.empty() ) {
+      throw Exception( "PluginManager::resolvePendingPlugin: " + StringUtil::join( errors, ", " ) ) ;
+    }
+    return found ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  PluginManager::FactoryFunction PluginManager::findFactory( PluginType type, const std::string &name ) const {
+    auto &factories = _pluginFactories.find( type )->second ;
+    auto factoryIter = factories.find( name ) ;
+    if ( factories.end() != factoryIter ) {
+      return factoryIter->second ;
+    }
+    // plugin provided by a library not loaded yet ?
+    auto &libraries = _pluginLibraries[ type ] ;
+    auto libraryIter = libraries.find( name ) ;
+    if ( libraries.end() != libraryIter ) {
+      auto lazyIter = std::find( _lazyLibraries.begin(), _lazyLibraries.end(), libraryIter->second ) ;
+      if ( _lazyLibraries.end() != lazyIter ) {
+        auto library = *lazyIter ;
+        _lazyLibraries.erase( lazyIter ) ;
+        if ( not loadLibrary( library ) ) {
+          throw Exception( "PluginManager: couldn't load library '" + library + "' providing plugin '" + name + "'" ) ;
+        }
+      }
+    }
+    // only instantiate the pending processors registered before this one
+    resolvePendingPlugin( type, name ) ;
+    factoryIter = factories.find( name ) ;
+    if ( factories.end() != factoryIter ) {
+      return factoryIter->second ;
+    }
+    return nullptr ;
+  }
+
+  //--------------------------------------------------------------------------
+
   std::vector<std::string> PluginManager::pluginNames( PluginType type ) const {
     lock_type lock( _mutex ) ;
+    loadAllLibraries() ;
+    resolvePendingPlugins() ;
     std::vector<std::string> names ;
     auto typeIter = _pluginFactories.find( type ) ;
     for ( auto iter : typeIter->second ) {
@@ -57,8 +164,7 @@ namespace marlin {
 
   bool PluginManager::pluginRegistered( PluginType type, const std::string &name ) const {
     lock_type lock( _mutex ) ;
-    auto typeIter = _pluginFactories.find( type ) ;
-    return ( typeIter->second.find( name ) != typeIter->second.end() ) ;
+    return ( nullptr != findFactory( type, name ) ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -70,7 +176,7 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
-  bool PluginManager::loadLibraries( const std::string &envvar ) {
+  bool PluginManager::loadLibraries( const std::string &envvar, const std::string &manifestvar ) {
     lock_type lock( _mutex ) ;
     char *marlinDll = getenv( envvar.c_str() );
     if ( nullptr == marlinDll ) {
@@ -85,28 +191,165 @@ namespace marlin {
       size_t idx = library.find_last_of("/") ;
       // the library basename, i.e. /path/to/libBlah.so --> libBlah.so
       std::string libBaseName( library.substr( idx + 1 ) );
-      _logger->log<DEBUG5>() << "<!-- Loading shared library : " << library << " -->" << std::endl ;
       auto inserted = checkDuplicateLibs.insert( libBaseName ).second ;
       if ( not inserted ) {
         _logger->log<ERROR>() << std::endl << "<!-- ERROR loading shared library : " << library << std::endl
             << "    ->    Trying to load DUPLICATE library -->" << std::endl << std::endl ;
         return false ;
       }
-      void* libPointer = dlopen( library.c_str() , RTLD_LAZY | RTLD_GLOBAL) ;
-      if( nullptr == libPointer ) {
-        _logger->log<ERROR>() << std::endl << "<!-- ERROR loading shared library : " << library << std::endl
-                    << "    ->    "   << dlerror() << " -->" << std::endl << std::endl ;
+    }
+    // lazy loading from the plugin manifest
+    char *manifest = getenv( manifestvar.c_str() ) ;
+    if ( nullptr != manifest and readManifest( manifest, libraries ) ) {
+      _logger->log<DEBUG5>() << "Using plugin manifest " << manifest << ": libraries loaded on demand" << std::endl ;
+      // libraries without plugin are loaded right away
+      std::set<std::string> pluginLibraries ;
+      for ( auto &typeIter : _pluginLibraries ) {
+        for ( auto &iter : typeIter.second ) {
+          pluginLibraries.insert( iter.second ) ;
+        }
+      }
+      for ( auto library : libraries ) {
+        if ( pluginLibraries.find( library ) != pluginLibraries.end() ) {
+          _lazyLibraries.push_back( library ) ;
+        }
+        else if ( not loadLibrary( library ) ) {
+          return false ;
+        }
+      }
+      return true ;
+    }
+    for ( auto library : libraries ) {
+      if ( not loadLibrary( library ) ) {
         return false ;
       }
-      _libraries.push_back( libPointer ) ;
     }
     return true ;
   }
 
   //--------------------------------------------------------------------------
 
+  bool PluginManager::loadLibrary( const std::string &library ) const {
+    _logger->log<DEBUG5>() << "<!-- Loading shared library : " << library << " -->" << std::endl ;
+    _currentLibrary = library ;
+    void* libPointer = dlopen( library.c_str() , RTLD_LAZY | RTLD_GLOBAL) ;
+    _currentLibrary.clear() ;
+    if( nullptr == libPointer ) {
+      _logger->log<ERROR>() << std::endl << "<!-- ERROR loading shared library : " << library << std::endl
+                  << "    ->    "   << dlerror() << " -->" << std::endl << std::endl ;
+      return false ;
+    }
+    _libraries.push_back( libPointer ) ;
+    _libraryNames.push_back( library ) ;
+    // the plugins registered without name stay pending until queried:
+    // loading a library never instantiates its processors
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void PluginManager::loadAllLibraries() const {
+    auto libraries = std::move( _lazyLibraries ) ;
+    _lazyLibraries.clear() ;
+    for ( auto &library : libraries ) {
+      if ( not loadLibrary( library ) ) {
+        throw Exception( "PluginManager: couldn't load library '" + library + "'" ) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool PluginManager::readManifest( const std::string &fname, const std::vector<std::string> &libraries ) {
+    std::ifstream file( fname ) ;
+    if ( not file ) {
+      _logger->log<WARNING>() << "Couldn't open plugin manifest " << fname << ". Loading all libraries" << std::endl ;
+      return false ;
+    }
+    std::set<std::string> manifestLibraries ;
+    PluginLibraryMap pluginLibraries ;
+    std::string line ;
+    while ( std::getline( file, line ) ) {
+      if ( line.empty() or line[0] == '#' ) {
+        continue ;
+      }
+      std::istringstream iss( line ) ;
+      std::string token ;
+      iss >> token ;
+      // library <size> <mtime> <path>
+      if ( token == "library" ) {
+        long long int size = 0, mtime = 0 ;
+        std::string library ;
+        iss >> size >> mtime >> std::ws ;
+        std::getline( iss, library ) ;
+        struct stat st ;
+        if ( 0 != ::stat( library.c_str(), &st ) or st.st_size != size or st.st_mtime != mtime ) {
+          _logger->log<WARNING>() << "Plugin manifest " << fname << " is out of date (" << library
+            << "). Loading all libraries. Regenerate it with MarlinDumpPlugins" << std::endl ;
+          return false ;
+        }
+        manifestLibraries.insert( library ) ;
+      }
+      // plugin <type> <name> <path>
+      else if ( token == "plugin" ) {
+        std::string type, name, library ;
+        iss >> type >> name >> std::ws ;
+        std::getline( iss, library ) ;
+        try {
+          pluginLibraries[ stringToPluginType( type ) ][ name ] = library ;
+        }
+        catch ( Exception &e ) {
+          _logger->log<WARNING>() << "Invalid plugin manifest " << fname << ": " << e.what() << ". Loading all libraries" << std::endl ;
+          return false ;
+        }
+      }
+    }
+    std::set<std::string> dllLibraries ( libraries.begin(), libraries.end() ) ;
+    if ( dllLibraries != manifestLibraries ) {
+      _logger->log<WARNING>() << "Plugin manifest " << fname << " doesn't match the list of libraries. "
+        << "Loading all libraries. Regenerate it with MarlinDumpPlugins" << std::endl ;
+      return false ;
+    }
+    for ( auto &typeIter : pluginLibraries ) {
+      for ( auto &iter : typeIter.second ) {
+        _pluginLibraries[ typeIter.first ].insert( iter ) ;
+      }
+    }
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void PluginManager::writeManifest( const std::string &fname ) const {
+    lock_type lock( _mutex ) ;
+    loadAllLibraries() ;
+    resolvePendingPlugins() ;
+    std::ofstream file( fname ) ;
+    if ( not file ) {
+      throw Exception( "PluginManager::writeManifest: couldn't open file '" + fname + "'" ) ;
+    }
+    file << "# Marlin plugin manifest. Generated by MarlinDumpPlugins" << std::endl ;
+    for ( auto &library : _libraryNames ) {
+      struct stat st ;
+      if ( 0 != ::stat( library.c_str(), &st ) ) {
+        throw Exception( "PluginManager::writeManifest: couldn't stat library '" + library + "'" ) ;
+      }
+      file << "library " << st.st_size << " " << st.st_mtime << " " << library << std::endl ;
+    }
+    for ( auto &typeIter : _pluginLibraries ) {
+      auto typeStr = pluginTypeToString( typeIter.first ) ;
+      for ( auto &iter : typeIter.second ) {
+        file << "plugin " << typeStr << " " << iter.first << " " << iter.second << std::endl ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
   void PluginManager::dump() const {
     lock_type lock( _mutex ) ;
+    loadAllLibraries() ;
+    resolvePendingPlugins() ;
     _logger->log<MESSAGE>() << "------------------------------------" << std::endl ;
     _logger->log<MESSAGE>() << " ** Marlin plugin manager dump ** " << std::endl ;
     for ( auto pluginIter : _pluginFactories ) {
@@ -137,6 +380,15 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  PluginType PluginManager::stringToPluginType( const std::string &str ) {
+    if ( str == "Processor" ) return PluginType::Processor ;
+    if ( str == "GeometryPlugin" ) return PluginType::GeometryPlugin ;
+    if ( str == "DataSource" ) return PluginType::DataSource ;
+    throw Exception( "PluginManager: unknown plugin type '" + str + "'" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
   PluginManager::Logger PluginManager::logger() const {
     return _logger ;
   }
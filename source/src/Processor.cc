@@ -3,6 +3,7 @@
 // -- marlin headers
 // #include "marlin/PluginManager.h"
 #include "marlin/Application.h"
+#include "marlin/WorkerLocal.h"
 
 namespace marlin {
 
@@ -127,6 +128,60 @@ namespace marlin {
   //--------------------------------------------------------------------------
 
   void Processor::baseInit( Application *application ) {
+    baseSetup( application ) ;
+    log<DEBUG2>() << "Processor " << name() << ": init ..." << std::endl ;
+    init() ;
+    // declare the input collections, the data source may read only them.
+    // Without input collection parameter, the processor must declare its
+    // inputs with the ProcessorApi, else it may use any collection
+    _application->registerInputProcessor( name() ) ;
+    bool declared {false} ;
+    std::vector<std::string> inputCollections ;
+    for( auto iter = pbegin() ; iter != pend() ; ++iter ) {
+      if( isInputCollectionName( iter->second->name() ) ) {
+        auto names = StringUtil::split<std::string>( iter->second->value() ) ;
+        inputCollections.insert( inputCollections.end(), names.begin(), names.end() ) ;
+        declared = true ;
+      }
+    }
+    if( declared ) {
+      _application->registerInputCollections( name(), inputCollections ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::shared_ptr<Processor> Processor::baseClone() const {
+    auto replica = clone() ;
+    if( nullptr == replica ) {
+      return nullptr ;
+    }
+    if( replica.get() == this or replica->type() != type() ) {
+      throw Exception( "Processor::baseClone: processor '" + name() + "' returned an invalid replica" ) ;
+    }
+    replica->setParameters( _parameters ) ;
+    replica->baseSetup( _application ) ;
+    // init() is not called on the replica: redo the per instance registrations
+    auto &seedManager = _application->randomSeedManager() ;
+    if( seedManager.hasEntry( this ) ) {
+      seedManager.addEntry( replica.get() ) ;
+    }
+    log<DEBUG2>() << "Processor " << name() << ": replica created" << std::endl ;
+    return replica ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Processor::baseEnd() {
+    for( auto &storage : _workerLocals ) {
+      storage.second->reduce() ;
+    }
+    end() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Processor::baseSetup( Application *application ) {
     _application = application ;
     _logger = app().createLogger( name() ) ;
     log<DEBUG2>() << "Creating logger for processor " << name() << std::endl ;
@@ -134,8 +189,6 @@ namespace marlin {
       _logLevelName = getParameter<std::string>("Verbosity") ;
       _logger->setLevel( _logLevelName ) ;
     }
-    log<DEBUG2>() << "Processor " << name() << ": init ..." << std::endl ;
-    init() ;
   }
 
   //--------------------------------------------------------------------------
@@ -14,6 +14,30 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  void ProcessorApi::registerEventFilter( Processor *const proc, EventFilter filter ) {
+    proc->app().registerEventFilter( proc->name(), filter ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ProcessorApi::requireCollections( Processor *const proc, const std::vector<std::string> &names ) {
+    proc->app().registerInputCollections( proc->name(), names ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ProcessorApi::requireAllCollections( Processor *const proc, const std::set<std::string> &exceptNames, const std::set<std::string> &exceptTypes ) {
+    proc->app().registerAllInputCollections( proc->name(), exceptNames, exceptTypes ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ProcessorApi::registerCheckpoint( Processor *const proc, Checkpoint::SaveFunction save, Checkpoint::RestoreFunction restore ) {
+    proc->app().registerCheckpoint( proc->name(), save, restore ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
   unsigned int ProcessorApi::getRandomSeed( const Processor *const proc, EventStore *event ) {
     auto randomSeeds = event->extensions().get<extensions::RandomSeed, RandomSeedExtension>() ;
     if( nullptr == randomSeeds ) {
@@ -57,9 +81,66 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  void ProcessorApi::skipEvent( const Processor *const proc, EventStore *event ) {
+    proc->log<DEBUG>() << "Skipping event uid " << event->uid() << std::endl ;
+    event->requestSkip() ;
+  }
+
+  //--------------------------------------------------------------------------
+
   void ProcessorApi::abort( const Processor *const proc, const std::string &reason ) {
     proc->log<WARNING>() << "Stopping application: " << reason << std::endl ;
     MARLIN_STOP_PROCESSING( proc ) ;
   }
 
+  //--------------------------------------------------------------------------
+
+  bool ProcessorApi::cancelled( EventStore *event ) {
+    auto cancellation = event->extensions().get<extensions::Cancellation, CancellationExtension>() ;
+    return ( nullptr != cancellation ) && cancellation->cancelled() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ProcessorApi::checkCancelled( const Processor *const proc, EventStore *event ) {
+    auto cancellation = event->extensions().get<extensions::Cancellation, CancellationExtension>() ;
+    if( nullptr == cancellation or not cancellation->cancelled() ) {
+      return ;
+    }
+    proc->log<WARNING>() << "Skipping cancelled event uid " << event->uid() << ": " << cancellation->reason() << std::endl ;
+    throw SkipEventException( proc->name() + " (time budget exceeded)" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  Histogram1D &ProcessorApi::book1D( Processor *const proc, const std::string &name, const std::string &title, const HistogramAxis &axis ) {
+    return proc->app().bookStore().book1D( proc->name() + "/" + name, title, axis ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  Histogram2D &ProcessorApi::book2D( Processor *const proc, const std::string &name, const std::string &title, const HistogramAxis &xaxis, const HistogramAxis &yaxis ) {
+    return proc->app().bookStore().book2D( proc->name() + "/" + name, title, xaxis, yaxis ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  Profile1D &ProcessorApi::bookProfile1D( Processor *const proc, const std::string &name, const std::string &title, const HistogramAxis &axis ) {
+    return proc->app().bookStore().bookProfile1D( proc->name() + "/" + name, title, axis ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::unique_ptr<concurrency::TaskGroup> ProcessorApi::spawn( const Processor *const proc, std::function<void()> fn ) {
+    std::unique_ptr<concurrency::TaskGroup> group( new concurrency::TaskGroup( proc->app().taskQueue() ) ) ;
+    group->run( fn ) ;
+    return group ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::pmr::memory_resource *ProcessorApi::eventArena( EventStore *event ) {
+    return &event->arena() ;
+  }
+
 }
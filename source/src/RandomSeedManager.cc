@@ -17,6 +17,7 @@ namespace marlin {
   //--------------------------------------------------------------------------
 
   void RandomSeedManager::addEntry( HashResult entry ) {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
     bool inserted = _entryList.insert( entry ).second ;
     if ( not inserted ) {
       throw Exception("RandomSeedManager: Entry '" + std::to_string(entry) + "' already registered !") ;
@@ -32,12 +33,21 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  bool RandomSeedManager::hasEntry( HashArgument arg ) const {
+    HashFunction hashf ;
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    return ( _entryList.end() != _entryList.find( hashf(arg) ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
   std::unique_ptr<RandomSeedManager::RandomSeedMap>
   RandomSeedManager::generateRandomSeeds( const EventStore * const evt ) {
     // get hashed seed using jenkins_hash
     unsigned int seed = 0 ; // initial state
     // unsigned int eventNumber = evt->getEventNumber() ;
     // unsigned int runNumber = evt->getRunNumber() ;
+    seed = jenkins_hash( (unsigned char *) &_globalSeed, sizeof _globalSeed, seed) ;
     auto uid = evt->uid() ;
     unsigned char * c = (unsigned char *) &uid ;
     // seed = jenkins_hash( c, sizeof eventNumber, seed) ;
@@ -47,6 +57,7 @@ namespace marlin {
     seed = jenkins_hash( c, sizeof _globalSeed, seed) ;
     // refresh the seed
     _generator.seed( seed ) ;
+    std::lock_guard<std::mutex> lock( _mutex ) ;
     std::unique_ptr<RandomSeedMap> seedMap( new RandomSeedMap() ) ;
     // fill map with seeds for each entry using random number generator
     for (auto iter : _entryList ) {
@@ -57,6 +68,19 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  RandomSeedManager::SeedType RandomSeedManager::globalSeed() const {
+    return _globalSeed ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void RandomSeedManager::setGlobalSeed( SeedType seed ) {
+    _globalSeed = seed ;
+    _generator.seed( seed ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
   RandomSeedManager::SeedType RandomSeedManager::getRandom() {
     return static_cast<SeedType>(_rdmDistribution(_generator)) ;
   }
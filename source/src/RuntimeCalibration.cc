@@ -0,0 +1,182 @@
+#include <marlin/RuntimeCalibration.h>
+
+// -- marlin headers
+#include <marlin/Exceptions.h>
+#include <marlin/tinyxml.h>
+
+// -- std headers
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <unistd.h>
+
+namespace marlin {
+
+  RuntimeCalibration::RuntimeCalibration( const Settings &settings ) :
+    _settings(settings) {
+    if( 0 == _settings._concurrency ) {
+      throw Exception( "RuntimeCalibration: concurrency must be > 0" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void RuntimeCalibration::addMeasurement( const Measurement &measurement ) {
+    _measurements.push_back( measurement ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::vector<RuntimeCalibration::Measurement> &RuntimeCalibration::measurements() const {
+    return _measurements ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  double RuntimeCalibration::eventTime() const {
+    double time = 0. ;
+    for( auto &m : _measurements ) {
+      if( m._events > 0 ) {
+        time += m._appTime / m._events ;
+      }
+    }
+    return time ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  RuntimeCalibration::Options RuntimeCalibration::propose( const Measurement &measurement ) const {
+    Options options {} ;
+    options._clone = measurement._clone ;
+    options._critical = measurement._critical ;
+    const double eventT = eventTime() ;
+    if( 0 == measurement._events or eventT <= 0. ) {
+      options._reason = "no measurement, options unchanged" ;
+      return options ;
+    }
+    const double procT = measurement._procTime / measurement._events ;
+    const double load = _settings._concurrency * procT / eventT ;
+    const double lockFraction = ( measurement._appTime > 0. ) ? ( measurement._appTime - measurement._procTime ) / measurement._appTime : 0. ;
+    const double savedMemory = ( _settings._concurrency - 1 ) * measurement._instanceMemory ;
+    std::stringstream reason ;
+    reason << std::setprecision(3) ;
+    if( measurement._clone and not measurement._cloneForced and _settings._concurrency > 1 ) {
+      if( measurement._critical ) {
+        options._clone = false ;
+        reason << "critical clones are serialized anyway, share one instance (saves "
+               << savedMemory / (1024.*1024.) << " MB)" ;
+        options._reason = reason.str() ;
+        return options ;
+      }
+      if( not measurement._criticalForced
+        and measurement._instanceMemory >= _settings._minInstanceMemory
+        and load <= _settings._maxCriticalLoad ) {
+        options._clone = false ;
+        options._critical = true ;
+        reason << "share one critical instance: saves " << savedMemory / (1024.*1024.)
+               << " MB for a serialized load of " << load * 100. << " %" ;
+        options._reason = reason.str() ;
+        return options ;
+      }
+    }
+    reason << "options unchanged" ;
+    if( measurement._critical and ( load > _settings._maxCriticalLoad or lockFraction > _settings._maxLockFraction ) ) {
+      reason << ", critical section is a bottleneck (load: " << load * 100. << " %, lock: "
+             << lockFraction * 100. << " %), consider making the processor thread safe" ;
+    }
+    options._reason = reason.str() ;
+    return options ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  RuntimeCalibration::OptionsMap RuntimeCalibration::proposeAll() const {
+    OptionsMap options {} ;
+    for( auto &m : _measurements ) {
+      options[ m._name ] = propose( m ) ;
+    }
+    return options ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void RuntimeCalibration::writeSteeringPatch( const std::string &fname, const OptionsMap &options ) const {
+    std::ofstream file( fname ) ;
+    if( not file ) {
+      throw Exception( "RuntimeCalibration::writeSteeringPatch: couldn't open file '" + fname + "'" ) ;
+    }
+    const double eventT = eventTime() ;
+    file << std::setprecision(3) ;
+    file << "<!-- Processor runtime options proposed by a calibration run -->" << std::endl
+         << "<!-- Concurrency: " << _settings._concurrency << ", mean event time: " << eventT << " s -->" << std::endl
+         << "<!-- Copy the processor parameters in your steering file or set them to \"auto\" -->" << std::endl
+         << "<marlin>" << std::endl ;
+    for( auto &m : _measurements ) {
+      auto iter = options.find( m._name ) ;
+      if( options.end() == iter ) {
+        continue ;
+      }
+      const double procT = ( m._events > 0 ) ? m._procTime / m._events : 0. ;
+      const double lockFraction = ( m._appTime > 0. ) ? ( m._appTime - m._procTime ) / m._appTime : 0. ;
+      const double load = ( eventT > 0. ) ? _settings._concurrency * procT / eventT : 0. ;
+      file << " <processor name=\"" << m._name << "\">" << std::endl
+           << "  <!-- " << procT << " s/evt, lock: " << lockFraction * 100. << " %, load: " << load * 100.
+           << " %, memory: " << m._instanceMemory / (1024.*1024.) << " MB/instance -->" << std::endl
+           << "  <!-- " << iter->second._reason << " -->" << std::endl
+           << "  <parameter name=\"ProcessorClone\"> " << ( iter->second._clone ? "true" : "false" ) << " </parameter>" << std::endl
+           << "  <parameter name=\"ProcessorCritical\"> " << ( iter->second._critical ? "true" : "false" ) << " </parameter>" << std::endl
+           << " </processor>" << std::endl ;
+    }
+    file << "</marlin>" << std::endl ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  RuntimeCalibration::OptionsMap RuntimeCalibration::readSteeringPatch( const std::string &fname ) {
+    TiXmlDocument document ;
+    if( not document.LoadFile( fname ) ) {
+      throw Exception( "RuntimeCalibration::readSteeringPatch: couldn't load file '" + fname + "': " + document.ErrorDesc() ) ;
+    }
+    auto root = document.RootElement() ;
+    if( nullptr == root ) {
+      throw Exception( "RuntimeCalibration::readSteeringPatch: no root element in file '" + fname + "'" ) ;
+    }
+    OptionsMap options {} ;
+    for( auto proc = root->FirstChildElement( "processor" ) ; proc ; proc = proc->NextSiblingElement( "processor" ) ) {
+      auto name = proc->Attribute( "name" ) ;
+      if( nullptr == name ) {
+        throw Exception( "RuntimeCalibration::readSteeringPatch: processor without name in file '" + fname + "'" ) ;
+      }
+      Options opts {} ;
+      for( auto param = proc->FirstChildElement( "parameter" ) ; param ; param = param->NextSiblingElement( "parameter" ) ) {
+        auto pname = param->Attribute( "name" ) ;
+        auto text = param->GetText() ;
+        if( nullptr == pname or nullptr == text ) {
+          continue ;
+        }
+        std::string value ;
+        std::stringstream( text ) >> value ;
+        if( std::string( "ProcessorClone" ) == pname ) {
+          opts._clone = ( "true" == value ) ;
+        }
+        else if( std::string( "ProcessorCritical" ) == pname ) {
+          opts._critical = ( "true" == value ) ;
+        }
+      }
+      options[ name ] = opts ;
+    }
+    return options ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t RuntimeCalibration::residentMemory() {
+    std::ifstream statm( "/proc/self/statm" ) ;
+    std::size_t size = 0, resident = 0 ;
+    if( not ( statm >> size >> resident ) ) {
+      return 0 ;
+    }
+    return resident * static_cast<std::size_t>( ::sysconf( _SC_PAGESIZE ) ) ;
+  }
+
+}
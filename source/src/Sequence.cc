@@ -6,9 +6,65 @@
 #include <marlin/EventExtensions.h>
 #include <marlin/StringParameters.h>
 #include <marlin/PluginManager.h>
+#include <marlin/Application.h>
+#include <marlin/WorkerLocal.h>
+#include <marlin/concurrency/TaskGroup.h>
 
 // -- std headers
 #include <algorithm>
+#include <exception>
+#include <numeric>
+#include <fstream>
+
+namespace {
+
+  /**
+   *  @brief  Run a function on the given item indices, as tasks of the task
+   *  queue. The calling thread helps while waiting, so that all items are
+   *  processed even without any idle pool worker. Without task queue, the
+   *  items are processed in order by the calling thread. The tasks run outside
+   *  of any worker slot. All items are processed, even on failure. The first
+   *  exception in the item order is re-thrown at the end, so that the error
+   *  reported does not depend on the thread scheduling
+   *
+   *  @param  queue the task queue (nullptr: serial processing)
+   *  @param  indices the item indices to process
+   *  @param  function the function to call on each item index
+   */
+  template <typename FUNCTION>
+  void runConcurrently( marlin::concurrency::TaskQueue *queue, const std::vector<std::size_t> &indices, FUNCTION function ) {
+    std::vector<std::exception_ptr> exceptions ( indices.size(), nullptr ) ;
+    auto runner = [&]( std::size_t i ) {
+      const auto worker = marlin::WorkerLocalBase::currentWorkerIndex() ;
+      marlin::WorkerLocalBase::setCurrentWorkerIndex( marlin::WorkerLocalBase::NoWorker ) ;
+      try {
+        function( indices[i] ) ;
+      }
+      catch( ... ) {
+        exceptions[i] = std::current_exception() ;
+      }
+      marlin::WorkerLocalBase::setCurrentWorkerIndex( worker ) ;
+    };
+    if( nullptr != queue and indices.size() > 1 ) {
+      marlin::concurrency::TaskGroup group ( *queue ) ;
+      for( std::size_t i=0 ; i<indices.size() ; ++i ) {
+        group.run( [&runner,i](){ runner( i ) ; } ) ;
+      }
+      group.wait() ;
+    }
+    else {
+      for( std::size_t i=0 ; i<indices.size() ; ++i ) {
+        runner( i ) ;
+      }
+    }
+    for( auto &exception : exceptions ) {
+      if( nullptr != exception ) {
+        std::rethrow_exception( exception ) ;
+      }
+    }
+  }
+
+}
 
 namespace marlin {
 
@@ -67,6 +123,40 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  clock::duration_rep SequenceItem::init( Application *app ) {
+    std::unique_lock<std::mutex> lock ;
+    if( nullptr != _mutex ) {
+      lock = std::unique_lock<std::mutex>( *_mutex ) ;
+    }
+    auto start = clock::now() ;
+    _processor->baseInit( app ) ;
+    return clock::elapsed_since<clock::seconds>( start ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void SequenceItem::end() {
+    std::unique_lock<std::mutex> lock ;
+    if( nullptr != _mutex ) {
+      lock = std::unique_lock<std::mutex>( *_mutex ) ;
+    }
+    _processor->baseEnd() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  clock::duration_rep SequenceItem::replicate( const SequenceItem &prototype ) {
+    auto start = clock::now() ;
+    auto replica = prototype.processor()->baseClone() ;
+    if( nullptr == replica ) {
+      return -1 ;
+    }
+    _processor = replica ;
+    return clock::elapsed_since<clock::seconds>( start ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
   std::shared_ptr<Processor> SequenceItem::processor() const {
     return _processor ;
   }
@@ -78,6 +168,37 @@ namespace marlin {
   }
 
   //--------------------------------------------------------------------------
+
+  void SequenceItem::setTimeBudget( double budget ) {
+    _timeBudget = budget ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  double SequenceItem::timeBudget() const {
+    return _timeBudget ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool SequenceItem::critical() const {
+    return ( nullptr != _mutex ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  Sequence::Sequence( Index index ) :
+    _index(index) {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  Sequence::Index Sequence::index() const {
+    return _index ;
+  }
+
   //--------------------------------------------------------------------------
 
   std::shared_ptr<SequenceItem> Sequence::createItem( std::shared_ptr<Processor> processor, std::shared_ptr<std::mutex> lock ) const {
@@ -94,6 +215,7 @@ namespace marlin {
       throw Exception( "Sequence::addItem: processor '" + item->name() + "' already in sequence" ) ;
     }
     _items.push_back( item ) ;
+    _skipCounters.push_back( 0 ) ;
     _clockMeasures[item->name()] = ClockMeasure() ;
   }
 
@@ -120,18 +242,65 @@ namespace marlin {
   //--------------------------------------------------------------------------
 
   void Sequence::processEvent( std::shared_ptr<EventStore> event ) {
+    WorkerLocalBase::setCurrentWorkerIndex( _index ) ;
+    // the event is done on any exit (processed, skipped or failed): the
+    // ordered outputs must not wait for it once this worker moves on
+    struct ProcessedGuard {
+      Application *_application ;
+      std::size_t _inputIndex ;
+      ~ProcessedGuard() {
+        if( nullptr != _application ) {
+          _application->eventProcessed( _inputIndex ) ;
+        }
+      }
+    } processedGuard { _application, event->inputIndex() } ;
+    // report to the watchdog, if time budgets are set
+    CancellationExtension *cancellation = nullptr ;
+    if( nullptr != _watchdog ) {
+      cancellation = event->extensions().get<extensions::Cancellation, CancellationExtension>() ;
+    }
+    struct WatchdogGuard {
+      EventWatchdog *_watchdog ;
+      Index _slot ;
+      ~WatchdogGuard() {
+        if( nullptr != _watchdog ) {
+          _watchdog->eventFinished( _slot ) ;
+        }
+      }
+    } guard { ( nullptr != cancellation ) ? _watchdog : nullptr, _index } ;
+    if( nullptr != guard._watchdog ) {
+      _watchdog->eventStarted( _index, event->uid(), cancellation ) ;
+    }
     try {
+      // the data source may still be preparing the event (e.g unpacking)
+      event->waitPreparation() ;
       auto extension = event->extensions().get<extensions::ProcessorConditions, ProcessorConditionsExtension>() ;
-      for ( auto item : _items ) {
+      for ( Index i=0 ; i<_items.size() ; ++i ) {
+        auto &item = _items[i] ;
         if ( not extension->check( item->name() ) ) {
           continue ;
         }
+        if( nullptr != guard._watchdog ) {
+          _watchdog->processorStarted( _index, item->name(), item->timeBudget() ) ;
+        }
         auto clockMeas = item->processEvent( event ) ;
         auto iter = _clockMeasures.find( item->name() ) ;
         iter->second._appClock += clockMeas.first ;
         iter->second._procClock += clockMeas.second ;
         iter->second._counter ++ ;
+        _totalClock._appClock += clockMeas.first ;
+        _totalClock._procClock += clockMeas.second ;
+        // skip requested by the processor: no exception, just count it
+        if( event->skipRequested() ) {
+          _skipCounters[i] ++ ;
+          return ;
+        }
+        // cancelled event: skip the remaining processors
+        if( nullptr != cancellation and cancellation->cancelled() ) {
+          throw SkipEventException( item->name() + " (time budget exceeded)" ) ;
+        }
       }
+      _totalClock._counter ++ ;
     }
     catch ( SkipEventException& e ) {
       auto iter = _skipEventMap.find( e.what() ) ;
@@ -146,6 +315,12 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  const ClockMeasure &Sequence::totalClock() const {
+    return _totalClock ;
+  }
+
+  //--------------------------------------------------------------------------
+
   ClockMeasure Sequence::clockMeasureSummary() const {
     ClockMeasure summary {} ;
     for ( auto t : _clockMeasures ) {
@@ -164,8 +339,26 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
-  const Sequence::SkippedEventMap &Sequence::skippedEvents() const {
-    return _skipEventMap ;
+  Sequence::SkippedEventMap Sequence::skippedEvents() const {
+    SkippedEventMap skipped = _skipEventMap ;
+    for( Index i=0 ; i<_items.size() ; ++i ) {
+      if( _skipCounters[i] > 0 ) {
+        skipped[ _items[i]->name() ] += _skipCounters[i] ;
+      }
+    }
+    return skipped ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Sequence::setWatchdog( EventWatchdog *watchdog ) {
+    _watchdog = watchdog ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void Sequence::setApplication( Application *app ) {
+    _application = app ;
   }
 
   //--------------------------------------------------------------------------
@@ -177,15 +370,106 @@ namespace marlin {
     }
     _sequences.resize(nseqs) ;
     for( std::size_t i=0 ; i<nseqs ; ++i ) {
-      _sequences.at(i) = std::make_shared<Sequence>() ;
+      _sequences.at(i) = std::make_shared<Sequence>( i ) ;
     }
   }
 
   //--------------------------------------------------------------------------
 
   void SuperSequence::init( Application *app ) {
-    for( auto item : _uniqueItems ) {
-      item->processor()->baseInit( app ) ;
+    for( auto &sequence : _sequences ) {
+      sequence->setApplication( app ) ;
+    }
+    _parallelInit = app->globalParameters()->getValue<bool>( "ParallelInit", false ) ;
+    // the memory used by each instance can only be measured in a serial init
+    _taskQueue = _calibrate ? nullptr : &app->taskQueue() ;
+    _instanceMemory.assign( _itemOrder.size(), 0 ) ;
+    std::vector<clock::duration_rep> initTimes ( _itemOrder.size(), 0 ) ;
+    std::vector<char> replicated ( _itemOrder.size(), 0 ) ;
+    // initialize prototypes and shared processors first,
+    // then replicate the clones from their prototype if possible
+    auto initItem = [&]( std::size_t index ) {
+      auto item = _itemOrder[index] ;
+      const auto memory = _calibrate ? RuntimeCalibration::residentMemory() : 0 ;
+      auto replicationTime = ( nullptr != _prototypes[index] ) ? item->replicate( *_prototypes[index] ) : -1 ;
+      if( replicationTime >= 0 ) {
+        initTimes[index] = replicationTime ;
+        replicated[index] = 1 ;
+      }
+      else {
+        initTimes[index] = item->init( app ) ;
+      }
+      if( _calibrate ) {
+        const auto after = RuntimeCalibration::residentMemory() ;
+        _instanceMemory[index] = ( after > memory ) ? after - memory : 0 ;
+      }
+    } ;
+    auto start = clock::now() ;
+    if( _parallelInit ) {
+      std::vector<std::size_t> prototypeIndices, cloneIndices ;
+      for( std::size_t i=0 ; i<_itemOrder.size() ; ++i ) {
+        ( nullptr == _prototypes[i] ? prototypeIndices : cloneIndices ).push_back( i ) ;
+      }
+      runConcurrently( _taskQueue, prototypeIndices, initItem ) ;
+      runConcurrently( _taskQueue, cloneIndices, initItem ) ;
+    }
+    else {
+      // processors in steering order, only the clones of a processor concurrently
+      for( auto &indices : processorItemIndices() ) {
+        std::vector<std::size_t> prototypeIndices, cloneIndices ;
+        for( auto index : indices ) {
+          ( nullptr == _prototypes[index] ? prototypeIndices : cloneIndices ).push_back( index ) ;
+        }
+        runConcurrently( _taskQueue, prototypeIndices, initItem ) ;
+        runConcurrently( _taskQueue, cloneIndices, initItem ) ;
+      }
+    }
+    // report init time per processor (all instances)
+    struct InitReport {
+      clock::duration_rep   _time {0} ;
+      unsigned int          _instances {0} ;
+      unsigned int          _replicas {0} ;
+    };
+    std::map<std::string, InitReport> processorTimes ;
+    std::vector<std::string> processorOrder ;
+    for( std::size_t i=0 ; i<_itemOrder.size() ; ++i ) {
+      auto iter = processorTimes.find( _itemOrder[i]->name() ) ;
+      if( processorTimes.end() == iter ) {
+        processorOrder.push_back( _itemOrder[i]->name() ) ;
+        iter = processorTimes.insert( { _itemOrder[i]->name(), InitReport() } ).first ;
+      }
+      iter->second._time = std::max( iter->second._time, initTimes[i] ) ;
+      iter->second._instances ++ ;
+      iter->second._replicas += replicated[i] ;
+    }
+    auto logger = app->logger() ;
+    logger->log<MESSAGE>() << "--------------------------------------------------------- " << std::endl ;
+    logger->log<MESSAGE>() << "-- Processor init time (slowest instance) : " << std::endl ;
+    for( auto &name : processorOrder ) {
+      auto &report = processorTimes[name] ;
+      logger->log<MESSAGE>() << "--       " << name << ": \t" << report._time << " s ("
+        << report._instances << " instance(s), " << report._replicas << " replicated)" << std::endl ;
+    }
+    logger->log<MESSAGE>() << "-- Total: " << clock::elapsed_since<clock::seconds>( start ) << " s ("
+      << ( nullptr == _taskQueue ? "serial" : ( _parallelInit ? "processors and clones in parallel" : "clones in parallel" ) ) << ")" << std::endl ;
+    logger->log<MESSAGE>() << "--------------------------------------------------------- " << std::endl ;
+    // start the event watchdog if any time budget is set
+    const double eventBudget = app->globalParameters()->getValue<double>( "EventTimeBudget", 0. ) ;
+    double minBudget = eventBudget ;
+    for( auto &item : _itemOrder ) {
+      if( item->timeBudget() > 0. and ( minBudget <= 0. or item->timeBudget() < minBudget ) ) {
+        minBudget = item->timeBudget() ;
+      }
+    }
+    if( minBudget > 0. ) {
+      _watchdog.reset( new EventWatchdog( size(), eventBudget, logger ) ) ;
+      for( auto &sequence : _sequences ) {
+        sequence->setWatchdog( _watchdog.get() ) ;
+      }
+      // check ten times per budget, between 10 ms and 1 s
+      const double period = std::min( 1., std::max( 0.01, minBudget / 10. ) ) ;
+      _watchdog->start( period ) ;
+      logger->log<MESSAGE>() << "-- Event watchdog started (event budget: " << eventBudget << " s, check period: " << period << " s)" << std::endl ;
     }
   }
 
@@ -197,11 +481,45 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  void SuperSequence::configureCalibration( Application *app ) {
+    _logger = app->logger() ;
+    _calibrate = app->globalParameters()->getValue<bool>( "RuntimeCalibration", false ) ;
+    _calibrationFile = app->globalParameters()->getValue<std::string>( "RuntimeCalibrationFile", "MarlinRuntimeOptions.xml" ) ;
+    if( _calibrate and size() < 2 ) {
+      _logger->log<WARNING>() << "Runtime calibration requires a concurrency > 1, calibration mode turned off" << std::endl ;
+      _calibrate = false ;
+    }
+    _autoOptions.clear() ;
+    if( std::ifstream( _calibrationFile ).good() ) {
+      _autoOptions = RuntimeCalibration::readSteeringPatch( _calibrationFile ) ;
+      _logger->log<MESSAGE>() << "Read runtime options of " << _autoOptions.size() << " processor(s) from " << _calibrationFile << std::endl ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
   void SuperSequence::addProcessor( std::shared_ptr<StringParameters> parameters ) {
-    const bool cloneSet = parameters->isParameterSet( "ProcessorClone" ) ;
-    const bool criticalSet = parameters->isParameterSet( "ProcessorCritical" ) ;
-    bool clone = parameters->getValue<bool>( "ProcessorClone", true ) ;
-    bool critical = parameters->getValue<bool>( "ProcessorCritical", false ) ;
+    auto isAuto = [&]( const std::string &key ) {
+      return ( parameters->isParameterSet( key ) and "auto" == parameters->getValue<std::string>( key ) ) ;
+    } ;
+    const bool cloneAuto = isAuto( "ProcessorClone" ) ;
+    const bool criticalAuto = isAuto( "ProcessorCritical" ) ;
+    const bool cloneSet = not cloneAuto and parameters->isParameterSet( "ProcessorClone" ) ;
+    const bool criticalSet = not criticalAuto and parameters->isParameterSet( "ProcessorCritical" ) ;
+    bool clone = cloneAuto ? true : parameters->getValue<bool>( "ProcessorClone", true ) ;
+    bool critical = criticalAuto ? false : parameters->getValue<bool>( "ProcessorCritical", false ) ;
+    if( cloneAuto or criticalAuto ) {
+      auto name = parameters->getValue<std::string>( "ProcessorName" ) ;
+      auto iter = _autoOptions.find( name ) ;
+      if( _autoOptions.end() != iter ) {
+        clone = cloneAuto ? iter->second._clone : clone ;
+        critical = criticalAuto ? iter->second._critical : critical ;
+      }
+      else if( nullptr != _logger ) {
+        _logger->log<WARNING>() << "No calibrated runtime options for processor '" << name << "', using defaults" << std::endl ;
+      }
+    }
+    const double timeBudget = parameters->getValue<double>( "ProcessorTimeBudget", 0. ) ;
     auto type = parameters->getValue<std::string>( "ProcessorType" ) ;
     auto &pluginMgr = PluginManager::instance() ;
     auto processor = pluginMgr.create<Processor>( PluginType::Processor, type ) ;
@@ -233,23 +551,36 @@ namespace marlin {
     processor->setParameters( parameters ) ;
     std::shared_ptr<std::mutex> lock = critical ? std::make_shared<std::mutex>() : nullptr ;
     if( clone ) {
-      // add the first but then create new processor instances and add them
-      auto item = _sequences.at(0)->createItem( processor, lock ) ;
-      _sequences.at(0)->addItem( item ) ;
-      _uniqueItems.insert( item ) ;
+      // add the first but then create new processor instances and add them.
+      // The first one is the prototype of the others (see init())
+      auto prototype = _sequences.at(0)->createItem( processor, lock ) ;
+      prototype->setTimeBudget( timeBudget ) ;
+      _sequences.at(0)->addItem( prototype ) ;
+      if( _uniqueItems.insert( prototype ).second ) {
+        _itemOrder.push_back( prototype ) ;
+        _prototypes.push_back( nullptr ) ;
+      }
       for( SizeType i=1 ; i<size() ; ++i ) {
         processor = pluginMgr.create<Processor>( PluginType::Processor, type ) ;
         processor->setParameters( parameters ) ;
-        item = _sequences.at(i)->createItem( processor, lock ) ;
+        auto item = _sequences.at(i)->createItem( processor, lock ) ;
+        item->setTimeBudget( timeBudget ) ;
         _sequences.at(i)->addItem( item ) ;
-        _uniqueItems.insert( item ) ;
+        if( _uniqueItems.insert( item ).second ) {
+          _itemOrder.push_back( item ) ;
+          _prototypes.push_back( prototype ) ;
+        }
       }
     }
     else {
       // add the first and re-use the same item
       auto item = _sequences.at(0)->createItem( processor, lock ) ;
+      item->setTimeBudget( timeBudget ) ;
       _sequences.at(0)->addItem( item ) ;
-      _uniqueItems.insert( item ) ;
+      if( _uniqueItems.insert( item ).second ) {
+        _itemOrder.push_back( item ) ;
+        _prototypes.push_back( nullptr ) ;
+      }
       for( SizeType i=1 ; i<size() ; ++i ) {
         _sequences.at(i)->addItem( item ) ;
       }
@@ -265,7 +596,7 @@ namespace marlin {
   //--------------------------------------------------------------------------
 
   void SuperSequence::processRunHeader( std::shared_ptr<RunHeader> rhdr ) {
-    for( auto item : _uniqueItems ) {
+    for( auto item : _itemOrder ) {
       item->processRunHeader( rhdr ) ;
     }
   }
@@ -273,9 +604,58 @@ namespace marlin {
   //--------------------------------------------------------------------------
 
   void SuperSequence::end() {
-    for( auto item : _uniqueItems ) {
-      item->processor()->end() ;
+    if( nullptr != _watchdog ) {
+      _watchdog->stop() ;
+    }
+    auto endItem = [this]( std::size_t index ) {
+      _itemOrder[index]->end() ;
+    } ;
+    if( _parallelInit ) {
+      std::vector<std::size_t> indices ( _itemOrder.size() ) ;
+      std::iota( indices.begin(), indices.end(), 0 ) ;
+      runConcurrently( _taskQueue, indices, endItem ) ;
+    }
+    else {
+      // processors in steering order, only the clones of a processor concurrently
+      for( auto &indices : processorItemIndices() ) {
+        runConcurrently( _taskQueue, indices, endItem ) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::vector<std::vector<std::size_t>> SuperSequence::processorItemIndices() const {
+    std::vector<std::vector<std::size_t>> processorIndices ;
+    std::map<std::string, std::size_t> processorMap ;
+    for( std::size_t i=0 ; i<_itemOrder.size() ; ++i ) {
+      auto iter = processorMap.insert( { _itemOrder[i]->name(), processorIndices.size() } ).first ;
+      if( processorIndices.size() == iter->second ) {
+        processorIndices.emplace_back() ;
+      }
+      processorIndices[ iter->second ].push_back( i ) ;
+    }
+    return processorIndices ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  Sequence::ClockMeasureMap SuperSequence::mergedClockMeasures() const {
+    Sequence::ClockMeasureMap clockMeasures {} ;
+    for( unsigned int i=0 ; i<size() ; ++i ) {
+      for( auto clk : sequence(i)->clockMeasures() ) {
+        auto iter = clockMeasures.find( clk.first ) ;
+        if( clockMeasures.end() != iter ) {
+          iter->second._appClock += clk.second._appClock ;
+          iter->second._procClock += clk.second._procClock ;
+          iter->second._counter += clk.second._counter ;
+        }
+        else {
+          clockMeasures.insert( clk ) ;
+        }
+      }
     }
+    return clockMeasures ;
   }
 
   //--------------------------------------------------------------------------
@@ -283,12 +663,10 @@ namespace marlin {
   void SuperSequence::printStatistics( Logging::Logger logger ) const {
     // first merge measurements from the different sequences
     Sequence::SkippedEventMap skippedEvents {} ;
-    Sequence::ClockMeasureMap clockMeasures {} ;
+    const auto clockMeasures = mergedClockMeasures() ;
     for( unsigned int i=0 ; i<size() ; ++i ) {
-      auto skipped = sequence(i)->skippedEvents() ;
-      auto clocks = sequence(i)->clockMeasures() ;
       // merge skipped events stats
-      for( auto sk : skipped ) {
+      for( auto sk : sequence(i)->skippedEvents() ) {
         auto iter = skippedEvents.find( sk.first ) ;
         if( skippedEvents.end() != iter ) {
           iter->second += sk.second ;
@@ -297,18 +675,6 @@ namespace marlin {
           skippedEvents.insert( sk ) ;
         }
       }
-      // merge clocks stats
-      for( auto clk : clocks ) {
-        auto iter = clockMeasures.find( clk.first ) ;
-        if( clockMeasures.end() != iter ) {
-          iter->second._appClock += clk.second._appClock ;
-          iter->second._procClock += clk.second._procClock ;
-          iter->second._counter += clk.second._counter ;
-        }
-        else {
-          clockMeasures.insert( clk ) ;
-        }
-      }
     }
     logger->log<MESSAGE>() << "--------------------------------------------------------- " << std::endl ;
     logger->log<MESSAGE>() << "-- Events skipped by processors : " << std::endl ;
@@ -318,6 +684,9 @@ namespace marlin {
       nSkipped += skip.second ;
     }
     logger->log<MESSAGE>() << "-- Total: " << nSkipped  << std::endl ;
+    if( nullptr != _watchdog ) {
+      logger->log<MESSAGE>() << "-- Cancelled by the event watchdog: " << _watchdog->nCancelled() << std::endl ;
+    }
     logger->log<MESSAGE>() << "--------------------------------------------------------- " << std::endl
           << std::endl ;
     logger->log<MESSAGE>() << "--------------------------------------------------------- " << std::endl
@@ -374,4 +743,58 @@ namespace marlin {
     logger->log<MESSAGE>() << "--------------------------------------------------------- " << std::endl ;
   }
 
+  //--------------------------------------------------------------------------
+
+  void SuperSequence::writeCalibration( Logging::Logger logger ) const {
+    if( not _calibrate ) {
+      return ;
+    }
+    RuntimeCalibration::Settings settings {} ;
+    settings._concurrency = size() ;
+    RuntimeCalibration calibration( settings ) ;
+    const auto clockMeasures = mergedClockMeasures() ;
+    // gather the measurements of all instances per processor
+    std::vector<std::string> processorOrder ;
+    std::map<std::string, RuntimeCalibration::Measurement> measurements ;
+    std::map<std::string, std::size_t> instances ;
+    for( std::size_t i=0 ; i<_itemOrder.size() ; ++i ) {
+      auto item = _itemOrder[i] ;
+      auto iter = measurements.find( item->name() ) ;
+      if( measurements.end() == iter ) {
+        processorOrder.push_back( item->name() ) ;
+        RuntimeCalibration::Measurement measurement {} ;
+        measurement._name = item->name() ;
+        measurement._critical = item->critical() ;
+        measurement._cloneForced = item->processor()->getForcedRuntimeOption( Processor::RuntimeOption::Clone ).first ;
+        measurement._criticalForced = item->processor()->getForcedRuntimeOption( Processor::RuntimeOption::Critical ).first ;
+        auto clockIter = clockMeasures.find( item->name() ) ;
+        if( clockMeasures.end() != clockIter ) {
+          measurement._appTime = clockIter->second._appClock ;
+          measurement._procTime = clockIter->second._procClock ;
+          measurement._events = clockIter->second._counter ;
+        }
+        iter = measurements.insert( { item->name(), measurement } ).first ;
+      }
+      iter->second._instanceMemory += _instanceMemory.at(i) ;
+      instances[ item->name() ] ++ ;
+    }
+    for( auto &name : processorOrder ) {
+      auto &measurement = measurements[name] ;
+      measurement._clone = ( instances[name] > 1 ) ;
+      measurement._instanceMemory /= instances[name] ;
+      calibration.addMeasurement( measurement ) ;
+    }
+    const auto options = calibration.proposeAll() ;
+    logger->log<MESSAGE>() << "--------------------------------------------------------- " << std::endl ;
+    logger->log<MESSAGE>() << "-- Runtime calibration (" << size() << " threads), proposed options : " << std::endl ;
+    for( auto &name : processorOrder ) {
+      auto &opts = options.at( name ) ;
+      logger->log<MESSAGE>() << "--       " << name << ": clone=" << ( opts._clone ? "true" : "false" )
+        << ", critical=" << ( opts._critical ? "true" : "false" ) << " (" << opts._reason << ")" << std::endl ;
+    }
+    calibration.writeSteeringPatch( _calibrationFile, options ) ;
+    logger->log<MESSAGE>() << "-- Steering file patch written in " << _calibrationFile << std::endl ;
+    logger->log<MESSAGE>() << "--------------------------------------------------------- " << std::endl ;
+  }
+
 }
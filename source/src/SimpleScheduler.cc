@@ -33,6 +33,7 @@ namespace marlin {
       }
       throw Exception( "SimpleScheduler::init: duplicated active processors. Check your steering file !" ) ;
     }
+    _superSequence->configureCalibration( app ) ;
     // populate processor sequences
     for ( size_t i=0 ; i<activeProcessors.size() ; ++i ) {
       auto procName = activeProcessors[ i ] ;
@@ -54,6 +55,7 @@ namespace marlin {
     _superSequence->end() ;
     // print some statistics
     _superSequence->printStatistics( _logger ) ;
+    _superSequence->writeCalibration( _logger ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -85,4 +87,10 @@ namespace marlin {
     return ( _currentEvent != nullptr ) ? 0 : 1 ;
   }
 
+  //--------------------------------------------------------------------------
+
+  std::size_t SimpleScheduler::concurrency() const {
+    return 1 ;
+  }
+
 }
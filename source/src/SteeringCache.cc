@@ -0,0 +1,394 @@
+#include <marlin/SteeringCache.h>
+
+// -- marlin headers
+#include <marlin/XMLParser.h>
+#include <marlin/StringParameters.h>
+#include <marlin/Exceptions.h>
+#include <marlin/Utils.h>
+
+// -- std headers
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+// -- unix headers
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+  /// The magic bytes at the beginning of a cache file
+  const char cacheMagic[8] = { 'M', 'A', 'R', 'L', 'I', 'N', 'S', 'C' } ;
+
+  /**
+   *  @brief  BufferReader class
+   *  Sequential reader over a (memory mapped) buffer
+   */
+  class BufferReader {
+  public:
+    BufferReader( const char *data, std::size_t size ) :
+      _data(data),
+      _size(size) {
+      /* nop */
+    }
+
+    template <typename T>
+    bool read( T &value ) {
+      if( _pos + sizeof(T) > _size ) {
+        return false ;
+      }
+      std::memcpy( &value, _data + _pos, sizeof(T) ) ;
+      _pos += sizeof(T) ;
+      return true ;
+    }
+
+    bool read( std::string &str ) {
+      std::uint32_t len = 0 ;
+      if( not read( len ) or _pos + len > _size ) {
+        return false ;
+      }
+      str.assign( _data + _pos, len ) ;
+      _pos += len ;
+      return true ;
+    }
+
+    std::size_t position() const {
+      return _pos ;
+    }
+
+  private:
+    const char      *_data {nullptr} ;
+    std::size_t      _size {0} ;
+    std::size_t      _pos {0} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  BufferWriter class
+   *  Sequential writer in a memory buffer
+   */
+  class BufferWriter {
+  public:
+    template <typename T>
+    void write( const T &value ) {
+      _buffer.append( reinterpret_cast<const char*>( &value ), sizeof(T) ) ;
+    }
+
+    void write( const std::string &str ) {
+      write( static_cast<std::uint32_t>( str.size() ) ) ;
+      _buffer.append( str ) ;
+    }
+
+    const std::string &buffer() const {
+      return _buffer ;
+    }
+
+  private:
+    std::string      _buffer {} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  MappedFile class
+   *  RAII wrapper around a read-only memory mapped file
+   */
+  class MappedFile {
+  public:
+    MappedFile( const std::string &fname ) {
+      int fd = ::open( fname.c_str(), O_RDONLY ) ;
+      if( fd < 0 ) {
+        return ;
+      }
+      struct stat st ;
+      if( 0 == ::fstat( fd, &st ) and st.st_size > 0 ) {
+        void *addr = ::mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 ) ;
+        if( MAP_FAILED != addr ) {
+          _data = static_cast<const char*>( addr ) ;
+          _size = st.st_size ;
+        }
+      }
+      ::close( fd ) ;
+    }
+
+    ~MappedFile() {
+      if( nullptr != _data ) {
+        ::munmap( const_cast<char*>( _data ), _size ) ;
+      }
+    }
+
+    MappedFile( const MappedFile & ) = delete ;
+    MappedFile &operator=( const MappedFile & ) = delete ;
+
+    const char *data() const {
+      return _data ;
+    }
+
+    std::size_t size() const {
+      return _size ;
+    }
+
+  private:
+    const char      *_data {nullptr} ;
+    std::size_t      _size {0} ;
+  };
+
+}
+
+namespace marlin {
+
+  SteeringCache::SteeringCache( const std::string &steeringFile, const std::string &cacheFile ) :
+    _steeringFile(steeringFile),
+    _cacheFile(cacheFile) {
+    _logger = Logging::createLogger( "SteeringCache" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void SteeringCache::setCmdLineParameters( const CommandLineParametersMap &cmdlineparams ) {
+    _cmdLineParameters = cmdlineparams ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void SteeringCache::parse() {
+    SectionMap sections ;
+    if( readCache( sections ) ) {
+      _sections = std::move( sections ) ;
+      _fromCache = true ;
+      _logger->log<MESSAGE>() << "Steering loaded from cache file " << _cacheFile << std::endl ;
+      return ;
+    }
+    _logger->log<MESSAGE>() << "Cache file " << _cacheFile << " missing or out of date, parsing " << _steeringFile << std::endl ;
+    readXML() ;
+    // the cache is an optimization only. Don't stop the application here
+    try {
+      writeCache( _sections, _xmlParser->includedFiles() ) ;
+      _logger->log<MESSAGE>() << "Steering cache written to " << _cacheFile << std::endl ;
+    }
+    catch( Exception &e ) {
+      _logger->log<WARNING>() << "Couldn't write steering cache: " << e.what() << std::endl ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void SteeringCache::compile() {
+    readXML() ;
+    writeCache( _sections, _xmlParser->includedFiles() ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void SteeringCache::readXML() {
+    _xmlParser = parseXML() ;
+    _sections.clear() ;
+    for( auto section : _xmlParser->getSections() ) {
+      auto parameters = _xmlParser->getParameters( section ) ;
+      if( nullptr != parameters ) {
+        _sections[ section ] = parameters ;
+      }
+    }
+    _fromCache = false ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::shared_ptr<StringParameters> SteeringCache::getParameters( const std::string &sectionName ) const {
+    auto iter = _sections.find( sectionName ) ;
+    if( _sections.end() == iter ) {
+      return nullptr ;
+    }
+    return iter->second ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void SteeringCache::write( const std::string &fname ) const {
+    if( nullptr == _xmlParser ) {
+      _xmlParser = parseXML() ;
+    }
+    _xmlParser->write( fname ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool SteeringCache::loadedFromCache() const {
+    return _fromCache ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::shared_ptr<XMLParser> SteeringCache::parseXML() const {
+    auto parser = std::make_shared<XMLParser>( _steeringFile ) ;
+    parser->setCmdLineParameters( _cmdLineParameters ) ;
+    parser->parse() ;
+    return parser ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned long long int SteeringCache::steeringHash() const {
+    auto hash = fileHash( _steeringFile ) ;
+    hash = HashHelper::hash64( &formatVersion, sizeof(formatVersion), hash ) ;
+    for( auto &section : _cmdLineParameters ) {
+      for( auto &param : section.second ) {
+        std::string option = "--" + section.first + "." + param.first + "=" + param.second ;
+        // include the null character as separator
+        hash = HashHelper::hash64( option.c_str(), option.size() + 1, hash ) ;
+      }
+    }
+    return hash ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned long long int SteeringCache::fileHash( const std::string &fname ) {
+    std::ifstream file( fname, std::ios::binary ) ;
+    if( not file ) {
+      throw Exception( "SteeringCache: couldn't read file '" + fname + "'" ) ;
+    }
+    std::stringstream content ;
+    content << file.rdbuf() ;
+    auto str = content.str() ;
+    return HashHelper::hash64( str.data(), str.size() ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool SteeringCache::readCache( SectionMap &sections ) const {
+    MappedFile file( _cacheFile ) ;
+    if( nullptr == file.data() ) {
+      return false ;
+    }
+    // the file ends with a checksum of the preceding bytes
+    const std::size_t checksumSize = sizeof(unsigned long long int) ;
+    if( file.size() < sizeof(cacheMagic) + checksumSize ) {
+      return false ;
+    }
+    const std::size_t contentSize = file.size() - checksumSize ;
+    unsigned long long int checksum = 0 ;
+    std::memcpy( &checksum, file.data() + contentSize, checksumSize ) ;
+    if( checksum != HashHelper::hash64( file.data(), contentSize ) ) {
+      return false ;
+    }
+    BufferReader reader( file.data(), contentSize ) ;
+    char magic[ sizeof(cacheMagic) ] ;
+    std::uint32_t version = 0 ;
+    unsigned long long int hash = 0 ;
+    if( not reader.read( magic ) or 0 != std::memcmp( magic, cacheMagic, sizeof(cacheMagic) ) ) {
+      return false ;
+    }
+    if( not reader.read( version ) or formatVersion != version ) {
+      return false ;
+    }
+    if( not reader.read( hash ) or steeringHash() != hash ) {
+      return false ;
+    }
+    // included files must be unchanged
+    std::uint32_t ndependencies = 0 ;
+    if( not reader.read( ndependencies ) ) {
+      return false ;
+    }
+    for( std::uint32_t d=0 ; d<ndependencies ; ++d ) {
+      std::string dependency ;
+      unsigned long long int dependencyHash = 0 ;
+      if( not reader.read( dependency ) or not reader.read( dependencyHash ) ) {
+        return false ;
+      }
+      try {
+        if( fileHash( dependency ) != dependencyHash ) {
+          return false ;
+        }
+      }
+      catch( Exception & ) {
+        return false ;
+      }
+    }
+    // parameter sections
+    std::uint32_t nsections = 0 ;
+    if( not reader.read( nsections ) ) {
+      return false ;
+    }
+    for( std::uint32_t s=0 ; s<nsections ; ++s ) {
+      std::string sectionName ;
+      std::uint32_t nkeys = 0 ;
+      if( not reader.read( sectionName ) or not reader.read( nkeys ) ) {
+        return false ;
+      }
+      auto parameters = std::make_shared<StringParameters>() ;
+      for( std::uint32_t k=0 ; k<nkeys ; ++k ) {
+        std::string key ;
+        std::uint32_t nvalues = 0 ;
+        if( not reader.read( key ) or not reader.read( nvalues ) ) {
+          return false ;
+        }
+        std::vector<std::string> values ( nvalues ) ;
+        for( auto &value : values ) {
+          if( not reader.read( value ) ) {
+            return false ;
+          }
+        }
+        parameters->add( key ) ;
+        parameters->add( key, values ) ;
+      }
+      sections[ sectionName ] = parameters ;
+    }
+    return ( reader.position() == contentSize ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void SteeringCache::writeCache( const SectionMap &sections, const FileList &dependencies ) const {
+    BufferWriter writer ;
+    writer.write( cacheMagic ) ;
+    writer.write( static_cast<std::uint32_t>( formatVersion ) ) ;
+    writer.write( steeringHash() ) ;
+    writer.write( static_cast<std::uint32_t>( dependencies.size() ) ) ;
+    for( auto &dependency : dependencies ) {
+      writer.write( dependency ) ;
+      writer.write( fileHash( dependency ) ) ;
+    }
+    writer.write( static_cast<std::uint32_t>( sections.size() ) ) ;
+    for( auto &section : sections ) {
+      auto keys = section.second->keys() ;
+      writer.write( section.first ) ;
+      writer.write( static_cast<std::uint32_t>( keys.size() ) ) ;
+      for( auto &key : keys ) {
+        auto values = section.second->getValues<std::string>( key ) ;
+        writer.write( key ) ;
+        writer.write( static_cast<std::uint32_t>( values.size() ) ) ;
+        for( auto &value : values ) {
+          writer.write( value ) ;
+        }
+      }
+    }
+    auto &buffer = writer.buffer() ;
+    const unsigned long long int checksum = HashHelper::hash64( buffer.data(), buffer.size() ) ;
+    // write in a temporary file and rename for atomic replacement
+    const std::string tmpFile = _cacheFile + ".tmp." + std::to_string( ::getpid() ) ;
+    {
+      std::ofstream file( tmpFile, std::ios::binary | std::ios::trunc ) ;
+      if( not file ) {
+        throw Exception( "SteeringCache: couldn't open file '" + tmpFile + "' for writing" ) ;
+      }
+      file.write( buffer.data(), buffer.size() ) ;
+      file.write( reinterpret_cast<const char*>( &checksum ), sizeof(checksum) ) ;
+      if( not file ) {
+        throw Exception( "SteeringCache: couldn't write file '" + tmpFile + "'" ) ;
+      }
+    }
+    if( 0 != std::rename( tmpFile.c_str(), _cacheFile.c_str() ) ) {
+      std::remove( tmpFile.c_str() ) ;
+      throw Exception( "SteeringCache: couldn't rename '" + tmpFile + "' to '" + _cacheFile + "'" ) ;
+    }
+  }
+
+}
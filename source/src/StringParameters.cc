@@ -6,6 +6,23 @@
 
 namespace marlin {
 
+  StringParameters::StringParameters( const StringParameters &sp ) :
+    _map(sp._map) {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  StringParameters &StringParameters::operator=( const StringParameters &sp ) {
+    if( this != &sp ) {
+      _map = sp._map ;
+      clearTypedValues() ;
+    }
+    return *this ;
+  }
+
+  //--------------------------------------------------------------------------
+
   void StringParameters::add( const std::string& key ) {
     _map.insert( ParametersMap::value_type(key, ParametersMap::mapped_type()) ) ;
   }
@@ -14,6 +31,7 @@ namespace marlin {
 
   void StringParameters::erase( const std::string& key ) {
     _map.erase( key );
+    clearTypedValues() ;
   }
 
   //--------------------------------------------------------------------------
@@ -38,15 +56,17 @@ namespace marlin {
     auto iter = _map.find( key ) ;
     if( _map.end() != iter ) {
       iter->second.clear() ;
+      clearTypedValues() ;
     }
   }
 
   //--------------------------------------------------------------------------
 
   void StringParameters::unset() {
-    for( auto iter : _map ) {
+    for( auto &iter : _map ) {
       iter.second.clear() ;
     }
+    clearTypedValues() ;
   }
 
   //--------------------------------------------------------------------------
@@ -62,6 +82,13 @@ namespace marlin {
 
   //--------------------------------------------------------------------------
 
+  void StringParameters::clearTypedValues() {
+    std::unique_lock<std::shared_mutex> lock( _typedMutex ) ;
+    _typedValues.clear() ;
+  }
+
+  //--------------------------------------------------------------------------
+
   std::ostream& operator<< (  std::ostream& s,  const StringParameters& p ) {
     for( auto m : p._map ) {
       s << "      " << m.first << ": " ;
@@ -0,0 +1,22 @@
+#include <marlin/WorkerLocal.h>
+
+namespace marlin {
+
+  namespace {
+    /// The worker index of the current thread. Set by the pool threads when they start
+    thread_local std::size_t workerIndex = WorkerLocalBase::NoWorker ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t WorkerLocalBase::currentWorkerIndex() {
+    return workerIndex ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void WorkerLocalBase::setCurrentWorkerIndex( std::size_t index ) {
+    workerIndex = index ;
+  }
+
+}
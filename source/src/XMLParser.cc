@@ -32,8 +32,13 @@ namespace marlin{
       return sections ;
     }
 
+    const std::vector<std::string> &XMLParser::includedFiles() const {
+      return _includedFiles ;
+    }
+
     void XMLParser::parse(){
 
+        _includedFiles.clear() ;
 
         _doc = std::unique_ptr<TiXmlDocument>( new TiXmlDocument );
         bool loadOkay = _doc->LoadFile(_fileName  ) ;
@@ -748,6 +753,7 @@ namespace marlin{
 
         }
 
+        _includedFiles.push_back( refFileName ) ;
         checkForNestedIncludes( &document ) ;
 
     }
@@ -35,7 +35,32 @@ namespace marlin {
            <<  "   <parameter name=\"ColoredConsole\"> true </parameter>" << std::endl
            <<  "   <!--parameter name=\"LogFileName\"> marlin.log </parameter-->" << std::endl
            <<  "   <!-- For parallel application, this parameter specifies the number of cores to use -->" << std::endl
+           <<  "   <!-- auto uses the CPUs available to the process (affinity mask, cgroup cpuset and CPU quota) -->" << std::endl
            <<  "   <parameter name=\"Concurrency\"> auto </parameter>" << std::endl
+           <<  "   <!-- Worker thread pinning: none, compact, scatter, numa or a CPU list (e.g 0-7,16-23) -->" << std::endl
+           <<  "   <!--parameter name=\"Affinity\"> none </parameter-->" << std::endl
+           <<  "   <!-- Adjust the number of active workers at runtime (hill climbing on the event throughput) -->" << std::endl
+           <<  "   <!--parameter name=\"AdaptiveConcurrency\"> false </parameter-->" << std::endl
+           <<  "   <!--parameter name=\"AdaptiveInterval\"> 2 </parameter-->" << std::endl
+           <<  "   <!-- Size the event queue from the measured event processing times and reader latency -->" << std::endl
+           <<  "   <!--parameter name=\"AdaptiveQueueDepth\"> true </parameter-->" << std::endl
+           <<  "   <!-- The maximum number of events in memory in the scheduler (default 4 x Concurrency) -->" << std::endl
+           <<  "   <!--parameter name=\"MaxEventsInFlight\"> 32 </parameter-->" << std::endl
+           <<  "   <!-- Wall time budget per event in seconds (0: none). Use the processor parameter ProcessorTimeBudget for per processor budgets -->" << std::endl
+           <<  "   <!--parameter name=\"EventTimeBudget\"> 0 </parameter-->" << std::endl
+           <<  "   <!-- Calibration run: measure the processors and propose their ProcessorClone/ProcessorCritical options -->" << std::endl
+           <<  "   <!-- The proposals are written in RuntimeCalibrationFile, read back by processors setting these options to auto -->" << std::endl
+           <<  "   <!--parameter name=\"RuntimeCalibration\"> false </parameter-->" << std::endl
+           <<  "   <!--parameter name=\"RuntimeCalibrationFile\"> MarlinRuntimeOptions.xml </parameter-->" << std::endl
+           <<  "   <!-- Whether to evaluate the event selection of the first processor in the data source, when possible -->" << std::endl
+           <<  "   <!--parameter name=\"EventFilterPushdown\"> true </parameter-->" << std::endl
+           <<  "   <!-- Whether to run the init() and end() of distinct processors concurrently (clones always are) -->" << std::endl
+           <<  "   <!--parameter name=\"ParallelInit\"> false </parameter-->" << std::endl
+           <<  "   <!-- The output file of the histograms booked via ProcessorApi (.json, or .root if built with MARLIN_BOOK) -->" << std::endl
+           <<  "   <!--parameter name=\"BookStoreFile\"> MarlinBookStore.json </parameter-->" << std::endl
+           <<  "   <!-- Write a checkpoint every CheckpointInterval seconds, to resume the job with marlin -r after a failure -->" << std::endl
+           <<  "   <!--parameter name=\"CheckpointFile\"> MarlinCheckpoint.txt </parameter-->" << std::endl
+           <<  "   <!--parameter name=\"CheckpointInterval\"> 600 </parameter-->" << std::endl
     		   <<  "   <parameter name=\"Verbosity\" options=\"DEBUG0-4,MESSAGE0-4,WARNING0-4,ERROR0-4,SILENT\"> DEBUG  </parameter> " << std::endl
     		   <<  "   <parameter name=\"RandomSeed\" value=\"1234567890\" />" << std::endl
            <<  "   <!-- Turn on this parameter to output the full steering file with processed includes -->"
@@ -50,6 +75,8 @@ namespace marlin {
            <<  "   <parameter name=\"SkipNEvents\" value=\"0\" />  " << std::endl
            <<  "   <!-- optionally limit the collections that are read from the input file: -->  " << std::endl
            <<  "   <!--parameter name=\"LCIOReadCollectionNames\">MCParticle PandoraPFOs</parameter-->" << std::endl
+           <<  "   <!-- by default, only the collections used by the active processors are read -->  " << std::endl
+           <<  "   <!--parameter name=\"AutoReadCollectionNames\"> true </parameter-->" << std::endl
            <<  " </datasource>" << std::endl
            << std::endl ;
 
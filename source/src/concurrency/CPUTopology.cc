@@ -0,0 +1,365 @@
+#include <marlin/concurrency/CPUTopology.h>
+
+// -- marlin headers
+#include <marlin/Exceptions.h>
+
+// -- std headers
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+
+#ifdef __linux__
+#include <sched.h>
+#include <pthread.h>
+#include <dirent.h>
+#endif
+
+namespace marlin {
+
+  namespace concurrency {
+
+    namespace {
+
+      /// Read the first line of a file. Returns false if the file can't be read
+      bool readLine( const std::string &fname, std::string &line ) {
+        std::ifstream file( fname ) ;
+        if( not file ) {
+          return false ;
+        }
+        return static_cast<bool>( std::getline( file, line ) ) ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+
+    std::size_t CPUTopology::availableConcurrency() {
+      std::size_t ccy = std::thread::hardware_concurrency() ;
+      const auto allowed = allowedCPUs().size() ;
+      if( allowed > 0 and ( 0 == ccy or allowed < ccy ) ) {
+        ccy = allowed ;
+      }
+      const double quota = cgroupCPUQuota() ;
+      if( quota > 0. ) {
+        const auto quotaCPUs = static_cast<std::size_t>( std::ceil( quota ) ) ;
+        if( 0 == ccy or quotaCPUs < ccy ) {
+          ccy = quotaCPUs ;
+        }
+      }
+      return std::max( ccy, std::size_t(1) ) ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    double CPUTopology::cgroupCPUQuota() {
+#ifdef __linux__
+      try {
+        // cgroup v2: look in the process cgroup first, then at the root (container namespace)
+        const auto unified = cgroupPath( "" ) ;
+        if( not unified.empty() ) {
+          const double quota = cgroupV2Quota( "/sys/fs/cgroup" + unified + "/cpu.max" ) ;
+          if( quota > 0. ) {
+            return quota ;
+          }
+        }
+        const double rootQuota = cgroupV2Quota( "/sys/fs/cgroup/cpu.max" ) ;
+        if( rootQuota > 0. ) {
+          return rootQuota ;
+        }
+        // cgroup v1
+        const auto cpuPath = cgroupPath( "cpu" ) ;
+        for( const std::string mount : { "/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct" } ) {
+          if( not cpuPath.empty() ) {
+            const double quota = cgroupV1Quota( mount + cpuPath ) ;
+            if( quota > 0. ) {
+              return quota ;
+            }
+          }
+          const double quota = cgroupV1Quota( mount ) ;
+          if( quota > 0. ) {
+            return quota ;
+          }
+        }
+      }
+      catch( std::exception & ) {
+        // malformed cgroup files: no quota
+      }
+#endif
+      return 0. ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    double CPUTopology::cgroupV2Quota( const std::string &fname ) {
+      std::string line ;
+      if( not readLine( fname, line ) ) {
+        return 0. ;
+      }
+      std::istringstream iss( line ) ;
+      std::string quota ;
+      double period {0.} ;
+      if( not ( iss >> quota >> period ) or quota == "max" or period <= 0. ) {
+        return 0. ;
+      }
+      try {
+        return std::max( std::stod( quota ) / period, 0. ) ;
+      }
+      catch( std::exception & ) {
+        return 0. ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+
+    double CPUTopology::cgroupV1Quota( const std::string &directory ) {
+      std::string quotaStr, periodStr ;
+      if( not readLine( directory + "/cpu.cfs_quota_us", quotaStr ) or not readLine( directory + "/cpu.cfs_period_us", periodStr ) ) {
+        return 0. ;
+      }
+      try {
+        const double quota = std::stod( quotaStr ) ;
+        const double period = std::stod( periodStr ) ;
+        if( quota <= 0. or period <= 0. ) {
+          return 0. ;
+        }
+        return quota / period ;
+      }
+      catch( std::exception & ) {
+        return 0. ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+
+    std::string CPUTopology::cgroupPath( const std::string &controller, const std::string &fname ) {
+      std::ifstream file( fname ) ;
+      std::string line ;
+      while( std::getline( file, line ) ) {
+        // format: hierarchy-ID:controller-list:cgroup-path
+        const auto first = line.find( ':' ) ;
+        const auto second = line.find( ':', first + 1 ) ;
+        if( std::string::npos == first or std::string::npos == second ) {
+          continue ;
+        }
+        const auto controllers = line.substr( first + 1, second - first - 1 ) ;
+        if( controller.empty() ) {
+          if( controllers.empty() ) {
+            return line.substr( second + 1 ) ;
+          }
+          continue ;
+        }
+        std::istringstream iss( controllers ) ;
+        std::string token ;
+        while( std::getline( iss, token, ',' ) ) {
+          if( token == controller ) {
+            return line.substr( second + 1 ) ;
+          }
+        }
+      }
+      return "" ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    CPUTopology::CPUList CPUTopology::allowedCPUs() {
+      CPUList cpus ;
+#ifdef __linux__
+      cpu_set_t set ;
+      CPU_ZERO( &set ) ;
+      if( 0 == sched_getaffinity( 0, sizeof(set), &set ) ) {
+        for( int i=0 ; i<CPU_SETSIZE ; ++i ) {
+          if( CPU_ISSET( i, &set ) ) {
+            cpus.push_back( i ) ;
+          }
+        }
+      }
+#endif
+      if( cpus.empty() ) {
+        for( unsigned int i=0 ; i<std::thread::hardware_concurrency() ; ++i ) {
+          cpus.push_back( i ) ;
+        }
+      }
+      return cpus ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    CPUTopology::NodeMap CPUTopology::numaNodes() {
+      const auto allowed = allowedCPUs() ;
+      NodeMap nodes ;
+#ifdef __linux__
+      const std::string nodeDirectory = "/sys/devices/system/node" ;
+      DIR *dir = opendir( nodeDirectory.c_str() ) ;
+      if( nullptr != dir ) {
+        struct dirent *entry = nullptr ;
+        while( nullptr != ( entry = readdir( dir ) ) ) {
+          const std::string name = entry->d_name ;
+          if( name.size() <= 4 or name.compare( 0, 4, "node" ) != 0 or not std::isdigit( name[4] ) ) {
+            continue ;
+          }
+          std::string line ;
+          if( not readLine( nodeDirectory + "/" + name + "/cpulist", line ) ) {
+            continue ;
+          }
+          CPUList nodeCPUs ;
+          for( auto cpu : parseCPUList( line ) ) {
+            if( std::find( allowed.begin(), allowed.end(), cpu ) != allowed.end() ) {
+              nodeCPUs.push_back( cpu ) ;
+            }
+          }
+          if( not nodeCPUs.empty() ) {
+            nodes[ std::stoi( name.substr( 4 ) ) ] = nodeCPUs ;
+          }
+        }
+        closedir( dir ) ;
+      }
+#endif
+      if( nodes.empty() ) {
+        nodes[0] = allowed ;
+      }
+      return nodes ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    CPUTopology::CPUList CPUTopology::parseCPUList( const std::string &str ) {
+      CPUList cpus ;
+      std::istringstream iss( str ) ;
+      std::string token ;
+      while( std::getline( iss, token, ',' ) ) {
+        token.erase( std::remove_if( token.begin(), token.end(), ::isspace ), token.end() ) ;
+        if( token.empty() ) {
+          continue ;
+        }
+        try {
+          const auto dash = token.find( '-' ) ;
+          if( std::string::npos == dash ) {
+            cpus.push_back( std::stoi( token ) ) ;
+            continue ;
+          }
+          const int first = std::stoi( token.substr( 0, dash ) ) ;
+          const int last = std::stoi( token.substr( dash + 1 ) ) ;
+          if( last < first ) {
+            throw Exception( "invalid range" ) ;
+          }
+          for( int cpu=first ; cpu<=last ; ++cpu ) {
+            cpus.push_back( cpu ) ;
+          }
+        }
+        catch( std::exception & ) {
+          throw Exception( "CPUTopology::parseCPUList: invalid CPU list '" + str + "'" ) ;
+        }
+      }
+      return cpus ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    std::vector<CPUTopology::CPUList> CPUTopology::workerCPUs( const std::string &mode, std::size_t nworkers ) {
+      std::vector<CPUList> workers( nworkers ) ;
+      if( mode.empty() or mode == "none" ) {
+        return workers ;
+      }
+      if( mode == "compact" ) {
+        const auto cpus = allowedCPUs() ;
+        for( std::size_t i=0 ; i<nworkers ; ++i ) {
+          workers[i] = { cpus[ i % cpus.size() ] } ;
+        }
+        return workers ;
+      }
+      if( mode == "scatter" or mode == "numa" ) {
+        const auto nodes = numaNodes() ;
+        std::vector<CPUList> nodeList ;
+        for( auto &node : nodes ) {
+          nodeList.push_back( node.second ) ;
+        }
+        if( mode == "numa" ) {
+          for( std::size_t i=0 ; i<nworkers ; ++i ) {
+            workers[i] = nodeList[ i % nodeList.size() ] ;
+          }
+          return workers ;
+        }
+        // scatter: interleave the CPUs of the different nodes
+        CPUList interleaved ;
+        for( std::size_t k=0 ; ; ++k ) {
+          bool added = false ;
+          for( auto &nodeCPUs : nodeList ) {
+            if( k < nodeCPUs.size() ) {
+              interleaved.push_back( nodeCPUs[k] ) ;
+              added = true ;
+            }
+          }
+          if( not added ) {
+            break ;
+          }
+        }
+        for( std::size_t i=0 ; i<nworkers ; ++i ) {
+          workers[i] = { interleaved[ i % interleaved.size() ] } ;
+        }
+        return workers ;
+      }
+      // explicit CPU list
+      if( not std::isdigit( mode[0] ) ) {
+        throw Exception( "CPUTopology::workerCPUs: invalid affinity mode '" + mode + "'. Expected none, compact, scatter, numa or a CPU list" ) ;
+      }
+      const auto cpus = parseCPUList( mode ) ;
+      if( cpus.empty() ) {
+        throw Exception( "CPUTopology::workerCPUs: empty CPU list" ) ;
+      }
+      // CPUs beyond CPU_SETSIZE are never in the allowed set.
+      // No check if the allowed CPUs are unknown (no affinity support)
+      const auto allowed = allowedCPUs() ;
+      for( auto cpu : cpus ) {
+        if( not allowed.empty() and not std::binary_search( allowed.begin(), allowed.end(), cpu ) ) {
+          throw Exception( "CPUTopology::workerCPUs: CPU " + std::to_string( cpu ) + " is not in the allowed CPUs (" + toString( allowed ) + ")" ) ;
+        }
+      }
+      for( std::size_t i=0 ; i<nworkers ; ++i ) {
+        workers[i] = { cpus[ i % cpus.size() ] } ;
+      }
+      return workers ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    bool CPUTopology::pinCurrentThread( const CPUList &cpus ) {
+      if( cpus.empty() ) {
+        return false ;
+      }
+#ifdef __linux__
+      cpu_set_t set ;
+      CPU_ZERO( &set ) ;
+      for( auto cpu : cpus ) {
+        if( cpu >= 0 and cpu < CPU_SETSIZE ) {
+          CPU_SET( cpu, &set ) ;
+        }
+      }
+      return ( 0 == pthread_setaffinity_np( pthread_self(), sizeof(set), &set ) ) ;
+#else
+      return false ;
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+
+    std::string CPUTopology::toString( const CPUList &cpus ) {
+      std::ostringstream oss ;
+      for( std::size_t i=0 ; i<cpus.size() ; ) {
+        std::size_t j = i ;
+        while( j+1 < cpus.size() and cpus[j+1] == cpus[j] + 1 ) {
+          ++j ;
+        }
+        oss << ( i > 0 ? "," : "" ) << cpus[i] ;
+        if( j > i ) {
+          oss << "-" << cpus[j] ;
+        }
+        i = j + 1 ;
+      }
+      return oss.str() ;
+    }
+
+  }
+
+}
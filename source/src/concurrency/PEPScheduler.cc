@@ -8,12 +8,14 @@
 #include <marlin/PluginManager.h>
 #include <marlin/EventStore.h>
 #include <marlin/RunHeader.h>
+#include <marlin/concurrency/CPUTopology.h>
 
 // -- std headers
 #include <exception>
 #include <algorithm>
 #include <iomanip>
 #include <set>
+#include <sstream>
 
 namespace marlin {
 
@@ -61,12 +63,17 @@ namespace marlin {
     ProcessorSequenceWorker::Output ProcessorSequenceWorker::process( Input && event ) {
       Output output {} ;
       output._event = event ;
+      const auto before = _sequence->totalClock() ;
+      const auto start = clock::now() ;
       try {
         _sequence->processEvent( event ) ;
       }
       catch(...) {
         output._exception = std::current_exception() ;
       }
+      output._appClock = _sequence->totalClock()._appClock - before._appClock ;
+      output._procClock = _sequence->totalClock()._procClock - before._procClock ;
+      output._serviceTime = clock::elapsed_since( start ) ;
       return output ;
     }
 
@@ -77,14 +84,21 @@ namespace marlin {
       _logger = app->createLogger( "PEPScheduler" ) ;
       preConfigure( app ) ;
       configureProcessors( app ) ;
-      configurePool() ;
+      configurePool( app ) ;
+      // the idle pool workers help with the processor init tasks
+      _superSequence->init( app ) ;
       _startTime = clock::now() ;
     }
 
     //--------------------------------------------------------------------------
 
     void PEPScheduler::end() {
-      _pool.stop(false) ;
+      // wait for the remaining events, but keep the workers
+      // alive to help with the processor end tasks
+      _pool.setAcceptPush( false ) ;
+      while( _pool.active() ) {
+        std::this_thread::sleep_for( std::chrono::microseconds(10) ) ;
+      }
       EventList events ;
       popFinishedEvents( events ) ;
       if( not _pushResults.empty() ) {
@@ -93,8 +107,10 @@ namespace marlin {
       _logger->log<MESSAGE>() << "Terminating application" << std::endl ;
       _endTime = clock::now() ;
       _superSequence->end() ;
+      _pool.stop(false) ;
       // print some statistics
       _superSequence->printStatistics( _logger ) ;
+      _superSequence->writeCalibration( _logger ) ;
       // print additional threading summary
       const auto parallelTime = clock::time_difference( _startTime, _endTime ) - _runHeaderTime ;
       double totalProcessorClock {0.0} ;
@@ -120,6 +136,17 @@ namespace marlin {
       _logger->log<MESSAGE>() << "--   Queue lock time:                " << _lockingTime << " ms" << std::endl ;
       _logger->log<MESSAGE>() << "--   Pop event time:                 " << _popTime << " ms" << std::endl ;
       _logger->log<MESSAGE>() << "--   Lock time fraction:             " << lockTimeFraction << " %" << std::endl ;
+      if( nullptr != _controller ) {
+        _logger->log<MESSAGE>() << "--   Adaptive adjustments:           " << _nAdjustments << std::endl ;
+        _logger->log<MESSAGE>() << "--   Final active workers:           " << _controller->workers() << std::endl ;
+      }
+      if( nullptr != _queueDepthEstimator ) {
+        _logger->log<MESSAGE>() << "--   Queue depth changes:            " << _nQueueDepthUpdates << std::endl ;
+        _logger->log<MESSAGE>() << "--   Event service time:             " << _queueDepthEstimator->serviceMean() * 1000. << " +/- "
+                                << _queueDepthEstimator->serviceSigma() * 1000. << " ms" << std::endl ;
+        _logger->log<MESSAGE>() << "--   Reader latency:                 " << _queueDepthEstimator->readerMean() * 1000. << " ms" << std::endl ;
+      }
+      _logger->log<MESSAGE>() << "--   Max events in flight:           " << _maxInFlight << std::endl ;
       _logger->log<MESSAGE>() << "---------------------------------------------------" << std::endl ;
     }
 
@@ -128,21 +155,25 @@ namespace marlin {
     void PEPScheduler::preConfigure( Application *app ) {
       auto globals = app->globalParameters() ;
       auto ccyStr = globals->getValue<std::string>( "Concurrency", "auto" ) ;
-      // The concurrency read from the steering file
+      // The concurrency read from the steering file.
+      // "auto" takes into account the cgroup cpuset and CPU quota
+      const std::size_t available = CPUTopology::availableConcurrency() ;
       std::size_t ccy = (ccyStr == "auto" ?
-        std::thread::hardware_concurrency() :
+        available :
         StringUtil::stringToType<std::size_t>(ccyStr) ) ;
       _logger->log<DEBUG5>() << "-- Application concurrency from steering file " << ccy << std::endl ;
       _logger->log<DEBUG5>() << "-- Hardware concurrency: " << std::thread::hardware_concurrency() << std::endl ;
+      _logger->log<DEBUG5>() << "-- Available concurrency (affinity/cgroup): " << available << std::endl ;
       if ( ccy <= 0 ) {
         _logger->log<ERROR>() << "-- Couldn't determine number of threads to use (computed=" << ccy << ")" << std::endl ;
         throw Exception( "Undefined concurrency level" ) ;
       }
       _logger->log<MESSAGE>() << "-- Application concurrency set to " << ccy << std::endl ;
-      if ( ccy > std::thread::hardware_concurrency() ) {
+      if ( ccy > available ) {
         _logger->log<WARNING>() << "-- Application concurrency higher than the number of supported threads on your machine --" << std::endl ;
         _logger->log<WARNING>() << "---- application: " << ccy << std::endl ;
         _logger->log<WARNING>() << "---- hardware:    " << std::thread::hardware_concurrency() << std::endl ;
+        _logger->log<WARNING>() << "---- available:   " << available << " (affinity/cgroup)" << std::endl ;
       }
       if ( ccy == 1 ) {
         _logger->log<WARNING>() << "-- The program will run on a single thread --" << std::endl ;
@@ -173,6 +204,7 @@ namespace marlin {
         }
         throw Exception( "PEPScheduler::configureProcessors: duplicated active processors. Check your steering file !" ) ;
       }
+      _superSequence->configureCalibration( app ) ;
       // populate processor sequences
       for ( size_t i=0 ; i<activeProcessors.size() ; ++i ) {
         auto procName = activeProcessors[ i ] ;
@@ -183,13 +215,12 @@ namespace marlin {
         }
         _superSequence->addProcessor( processorParameters ) ;
       }
-      _superSequence->init( app ) ;
       _logger->log<DEBUG5>() << "PEPScheduler configureProcessors ... DONE" << std::endl ;
     }
 
     //--------------------------------------------------------------------------
 
-    void PEPScheduler::configurePool() {
+    void PEPScheduler::configurePool( Application *app ) {
       // create N workers for N processor sequences
       _logger->log<DEBUG5>() << "configurePool ..." << std::endl ;
       _logger->log<DEBUG5>() << "Number of workers: " << _superSequence->size() << std::endl ;
@@ -197,11 +228,48 @@ namespace marlin {
         _logger->log<DEBUG>() << "Adding worker ..." << std::endl ;
         _pool.addWorker<ProcessorSequenceWorker>( _superSequence->sequence(i) ) ;
       }
+      // pin the worker threads
+      auto affinity = app->globalParameters()->getValue<std::string>( "Affinity", "none" ) ;
+      auto workerCPUs = CPUTopology::workerCPUs( affinity, _superSequence->size() ) ;
+      for( unsigned int i=0 ; i<workerCPUs.size() ; ++i ) {
+        if( not workerCPUs[i].empty() ) {
+          _logger->log<DEBUG5>() << "Worker " << i << " pinned on CPU(s) " << CPUTopology::toString( workerCPUs[i] ) << std::endl ;
+        }
+        _pool.setWorkerAffinity( i, workerCPUs[i] ) ;
+      }
+      _logger->log<MESSAGE>() << "-- Worker thread affinity: " << affinity << std::endl ;
+      // idle workers help with the tasks spawned by processors
+      _pool.setTaskQueue( &app->taskQueue() ) ;
       _logger->log<DEBUG5>() << "starting thread pool" << std::endl ;
+      // bound the number of events in memory
+      auto globals = app->globalParameters() ;
+      const std::size_t nworkers = _superSequence->size() ;
+      _maxInFlight = globals->getValue<std::size_t>( "MaxEventsInFlight", 4 * nworkers ) ;
+      if( _maxInFlight <= nworkers ) {
+        _logger->log<WARNING>() << "-- MaxEventsInFlight (" << _maxInFlight << ") <= Concurrency: some workers will starve" << std::endl ;
+        _maxInFlight = std::max( _maxInFlight, std::size_t(1) ) ;
+      }
       // start with a default small number
-      _pool.setMaxQueueSize( 2 * _superSequence->size() ) ;
+      const std::size_t maxDepth = ( _maxInFlight > nworkers ) ? _maxInFlight - nworkers : 1 ;
+      _pool.setMaxQueueSize( std::min( 2 * nworkers, maxDepth ) ) ;
       _pool.start() ;
       _pool.setAcceptPush( true ) ;
+      if( globals->getValue<bool>( "AdaptiveQueueDepth", true ) ) {
+        QueueDepthEstimator::Settings settings {} ;
+        settings._maxInFlight = _maxInFlight ;
+        _queueDepthEstimator.reset( new QueueDepthEstimator( settings ) ) ;
+      }
+      _logger->log<MESSAGE>() << "-- Adaptive queue depth " << ( nullptr != _queueDepthEstimator ? "ON" : "OFF" )
+                              << ", max events in flight: " << _maxInFlight << std::endl ;
+      // runtime adjustment of the number of workers
+      if( globals->getValue<bool>( "AdaptiveConcurrency", false ) ) {
+        ThroughputController::Settings settings {} ;
+        settings._maxWorkers = _superSequence->size() ;
+        settings._interval = globals->getValue<double>( "AdaptiveInterval", 2. ) ;
+        _controller.reset( new ThroughputController( settings ) ) ;
+        _logger->log<MESSAGE>() << "-- Adaptive concurrency ON, max workers: " << settings._maxWorkers
+                                << ", interval: " << settings._interval << " s" << std::endl ;
+      }
       _logger->log<DEBUG5>() << "configurePool ... DONE" << std::endl ;
     }
 
@@ -233,6 +301,9 @@ namespace marlin {
       auto start = clock::now() ;
       _pushResults.push_back( _pool.push( WorkerPool::PushPolicy::ThrowIfFull, std::move(event) ) ) ;
       _lockingTime += clock::elapsed_since<clock::milliseconds>( start ) ;
+      // the reader latency is measured until the next call to freeSlots()
+      _lastPushTime = clock::now() ;
+      _readerPending = true ;
     }
 
     //--------------------------------------------------------------------------
@@ -249,19 +320,84 @@ namespace marlin {
             std::rethrow_exception( output._exception ) ;
           }
           _logger->log<MESSAGE>() << "Finished event uid " << output._event->uid() << std::endl ;
+          if( nullptr != _controller ) {
+            updateController( output ) ;
+          }
+          if( nullptr != _queueDepthEstimator ) {
+            _queueDepthEstimator->addServiceTime( output._serviceTime ) ;
+            ++ _nPoppedSinceUpdate ;
+          }
           events.push_back( output._event ) ;
           iter = _pushResults.erase( iter ) ;
           continue;
         }
         ++iter ;
       }
+      if( nullptr != _queueDepthEstimator and _nPoppedSinceUpdate >= _pool.activeWorkers() ) {
+        updateQueueDepth() ;
+      }
       _popTime += clock::elapsed_since<clock::milliseconds>( start ) ;
     }
 
     //--------------------------------------------------------------------------
 
+    void PEPScheduler::updateController( const WorkerOutput &output ) {
+      _controller->addEvent( output._appClock, output._procClock ) ;
+      ThroughputController::Decision decision {} ;
+      if( not _controller->update( decision ) ) {
+        return ;
+      }
+      const bool changed = ( decision._workers != _pool.activeWorkers() ) ;
+      std::stringstream message ;
+      message << "Adaptive concurrency: " << decision._reason << " [workers: " << decision._workers << "]" ;
+      if( not changed ) {
+        _logger->log<DEBUG5>() << message.str() << std::endl ;
+        return ;
+      }
+      _logger->log<MESSAGE>() << message.str() << std::endl ;
+      _pool.setActiveWorkers( decision._workers ) ;
+      ++ _nAdjustments ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void PEPScheduler::updateQueueDepth() {
+      _nPoppedSinceUpdate = 0 ;
+      if( not _queueDepthEstimator->ready() ) {
+        return ;
+      }
+      const auto depth = _queueDepthEstimator->estimate( _pool.activeWorkers() ) ;
+      if( depth == _pool.maxQueueSize() ) {
+        return ;
+      }
+      _logger->log<DEBUG5>() << "Adaptive queue depth: " << _pool.maxQueueSize() << " -> " << depth
+                             << " [service time: " << _queueDepthEstimator->serviceMean() * 1000. << " +/- "
+                             << _queueDepthEstimator->serviceSigma() * 1000. << " ms, reader latency: "
+                             << _queueDepthEstimator->readerMean() * 1000. << " ms]" << std::endl ;
+      _pool.setMaxQueueSize( depth ) ;
+      ++ _nQueueDepthUpdates ;
+    }
+
+    //--------------------------------------------------------------------------
+
     std::size_t PEPScheduler::freeSlots() const {
-      return _pool.freeSlots() ;
+      // first call after a push: the reader has read and prepared the next event
+      if( _readerPending ) {
+        _readerPending = false ;
+        if( nullptr != _queueDepthEstimator ) {
+          _queueDepthEstimator->addReaderTime( clock::elapsed_since( _lastPushTime ) ) ;
+        }
+      }
+      // events finished but not popped yet are still in memory
+      const std::size_t inFlight = _pushResults.size() ;
+      const std::size_t inFlightSlots = ( inFlight < _maxInFlight ) ? _maxInFlight - inFlight : 0 ;
+      return std::min( _pool.freeSlots(), inFlightSlots ) ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    std::size_t PEPScheduler::concurrency() const {
+      return ( nullptr != _superSequence ) ? _superSequence->size() : 0 ;
     }
 
   }
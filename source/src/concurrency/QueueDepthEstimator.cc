@@ -0,0 +1,90 @@
+#include <marlin/concurrency/QueueDepthEstimator.h>
+
+// -- marlin headers
+#include <marlin/Exceptions.h>
+
+// -- std headers
+#include <algorithm>
+#include <cmath>
+
+namespace marlin {
+
+  namespace concurrency {
+
+    QueueDepthEstimator::QueueDepthEstimator( const Settings &settings ) :
+      _settings(settings) {
+      if( 0 == _settings._maxInFlight ) {
+        throw Exception( "QueueDepthEstimator: maximum number of events in flight must be > 0" ) ;
+      }
+      _alpha = 2. / ( std::max( _settings._window, std::size_t(1) ) + 1. ) ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void QueueDepthEstimator::addServiceTime( double seconds ) {
+      if( 0 == _nServiceSamples ) {
+        _serviceMean = seconds ;
+        _serviceVariance = 0. ;
+      }
+      else {
+        // exponentially weighted mean and variance
+        const double diff = seconds - _serviceMean ;
+        const double incr = _alpha * diff ;
+        _serviceMean += incr ;
+        _serviceVariance = ( 1. - _alpha ) * ( _serviceVariance + diff * incr ) ;
+      }
+      ++ _nServiceSamples ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void QueueDepthEstimator::addReaderTime( double seconds ) {
+      _readerMean = ( 0 == _nReaderSamples ) ? seconds : _readerMean + _alpha * ( seconds - _readerMean ) ;
+      ++ _nReaderSamples ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    bool QueueDepthEstimator::ready() const {
+      return ( _nServiceSamples >= _settings._minSamples ) ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    std::size_t QueueDepthEstimator::estimate( std::size_t workers ) const {
+      workers = std::max( workers, std::size_t(1) ) ;
+      const std::size_t maxDepth = ( _settings._maxInFlight > workers ) ? _settings._maxInFlight - workers : 1 ;
+      if( _serviceMean <= 0. ) {
+        return maxDepth ;
+      }
+      const double refill = workers * ( _readerMean + _settings._pollLatency ) / _serviceMean ;
+      const double cv = serviceSigma() / _serviceMean ;
+      const double fluctuations = _settings._safety * cv * std::sqrt( static_cast<double>( workers ) ) ;
+      const double depth = std::ceil( refill ) + std::ceil( fluctuations ) + 1. ;
+      if( depth >= static_cast<double>( maxDepth ) ) {
+        return maxDepth ;
+      }
+      return std::max( static_cast<std::size_t>( depth ), std::size_t(1) ) ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    double QueueDepthEstimator::serviceMean() const {
+      return _serviceMean ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    double QueueDepthEstimator::serviceSigma() const {
+      return std::sqrt( std::max( _serviceVariance, 0. ) ) ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    double QueueDepthEstimator::readerMean() const {
+      return _readerMean ;
+    }
+
+  }
+
+}
@@ -0,0 +1,128 @@
+#include <marlin/concurrency/TaskGroup.h>
+
+// -- std headers
+#include <chrono>
+
+namespace marlin {
+
+  namespace concurrency {
+
+    void TaskQueue::push( Task task, const TaskGroup *group ) {
+      {
+        std::lock_guard<std::mutex> lock( _mutex ) ;
+        _tasks.emplace_back( group, std::move( task ) ) ;
+      }
+      if( nullptr != _notifier ) {
+        _notifier() ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+
+    bool TaskQueue::runOne( const TaskGroup *group ) {
+      Task task {nullptr} ;
+      {
+        std::lock_guard<std::mutex> lock( _mutex ) ;
+        auto iter = _tasks.begin() ;
+        if( nullptr != group ) {
+          iter = std::find_if( _tasks.begin(), _tasks.end(), [group]( const std::pair<const TaskGroup*, Task> &entry ) {
+            return entry.first == group ;
+          }) ;
+        }
+        if( _tasks.end() == iter ) {
+          return false ;
+        }
+        task = std::move( iter->second ) ;
+        _tasks.erase( iter ) ;
+      }
+      task() ;
+      return true ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    bool TaskQueue::empty() const {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      return _tasks.empty() ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void TaskQueue::setNotifier( Notifier notifier ) {
+      _notifier = notifier ;
+    }
+
+    //--------------------------------------------------------------------------
+    //--------------------------------------------------------------------------
+
+    TaskGroup::TaskGroup( TaskQueue &queue ) :
+      _queue(queue) {
+      /* nop */
+    }
+
+    //--------------------------------------------------------------------------
+
+    TaskGroup::~TaskGroup() {
+      waitNoThrow() ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void TaskGroup::run( std::function<void()> function ) {
+      ++ _pending ;
+      _queue.push( [this, function]() {
+        std::exception_ptr exception {nullptr} ;
+        try {
+          function() ;
+        }
+        catch( ... ) {
+          exception = std::current_exception() ;
+        }
+        taskDone( exception ) ;
+      }, this ) ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void TaskGroup::wait( bool helpOthers ) {
+      waitNoThrow( helpOthers ) ;
+      std::exception_ptr exception {nullptr} ;
+      {
+        std::lock_guard<std::mutex> lock( _mutex ) ;
+        std::swap( exception, _exception ) ;
+      }
+      if( nullptr != exception ) {
+        std::rethrow_exception( exception ) ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void TaskGroup::waitNoThrow( bool helpOthers ) {
+      while( _pending.load() > 0 ) {
+        // help: run a queued task, ours or not unless told otherwise
+        if( _queue.runOne( helpOthers ? nullptr : this ) ) {
+          continue ;
+        }
+        // our remaining tasks run in other threads
+        std::unique_lock<std::mutex> lock( _mutex ) ;
+        _conditionVariable.wait_for( lock, std::chrono::microseconds(100), [this]() {
+          return ( 0 == _pending.load() ) ;
+        }) ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void TaskGroup::taskDone( std::exception_ptr exception ) {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      if( nullptr != exception and nullptr == _exception ) {
+        _exception = exception ;
+      }
+      -- _pending ;
+      _conditionVariable.notify_all() ;
+    }
+
+  }
+
+}
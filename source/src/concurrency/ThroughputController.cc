@@ -0,0 +1,128 @@
+#include <marlin/concurrency/ThroughputController.h>
+
+// -- marlin headers
+#include <marlin/Exceptions.h>
+
+// -- std headers
+#include <algorithm>
+#include <sstream>
+
+namespace marlin {
+
+  namespace concurrency {
+
+    ThroughputController::ThroughputController( const Settings &settings ) :
+      _settings(settings) {
+      if( 0 == _settings._maxWorkers ) {
+        throw Exception( "ThroughputController: maximum number of workers must be > 0" ) ;
+      }
+      if( _settings._interval <= 0. ) {
+        throw Exception( "ThroughputController: measurement interval must be > 0" ) ;
+      }
+      _workers = _settings._maxWorkers ;
+      _previousWorkers = _workers ;
+      _intervalStart = clock::now() ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void ThroughputController::addEvent( clock::duration_rep appTime, clock::duration_rep procTime ) {
+      ++ _nEvents ;
+      _appTime += appTime ;
+      _procTime += procTime ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    bool ThroughputController::update( Decision &decision ) {
+      const auto now = clock::now() ;
+      const auto elapsed = clock::time_difference<clock::seconds>( _intervalStart, now ) ;
+      if( elapsed < _settings._interval or _nEvents < _settings._minEvents ) {
+        return false ;
+      }
+      const double throughput = _nEvents / elapsed ;
+      const double lockFraction = ( _appTime > 0. ) ? std::max( 0., ( _appTime - _procTime ) / _appTime ) : 0. ;
+      // reset the interval
+      _intervalStart = now ;
+      _nEvents = 0 ;
+      _appTime = 0. ;
+      _procTime = 0. ;
+      // smooth the throughput of the current number of workers
+      auto iter = _throughputs.find( _workers ) ;
+      if( _throughputs.end() == iter ) {
+        _throughputs[ _workers ] = throughput ;
+      }
+      else {
+        iter->second = 0.5 * iter->second + 0.5 * throughput ;
+      }
+      auto step = [this]( int direction ) {
+        if( direction < 0 ) {
+          return ( _workers > 1 ) ? _workers - 1 : _workers ;
+        }
+        return ( _workers < _settings._maxWorkers ) ? _workers + 1 : _workers ;
+      } ;
+      std::ostringstream reason ;
+      if( _probing ) {
+        auto previous = _throughputs.find( _previousWorkers ) ;
+        if( _throughputs.end() != previous and throughput < previous->second * ( 1. - _settings._tolerance ) ) {
+          reason << "throughput dropped (" << previous->second << " -> " << throughput << " evt/s) with "
+                 << _workers << " workers, revert to " << _previousWorkers ;
+          _workers = _previousWorkers ;
+          _direction = -_direction ;
+          _probing = false ;
+          _holdCounter = _settings._holdIntervals ;
+        }
+        else {
+          const auto next = step( _direction ) ;
+          if( next != _workers ) {
+            reason << "throughput kept (" << throughput << " evt/s) with " << _workers << " workers, continue to " << next ;
+            _previousWorkers = _workers ;
+            _workers = next ;
+          }
+          else {
+            reason << "bound reached with " << _workers << " workers (" << throughput << " evt/s), hold" ;
+            _probing = false ;
+            _holdCounter = _settings._holdIntervals ;
+          }
+        }
+      }
+      else if( _holdCounter > 0 ) {
+        -- _holdCounter ;
+        reason << "hold " << _workers << " workers (" << throughput << " evt/s)" ;
+      }
+      else {
+        if( lockFraction > _settings._lockThreshold ) {
+          _direction = -1 ;
+        }
+        auto next = step( _direction ) ;
+        if( next == _workers ) {
+          _direction = -_direction ;
+          next = step( _direction ) ;
+        }
+        if( next != _workers ) {
+          reason << "probe " << next << " workers (" << throughput << " evt/s with " << _workers
+                 << ", lock-wait fraction " << lockFraction << ")" ;
+          _previousWorkers = _workers ;
+          _workers = next ;
+          _probing = true ;
+        }
+        else {
+          reason << "single worker, nothing to probe" ;
+        }
+      }
+      decision._workers = _workers ;
+      decision._throughput = throughput ;
+      decision._lockFraction = lockFraction ;
+      decision._reason = reason.str() ;
+      return true ;
+    }
+
+    //--------------------------------------------------------------------------
+
+    std::size_t ThroughputController::workers() const {
+      return _workers ;
+    }
+
+  }
+
+}
@@ -53,6 +53,8 @@ namespace marlin {
     // usually a good idea to
     printParameters() ;
     ProcessorApi::registerForRandomSeeds( this ) ;
+    // no collection used
+    ProcessorApi::requireCollections( this, {} ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -68,5 +70,5 @@ namespace marlin {
   }
 
   // processor declaration
-  MARLIN_DECLARE_PROCESSOR( CPUCrunchingProcessor )
+  MARLIN_DECLARE_PROCESSOR_NAME( CPUCrunchingProcessor, "CPUCrunching" )
 }
@@ -1,6 +1,7 @@
 
 // -- marlin headers
 #include <marlin/Processor.h>
+#include <marlin/ProcessorApi.h>
 #include <marlin/PluginManager.h>
 
 // -- std headers
@@ -67,6 +68,8 @@ namespace marlin {
   void MemoryMonitorProcessor::init() {
   	// Print the initial parameters
   	printParameters() ;
+  	// no collection used
+  	ProcessorApi::requireCollections( this, {} ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -99,5 +102,5 @@ namespace marlin {
   }
 
   // plugin declaration
-  MARLIN_DECLARE_PROCESSOR( MemoryMonitorProcessor )
+  MARLIN_DECLARE_PROCESSOR_NAME( MemoryMonitorProcessor, "MemoryMonitor" )
 }
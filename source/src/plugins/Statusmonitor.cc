@@ -1,6 +1,7 @@
 
 // -- marlin headers
 #include <marlin/Processor.h>
+#include <marlin/ProcessorApi.h>
 #include <marlin/PluginManager.h>
 #include <marlin/Logging.h>
 
@@ -71,6 +72,8 @@ namespace marlin {
     log<DEBUG>() << "INIT CALLED  " << std::endl ;
     // usually a good idea to
     printParameters() ;
+    // no collection used
+    ProcessorApi::requireCollections( this, {} ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -97,5 +100,5 @@ namespace marlin {
   }
 
   // processor declaration
-  MARLIN_DECLARE_PROCESSOR( Statusmonitor )
+  MARLIN_DECLARE_PROCESSOR_NAME( Statusmonitor, "Statusmonitor" )
 }
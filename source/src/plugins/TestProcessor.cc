@@ -73,6 +73,8 @@ namespace marlin {
   //--------------------------------------------------------------------------
 
   void TestProcessor::init() {
+    // no collection used
+    ProcessorApi::requireCollections( this, {} ) ;
 
     log<MESSAGE>() << "TestProcessor::init()  " << name()
 			     << std::endl
@@ -148,5 +150,5 @@ namespace marlin {
   }
 
   // processor declaration
-  MARLIN_DECLARE_PROCESSOR( TestProcessor )
+  MARLIN_DECLARE_PROCESSOR_NAME( TestProcessor, "TestProcessor" )
 }
@@ -60,7 +60,7 @@ endfunction()
 #
 #
 function( marlin_add_processor_test test_name )
-  cmake_parse_arguments(ARG "" "STEERING_FILE;REGEX_PASS;REGEX_FAIL" "INPUT_FILES;MARLIN_ARGS;MARLIN_DLL" ${ARGN} )
+  cmake_parse_arguments(ARG "" "STEERING_FILE;EXECUTABLE;REGEX_PASS;REGEX_FAIL" "INPUT_FILES;MARLIN_ARGS;MARLIN_DLL;DEPENDS" ${ARGN} )
   if( NOT test_name )
     message( FATAL_ERROR "[UNIT_TESTS] Configuring processor test without name" )
   endif()
@@ -74,6 +74,11 @@ function( marlin_add_processor_test test_name )
     endif()
   endforeach()
   set( MARLIN_INPUT_FILES ${ARG_INPUT_FILES} )
+  # Marlin (serial) by default, e.g MarlinMT for multi-threaded tests
+  set( MARLIN_EXECUTABLE Marlin )
+  if( ARG_EXECUTABLE )
+    set( MARLIN_EXECUTABLE ${ARG_EXECUTABLE} )
+  endif()
   get_filename_component( MARLIN_STEERING_FILE ${ARG_STEERING_FILE} NAME )
   # set( MARLIN_STEERING_FILE ${ARG_STEERING_FILE} )
   foreach( marg ${ARG_MARLIN_ARGS} )
@@ -105,6 +110,10 @@ function( marlin_add_processor_test test_name )
   if( NOT "${ARG_REGEX_FAIL}" STREQUAL "" )
     set_tests_properties( t_processor_${test_name} PROPERTIES FAIL_REGULAR_EXPRESSION "${ARG_REGEX_FAIL}" )
   endif()
+  # Set test dependencies if present, e.g jobs using the output of other jobs
+  foreach ( _dep ${ARG_DEPENDS} )
+    set_tests_properties( t_processor_${test_name} PROPERTIES DEPENDS t_processor_${_dep} )
+  endforeach()
 endfunction()
 
 
@@ -0,0 +1,132 @@
+// -- marlin headers
+#include "marlin/Processor.h"
+#include "marlin/Logging.h"
+#include "marlin/ProcessorApi.h"
+#include "marlin/PluginManager.h"
+
+// -- lcio headers
+#include "lcio.h"
+#include "IO/LCReader.h"
+#include "IOIMPL/LCFactory.h"
+#include "EVENT/LCEvent.h"
+#include "EVENT/LCCollection.h"
+
+// -- std headers
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace marlin ;
+
+/**
+ *  Test processor for the checkpoint and resume of a job.
+ *  With KillAtEvent, the job is killed without any cleanup once this number
+ *  of events is processed, as on a node failure. With ReferenceFile, the
+ *  events of the job are compared to the ones of the reference file, read
+ *  in the same order (serial job only).
+ */
+class TestCheckpoint : public Processor {
+ public:
+  TestCheckpoint() ;
+
+  /** Called at the begin of the job before anything is read.
+   */
+  void init() override ;
+
+  /** Called for every event - the working horse.
+   */
+  void processEvent( EventStore * evt ) override ;
+
+  /** Called after data processing for clean up.
+   */
+  void end() override ;
+
+ protected:
+  Property<int> _killAtEvent {this, "KillAtEvent",
+           "Kill the job once this number of events is processed (0: never)", 0 } ;
+
+  Property<std::string> _referenceFile {this, "ReferenceFile",
+           "The LCIO file to compare the events with (empty: no comparison)", "" } ;
+
+  std::unique_ptr<IO::LCReader> _reader {nullptr} ;
+  int _nEvt = {0} ;
+  int _nDiff = {0} ;
+} ;
+
+//--------------------------------------------------------------------------
+//--------------------------------------------------------------------------
+
+TestCheckpoint::TestCheckpoint() : Processor("TestCheckpoint") {
+  _description = "TestCheckpoint kills a job or compares its events with a reference file to test checkpoints" ;
+}
+
+//--------------------------------------------------------------------------
+
+void TestCheckpoint::init() {
+  ProcessorApi::requireAllCollections( this ) ;
+  if( not _referenceFile.get().empty() ) {
+    _reader.reset( IOIMPL::LCFactory::getInstance()->createLCReader() ) ;
+    _reader->open( _referenceFile ) ;
+  }
+}
+
+//--------------------------------------------------------------------------
+
+void TestCheckpoint::processEvent( EventStore * evt ) {
+  // shared by the processor instances of all workers
+  static std::atomic<int> processed {0} ;
+  if( _killAtEvent > 0 and ++processed >= _killAtEvent ) {
+    log<MESSAGE>() << "TestCheckpoint: job killed after " << _killAtEvent.get() << " events" << std::endl ;
+    std::cout.flush() ;
+    std::_Exit( 1 ) ;
+  }
+  if( nullptr == _reader ) {
+    return ;
+  }
+  auto event = evt->event<EVENT::LCEvent>() ;
+  auto reference = _reader->readNextEvent() ;
+  ++_nEvt ;
+  if( nullptr == reference ) {
+    log<ERROR>() << "Event " << event->getEventNumber() << " of run " << event->getRunNumber()
+      << " differs from the reference: no more reference events" << std::endl ;
+    ++_nDiff ;
+    return ;
+  }
+  bool same = ( event->getRunNumber() == reference->getRunNumber() and event->getEventNumber() == reference->getEventNumber() ) ;
+  auto names = *event->getCollectionNames() ;
+  auto referenceNames = *reference->getCollectionNames() ;
+  std::sort( names.begin(), names.end() ) ;
+  std::sort( referenceNames.begin(), referenceNames.end() ) ;
+  same = same and ( names == referenceNames ) ;
+  for( std::size_t i=0 ; same and i<names.size() ; ++i ) {
+    same = ( event->getCollection( names[i] )->getNumberOfElements() == reference->getCollection( names[i] )->getNumberOfElements() ) ;
+  }
+  if( not same ) {
+    log<ERROR>() << "Event " << event->getEventNumber() << " of run " << event->getRunNumber()
+      << " differs from the reference (event " << reference->getEventNumber() << " of run " << reference->getRunNumber() << ")" << std::endl ;
+    ++_nDiff ;
+  }
+}
+
+//--------------------------------------------------------------------------
+
+void TestCheckpoint::end() {
+  if( nullptr == _reader ) {
+    return ;
+  }
+  if( nullptr != _reader->readNextEvent() ) {
+    log<ERROR>() << "Job output differs from the reference: more reference events than the " << _nEvt << " event(s) read" << std::endl ;
+    ++_nDiff ;
+  }
+  _reader->close() ;
+  if( 0 == _nDiff ) {
+    log<MESSAGE>() << "TestCheckpoint: " << _nEvt << " event(s) identical to the reference" << std::endl ;
+  }
+}
+
+MARLIN_DECLARE_PROCESSOR_NAME( TestCheckpoint, "TestCheckpoint" )
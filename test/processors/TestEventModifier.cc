@@ -82,4 +82,4 @@ void TestEventModifier::end() {
 			  << std::endl ;
 }
 
-MARLIN_DECLARE_PROCESSOR( TestEventModifier )
+MARLIN_DECLARE_PROCESSOR_NAME( TestEventModifier, "TestEventModifier" )
@@ -0,0 +1,88 @@
+
+// -- marlin headers
+#include "marlin/Processor.h"
+#include "marlin/Logging.h"
+#include "marlin/ProcessorApi.h"
+#include "marlin/PluginManager.h"
+
+// -- std headers
+#include <memory>
+#include <vector>
+
+using namespace marlin ;
+
+/**
+ *  Test processor for the processor replication (Processor::clone()).
+ *  The replicas are not initialized: they must get the shared state
+ *  from the prototype and random seeds from the framework.
+ */
+class TestProcessorClone : public Processor {
+ public:
+  TestProcessorClone() ;
+
+  /** Called at the begin of the job before anything is read.
+   */
+  void init() override ;
+
+  /** Create a replica sharing the lookup table
+   */
+  std::shared_ptr<Processor> clone() const override ;
+
+  /** Called for every event - the working horse.
+   */
+  void processEvent( EventStore * evt ) override ;
+
+  /** Called after data processing for clean up.
+   */
+  void end() override ;
+
+protected:
+  std::shared_ptr<const std::vector<unsigned int>>  _table {nullptr} ;
+  bool _replica = {false} ;
+  int _nEvt = {0} ;
+} ;
+
+//--------------------------------------------------------------------------
+//--------------------------------------------------------------------------
+
+TestProcessorClone::TestProcessorClone() : Processor("TestProcessorClone") {
+  _description = "TestProcessorClone test the processor replication with random seeds" ;
+}
+
+//--------------------------------------------------------------------------
+
+void TestProcessorClone::init() {
+  ProcessorApi::registerForRandomSeeds( this ) ;
+  _table = std::make_shared<const std::vector<unsigned int>>( 16, 42 ) ;
+}
+
+//--------------------------------------------------------------------------
+
+std::shared_ptr<Processor> TestProcessorClone::clone() const {
+  auto replica = std::make_shared<TestProcessorClone>() ;
+  replica->_table = _table ;
+  replica->_replica = true ;
+  return replica ;
+}
+
+//--------------------------------------------------------------------------
+
+void TestProcessorClone::processEvent( EventStore * evt ) {
+  // throws if the replica is not registered for random seeds
+  auto seed = ProcessorApi::getRandomSeed( this, evt ) ;
+  if( nullptr == _table ) {
+    log<ERROR>() << "Lookup table not shared with the replica" << std::endl ;
+  }
+  log<DEBUG>() << "seed " << seed << " for event uid " << evt->uid() << std::endl ;
+  ++_nEvt ;
+}
+
+//--------------------------------------------------------------------------
+
+void TestProcessorClone::end() {
+  if( _replica ) {
+    log<MESSAGE>() << "TestProcessorClone replica received random seeds for " << _nEvt << " events" << std::endl ;
+  }
+}
+
+MARLIN_DECLARE_PROCESSOR_NAME( TestProcessorClone, "TestProcessorClone" )
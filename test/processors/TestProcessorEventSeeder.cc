@@ -132,4 +132,4 @@ void TestProcessorEventSeeder::end(){
 
 }
 
-MARLIN_DECLARE_PROCESSOR( TestProcessorEventSeeder )
+MARLIN_DECLARE_PROCESSOR_NAME( TestProcessorEventSeeder, "TestProcessorEventSeeder" )
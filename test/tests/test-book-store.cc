@@ -0,0 +1,161 @@
+// -- marlin headers
+#include <marlin/BookStore.h>
+#include <marlin/Exceptions.h>
+#include <UnitTesting.h>
+
+// -- std headers
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace marlin::test ;
+using namespace marlin ;
+
+namespace {
+  std::string readFile( const std::string &fname ) {
+    std::ifstream file( fname ) ;
+    std::stringstream ss ;
+    ss << file.rdbuf() ;
+    return ss.str() ;
+  }
+
+  // fill from each worker slot in its own thread, without lock
+  template <typename FUNCTION>
+  void fillFromWorkers( std::size_t nworkers, FUNCTION function ) {
+    std::vector<std::thread> threads ;
+    for( std::size_t i=0 ; i<nworkers ; ++i ) {
+      threads.emplace_back( [&function,i]() {
+        WorkerLocalBase::setCurrentWorkerIndex( i ) ;
+        function( i ) ;
+      }) ;
+    }
+    for( auto &t : threads ) {
+      t.join() ;
+    }
+  }
+}
+
+int main( int /*argc*/, char ** /*argv*/ ) {
+
+  UnitTest test( "BookStore" ) ;
+
+  // axis bin lookup
+  HistogramAxis fixedAxis( 4, 0., 4. ) ;
+  test.test( "fixed: underflow", fixedAxis.findBin( -0.1 ), std::size_t(0) ) ;
+  test.test( "fixed: first bin", fixedAxis.findBin( 0. ), std::size_t(1) ) ;
+  test.test( "fixed: last bin", fixedAxis.findBin( 3.99 ), std::size_t(4) ) ;
+  test.test( "fixed: overflow", fixedAxis.findBin( 4. ), std::size_t(5) ) ;
+  HistogramAxis variableAxis( { 0., 1., 3., 10. } ) ;
+  test.test( "variable: nbins", variableAxis.nbins(), std::size_t(3) ) ;
+  test.test( "variable: underflow", variableAxis.findBin( -0.1 ), std::size_t(0) ) ;
+  test.test( "variable: NaN in underflow", variableAxis.findBin( std::nan("") ), std::size_t(0) ) ;
+  test.test( "variable: lower edge", variableAxis.findBin( 0. ), std::size_t(1) ) ;
+  test.test( "variable: inner edge", variableAxis.findBin( 1. ), std::size_t(2) ) ;
+  test.test( "variable: wide bin", variableAxis.findBin( 2.9 ), std::size_t(2) ) ;
+  test.test( "variable: last bin", variableAxis.findBin( 9.99 ), std::size_t(3) ) ;
+  test.test( "variable: overflow", variableAxis.findBin( 10. ), std::size_t(4) ) ;
+  bool invalidEdges {false} ;
+  try {
+    HistogramAxis( std::vector<double>{ 0., 2., 1. } ) ;
+  }
+  catch( marlin::Exception & ) {
+    invalidEdges = true ;
+  }
+  test.test( "variable: invalid edges", invalidEdges, true ) ;
+
+  // booking
+  const std::size_t nworkers = 3 ;
+  BookStore store ;
+  bool notInitialized {false} ;
+  try {
+    store.book1D( "h1", "", fixedAxis ) ;
+  }
+  catch( marlin::Exception & ) {
+    notInitialized = true ;
+  }
+  test.test( "book before init", notInitialized, true ) ;
+  store.init( nworkers, "" ) ;
+  auto &h1 = store.book1D( "dir/h1", "1D histogram", fixedAxis ) ;
+  auto &h2 = store.book2D( "h2", "2D histogram", HistogramAxis( 2, 0., 2. ), HistogramAxis( std::vector<double>{ 0., 1., 5. } ) ) ;
+  auto &profile = store.bookProfile1D( "profile", "1D profile", HistogramAxis( std::vector<double>{ 0., 1., 2. } ) ) ;
+  test.test( "shared booking", &store.book1D( "dir/h1", "1D histogram", fixedAxis ) == &h1, true ) ;
+  bool otherBinning {false} ;
+  try {
+    store.book1D( "dir/h1", "1D histogram", variableAxis ) ;
+  }
+  catch( marlin::Exception & ) {
+    otherBinning = true ;
+  }
+  test.test( "booking with another binning", otherBinning, true ) ;
+
+  // fill from several workers and from the main thread
+  fillFromWorkers( nworkers, [&]( std::size_t worker ) {
+    h1.fill( 0.5 ) ;
+    h1.fill( 2.5, 2. ) ;
+    h1.fill( -1. ) ;
+    h1.fill( 10. ) ;
+    h2.fill( 0.5, 3. ) ;
+    profile.fill( 0.5, worker + 1. ) ;
+  }) ;
+  h1.fill( 3.5 ) ;
+
+  // merged contents
+  auto data1 = h1.merged() ;
+  test.test( "1D: entries", data1.entries(), 13ULL ) ;
+  test.test( "1D: sumw", data1.sumw() == HistogramData::Bins{ 3., 3., 0., 6., 1., 3. }, true ) ;
+  test.test( "1D: sumw2", data1.sumw2() == HistogramData::Bins{ 3., 3., 0., 12., 1., 3. }, true ) ;
+  test.test( "1D: underflow", data1.sumw().front(), 3. ) ;
+  test.test( "1D: overflow", data1.sumw().back(), 3. ) ;
+  auto data2 = h2.merged() ;
+  test.test( "2D: entries", data2.entries(), 3ULL ) ;
+  test.test( "2D: bins", data2.sumw().size(), std::size_t(16) ) ;
+  test.test( "2D: bin index", data2.bin( 0.5, 3. ), std::size_t(9) ) ;
+  test.test( "2D: content", data2.sumw()[9], 3. ) ;
+  auto dataProfile = profile.merged() ;
+  test.test( "profile: entries", dataProfile.entries(), 3ULL ) ;
+  test.test( "profile: sumw", dataProfile.sumw()[1], 3. ) ;
+  test.test( "profile: sumwy", dataProfile.sumwy()[1], 6. ) ;
+  test.test( "profile: sumwy2", dataProfile.sumwy2()[1], 14. ) ;
+  test.test( "merge twice", h1.merged().entries(), 13ULL ) ;
+
+  // JSON output
+  char tmpl[] = "/tmp/marlin-bookstore-XXXXXX" ;
+  const std::string directory = mkdtemp( tmpl ) ;
+  store.writeJSON( directory + "/histograms.json" ) ;
+  const auto json = readFile( directory + "/histograms.json" ) ;
+  auto contains = [&json]( const std::string &str ) {
+    return ( std::string::npos != json.find( str ) ) ;
+  } ;
+  test.test( "json: 1D path", contains( "\"path\": \"dir/h1\"" ), true ) ;
+  test.test( "json: 1D title", contains( "\"title\": \"1D histogram\"" ), true ) ;
+  test.test( "json: 1D type", contains( "\"type\": \"H1\"" ), true ) ;
+  test.test( "json: 1D entries", contains( "\"entries\": 13," ), true ) ;
+  test.test( "json: 1D fixed axis", contains( "\"axes\": [{ \"nbins\": 4, \"min\": 0, \"max\": 4 }]" ), true ) ;
+  test.test( "json: 1D sumw", contains( "\"sumw\": [3,3,0,6,1,3]" ), true ) ;
+  test.test( "json: 1D sumw2", contains( "\"sumw2\": [3,3,0,12,1,3]" ), true ) ;
+  test.test( "json: 2D type", contains( "\"type\": \"H2\"" ), true ) ;
+  test.test( "json: 2D axes", contains( "\"axes\": [{ \"nbins\": 2, \"min\": 0, \"max\": 2 }, { \"nbins\": 2, \"min\": 0, \"max\": 5, \"edges\": [0,1,5] }]" ), true ) ;
+  test.test( "json: 2D sumw", contains( "\"sumw\": [0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0]" ), true ) ;
+  test.test( "json: profile type", contains( "\"type\": \"Profile1\"" ), true ) ;
+  test.test( "json: profile variable axis", contains( "\"axes\": [{ \"nbins\": 2, \"min\": 0, \"max\": 2, \"edges\": [0,1,2] }]" ), true ) ;
+  test.test( "json: profile sumwy", contains( "\"sumwy\": [0,6,0,0]" ), true ) ;
+  test.test( "json: profile sumwy2", contains( "\"sumwy2\": [0,14,0,0]" ), true ) ;
+  test.test( "json: no profile sums for histograms", json.find( "\"sumwy\"" ) == json.rfind( "\"sumwy\"" ), true ) ;
+
+  // output file written on end()
+  BookStore output ;
+  output.init( nworkers, directory + "/end.json" ) ;
+  output.end() ;
+  test.test( "no histogram, no output", std::ifstream( directory + "/end.json" ).good(), false ) ;
+  output.book1D( "h1", "", fixedAxis ).fill( 1.5 ) ;
+  output.end() ;
+  test.test( "output on end", readFile( directory + "/end.json" ).find( "\"entries\": 1," ) != std::string::npos, true ) ;
+  unlink( ( directory + "/histograms.json" ).c_str() ) ;
+  unlink( ( directory + "/end.json" ).c_str() ) ;
+  rmdir( directory.c_str() ) ;
+
+  return 0 ;
+}
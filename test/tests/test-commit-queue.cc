@@ -0,0 +1,196 @@
+// -- marlin headers
+#include <marlin/concurrency/CommitQueue.h>
+#include <UnitTesting.h>
+
+// -- std headers
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <future>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <cstdlib>
+
+using namespace marlin::test ;
+using namespace marlin::concurrency ;
+
+int main( int /*argc*/, char ** /*argv*/ ) {
+
+  UnitTest test( "CommitQueue" ) ;
+
+  // ordered commit: 4 producers, every 5th index skipped.
+  // The watermark is the lowest index still in flight
+  const std::size_t nevents = 1000 ;
+  std::vector<std::size_t> committed ;
+  std::atomic<std::size_t> watermark {0} ;
+  std::mutex inFlightMutex ;
+  std::set<std::size_t> inFlight ;
+  {
+    CommitQueue<std::size_t>::Settings settings {} ;
+    settings._capacity = 8 ;
+    settings._ordered = true ;
+    settings._pollPeriod = 0.001 ;
+    CommitQueue<std::size_t> queue( [&]( std::size_t &value ) {
+      committed.push_back( value ) ;
+    }, settings, [&]() { return watermark.load() ; } ) ;
+    std::atomic<std::size_t> next {0} ;
+    std::vector<std::thread> threads ;
+    for( unsigned int t=0 ; t<4 ; ++t ) {
+      threads.emplace_back( [&]() {
+        while( true ) {
+          std::size_t index {0} ;
+          {
+            std::lock_guard<std::mutex> lock( inFlightMutex ) ;
+            index = next ++ ;
+            if( index >= nevents ) {
+              break ;
+            }
+            inFlight.insert( index ) ;
+          }
+          if( 0 != index % 5 ) {
+            queue.push( index, index ) ;
+          }
+          std::lock_guard<std::mutex> lock( inFlightMutex ) ;
+          inFlight.erase( index ) ;
+          watermark = inFlight.empty() ? next.load() : *inFlight.begin() ;
+        }
+      }) ;
+    }
+    for( auto &t : threads ) {
+      t.join() ;
+    }
+    queue.stop() ;
+    test.test( "n committed", queue.nCommitted(), nevents - nevents / 5 ) ;
+  }
+  bool ordered {true} ;
+  for( std::size_t i=1 ; i<committed.size() ; ++i ) {
+    ordered = ordered and ( committed[i-1] < committed[i] ) ;
+  }
+  test.test( "ordered", ordered, true ) ;
+  test.test( "all committed", committed.size(), nevents - nevents / 5 ) ;
+
+  // more producers than the queue capacity, index 0 skipped and slow. Only a
+  // separate retiring thread advances the watermark from the indices reported
+  // done by the producers: the queue must drain without any other help
+  committed.clear() ;
+  auto retiring = std::async( std::launch::async, [&]() {
+    const std::size_t nretired = 200 ;
+    std::atomic<std::size_t> retiredWatermark {0} ;
+    std::mutex doneMutex ;
+    std::condition_variable doneCondition ;
+    std::set<std::size_t> done ;
+    CommitQueue<std::size_t>::Settings settings {} ;
+    settings._capacity = 4 ;
+    settings._ordered = true ;
+    settings._pollPeriod = 0.001 ;
+    CommitQueue<std::size_t> queue( [&]( std::size_t &value ) {
+      committed.push_back( value ) ;
+    }, settings, [&]() { return retiredWatermark.load() ; } ) ;
+    std::thread retirer( [&]() {
+      std::unique_lock<std::mutex> lock( doneMutex ) ;
+      std::size_t watermark {0} ;
+      while( watermark < nretired ) {
+        doneCondition.wait( lock, [&]() { return done.count( watermark ) > 0 ; } ) ;
+        while( done.count( watermark ) > 0 ) {
+          ++ watermark ;
+        }
+        retiredWatermark = watermark ;
+      }
+    }) ;
+    std::atomic<std::size_t> next {0} ;
+    std::vector<std::thread> producers ;
+    for( unsigned int t=0 ; t<8 ; ++t ) {
+      producers.emplace_back( [&]() {
+        for( std::size_t index = next ++ ; index < nretired ; index = next ++ ) {
+          if( 0 == index ) {
+            std::this_thread::sleep_for( std::chrono::milliseconds(50) ) ;
+          }
+          else {
+            queue.push( index, index ) ;
+          }
+          {
+            std::lock_guard<std::mutex> lock( doneMutex ) ;
+            done.insert( index ) ;
+          }
+          doneCondition.notify_one() ;
+        }
+      }) ;
+    }
+    for( auto &t : producers ) {
+      t.join() ;
+    }
+    retirer.join() ;
+    queue.stop() ;
+    return queue.nCommitted() ;
+  }) ;
+  if( std::future_status::ready != retiring.wait_for( std::chrono::seconds(30) ) ) {
+    std::cout << "TEST_FAILED: CommitQueue deadlocked with a retiring thread watermark" << std::endl ;
+    std::abort() ;
+  }
+  test.test( "retiring n committed", retiring.get(), std::size_t(199) ) ;
+  bool retiringOrdered {true} ;
+  for( std::size_t i=1 ; i<committed.size() ; ++i ) {
+    retiringOrdered = retiringOrdered and ( committed[i-1] < committed[i] ) ;
+  }
+  test.test( "retiring ordered", retiringOrdered, true ) ;
+
+  // an element not completing its index goes before the element of this index
+  committed.clear() ;
+  {
+    CommitQueue<std::size_t>::Settings settings {} ;
+    settings._ordered = true ;
+    CommitQueue<std::size_t> queue( [&]( std::size_t &value ) {
+      committed.push_back( value ) ;
+    }, settings ) ;
+    queue.push( 1, 100, false ) ;
+    queue.push( 1, 10 ) ;
+    queue.push( 0, 0 ) ;
+    queue.stop() ;
+  }
+  test.test( "header order", committed == std::vector<std::size_t>{ 0, 100, 10 }, true ) ;
+
+  // a marker is committed once the watermark reaches its index, even if a lower
+  // index never came, and before the elements of its index
+  committed.clear() ;
+  {
+    std::atomic<bool> markerCommitted {false} ;
+    CommitQueue<std::size_t>::Settings settings {} ;
+    settings._ordered = true ;
+    settings._pollPeriod = 0.001 ;
+    CommitQueue<std::size_t> queue( [&]( std::size_t &value ) {
+      committed.push_back( value ) ;
+      if( 100 == value ) {
+        markerCommitted = true ;
+      }
+    }, settings, []() { return std::size_t(2) ; } ) ;
+    queue.push( 0, 0 ) ;
+    queue.push( 2, 2 ) ;
+    queue.pushMarker( 2, 100 ) ;
+    for( unsigned int i=0 ; i<1000 and not markerCommitted.load() ; ++i ) {
+      std::this_thread::sleep_for( std::chrono::milliseconds(1) ) ;
+    }
+    test.test( "marker committed", markerCommitted.load(), true ) ;
+    queue.stop() ;
+  }
+  test.test( "marker order", committed == std::vector<std::size_t>{ 0, 100, 2 }, true ) ;
+
+  // commit errors are re-thrown
+  bool thrown {false} ;
+  try {
+    CommitQueue<int>::Settings settings {} ;
+    CommitQueue<int> queue( []( int & ) {
+      throw marlin::Exception( "commit failed" ) ;
+    }, settings ) ;
+    queue.push( 0, 1 ) ;
+    queue.stop() ;
+  }
+  catch( marlin::Exception & ) {
+    thrown = true ;
+  }
+  test.test( "error re-thrown", thrown, true ) ;
+
+  return 0 ;
+}
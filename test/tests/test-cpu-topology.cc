@@ -0,0 +1,105 @@
+// -- marlin headers
+#include <marlin/concurrency/CPUTopology.h>
+#include <marlin/Exceptions.h>
+#include <UnitTesting.h>
+
+// -- std headers
+#include <fstream>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace marlin::test ;
+using namespace marlin::concurrency ;
+
+namespace {
+  void writeFile( const std::string &fname, const std::string &content ) {
+    std::ofstream file( fname ) ;
+    file << content ;
+  }
+
+  bool throws( const std::string &str ) {
+    try {
+      CPUTopology::parseCPUList( str ) ;
+    }
+    catch( marlin::Exception & ) {
+      return true ;
+    }
+    return false ;
+  }
+}
+
+int main( int /*argc*/, char ** /*argv*/ ) {
+
+  UnitTest test( "CPUTopology" ) ;
+
+  // CPU list parsing
+  test.test( "single cpus", CPUTopology::parseCPUList( "0,2,5" ) == CPUTopology::CPUList{ 0, 2, 5 }, true ) ;
+  test.test( "ranges", CPUTopology::parseCPUList( "0-3, 8,10-11" ) == CPUTopology::CPUList{ 0, 1, 2, 3, 8, 10, 11 }, true ) ;
+  test.test( "trailing newline", CPUTopology::parseCPUList( "4-5\n" ) == CPUTopology::CPUList{ 4, 5 }, true ) ;
+  test.test( "empty list", CPUTopology::parseCPUList( "" ).empty(), true ) ;
+  test.test( "reversed range", throws( "3-1" ), true ) ;
+  test.test( "invalid cpu", throws( "a,b" ), true ) ;
+  test.test( "to string", CPUTopology::toString( { 0, 1, 2, 3, 8, 10, 11 } ), std::string( "0-3,8,10-11" ) ) ;
+
+  // worker CPUs
+  auto workers = CPUTopology::workerCPUs( "none", 3 ) ;
+  test.test( "none: no pinning", workers.size() == 3 and workers[0].empty() and workers[2].empty(), true ) ;
+  const auto allowed = CPUTopology::allowedCPUs() ;
+  const auto firstCPU = allowed.front() ;
+  const auto lastCPU = allowed.back() ;
+  workers = CPUTopology::workerCPUs( std::to_string( firstCPU ) + "," + std::to_string( lastCPU ), 3 ) ;
+  test.test( "cpu list: one cpu per worker, wrapped", workers == std::vector<CPUTopology::CPUList>{ {firstCPU}, {lastCPU}, {firstCPU} }, true ) ;
+  workers = CPUTopology::workerCPUs( "compact", 2 ) ;
+  test.test( "compact: one cpu per worker", workers.size() == 2 and workers[0].size() == 1 and workers[1].size() == 1, true ) ;
+  bool invalidMode {false} ;
+  try {
+    CPUTopology::workerCPUs( "spread", 2 ) ;
+  }
+  catch( marlin::Exception & ) {
+    invalidMode = true ;
+  }
+  test.test( "invalid mode", invalidMode, true ) ;
+  auto notAllowed = []( const std::string &mode ) {
+    try {
+      CPUTopology::workerCPUs( mode, 2 ) ;
+    }
+    catch( marlin::Exception & ) {
+      return true ;
+    }
+    return false ;
+  } ;
+  test.test( "cpu list: cpu not allowed", notAllowed( std::to_string( firstCPU ) + "," + std::to_string( lastCPU + 1 ) ), true ) ;
+  test.test( "cpu list: cpu beyond the cpu set size", notAllowed( "100000" ), true ) ;
+
+  // cgroup quota files
+  char tmpl[] = "/tmp/marlin-cgroup-XXXXXX" ;
+  const std::string directory = mkdtemp( tmpl ) ;
+  writeFile( directory + "/cpu.max", "250000 100000\n" ) ;
+  test.test( "v2 quota", CPUTopology::cgroupV2Quota( directory + "/cpu.max" ), 2.5 ) ;
+  writeFile( directory + "/cpu.max", "max 100000\n" ) ;
+  test.test( "v2 no quota", CPUTopology::cgroupV2Quota( directory + "/cpu.max" ), 0. ) ;
+  writeFile( directory + "/cpu.max", "garbage 100000\n" ) ;
+  test.test( "v2 malformed", CPUTopology::cgroupV2Quota( directory + "/cpu.max" ), 0. ) ;
+  test.test( "v2 missing file", CPUTopology::cgroupV2Quota( directory + "/none" ), 0. ) ;
+  writeFile( directory + "/cpu.cfs_quota_us", "150000\n" ) ;
+  writeFile( directory + "/cpu.cfs_period_us", "100000\n" ) ;
+  test.test( "v1 quota", CPUTopology::cgroupV1Quota( directory ), 1.5 ) ;
+  writeFile( directory + "/cpu.cfs_quota_us", "-1\n" ) ;
+  test.test( "v1 no quota", CPUTopology::cgroupV1Quota( directory ), 0. ) ;
+
+  // process cgroup file
+  writeFile( directory + "/cgroup", "12:cpu,cpuacct:/batch/job42\n11:memory:/batch\n0::/user.slice/job.scope\n" ) ;
+  test.test( "v1 path", CPUTopology::cgroupPath( "cpu", directory + "/cgroup" ), std::string( "/batch/job42" ) ) ;
+  test.test( "v1 path, other controller", CPUTopology::cgroupPath( "cpuacct", directory + "/cgroup" ), std::string( "/batch/job42" ) ) ;
+  test.test( "v2 path", CPUTopology::cgroupPath( "", directory + "/cgroup" ), std::string( "/user.slice/job.scope" ) ) ;
+  test.test( "no path", CPUTopology::cgroupPath( "cpuset", directory + "/cgroup" ), std::string( "" ) ) ;
+
+  for( auto fname : { "cpu.max", "cpu.cfs_quota_us", "cpu.cfs_period_us", "cgroup" } ) {
+    unlink( ( directory + "/" + fname ).c_str() ) ;
+  }
+  rmdir( directory.c_str() ) ;
+
+  test.test( "available concurrency", CPUTopology::availableConcurrency() >= 1, true ) ;
+
+  return 0 ;
+}
@@ -0,0 +1,113 @@
+// -- marlin headers
+#include <marlin/EventArena.h>
+#include <marlin/WorkerLocal.h>
+#include <UnitTesting.h>
+
+// -- std headers
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+using namespace marlin::test ;
+using marlin::ArenaPool ;
+using marlin::EventArena ;
+
+int main( int /*argc*/, char ** /*argv*/ ) {
+
+  UnitTest test( "EventArena" ) ;
+
+  // block reuse: a released block serves the next request it fits
+  {
+    ArenaPool pool ;
+    void *block = pool.allocate( 100000 ) ;
+    test.test( "aligned block", reinterpret_cast<std::uintptr_t>( block ) % ArenaPool::BlockAlignment, std::uintptr_t(0) ) ;
+    pool.deallocate( block, 100000 ) ;
+    test.test( "block cached", pool.cachedBlocks(), std::size_t(1) ) ;
+    void *reused = pool.allocate( 50000 ) ;
+    test.test( "block reused", reused == block, true ) ;
+    test.test( "cache empty", pool.cachedBlocks(), std::size_t(0) ) ;
+    // too large for the cached block
+    pool.deallocate( reused, 50000 ) ;
+    void *larger = pool.allocate( 200000 ) ;
+    test.test( "larger block not from cache", pool.cachedBlocks(), std::size_t(1) ) ;
+    pool.deallocate( larger, 200000 ) ;
+    test.test( "both blocks cached", pool.cachedBlocks(), std::size_t(2) ) ;
+    // over-aligned blocks are given back to the system
+    void *aligned = pool.allocate( 1000, 4096 ) ;
+    test.test( "over-aligned block", reinterpret_cast<std::uintptr_t>( aligned ) % 4096, std::uintptr_t(0) ) ;
+    pool.deallocate( aligned, 1000, 4096 ) ;
+    test.test( "over-aligned block not cached", pool.cachedBlocks(), std::size_t(2) ) ;
+  }
+
+  // the number of cached blocks is bounded
+  {
+    ArenaPool pool ;
+    std::vector<void*> blocks ;
+    for( std::size_t i=0 ; i<ArenaPool::MaxCachedBlocks + 4 ; ++i ) {
+      blocks.push_back( pool.allocate( 1024 ) ) ;
+    }
+    for( auto block : blocks ) {
+      pool.deallocate( block, 1024 ) ;
+    }
+    test.test( "max cached blocks", pool.cachedBlocks(), ArenaPool::MaxCachedBlocks ) ;
+  }
+
+  // event arenas: blocks go back to the pool on release, the size hint follows the usage
+  {
+    ArenaPool pool ;
+    test.test( "initial size hint", pool.sizeHint(), ArenaPool::MinBlockSize ) ;
+    {
+      EventArena arena( pool ) ;
+      std::pmr::vector<int> values( &arena ) ;
+      for( int i=0 ; i<100000 ; ++i ) {
+        values.push_back( i ) ;
+      }
+      test.test( "bytes allocated", arena.bytesAllocated() >= 100000 * sizeof(int), true ) ;
+      test.test( "no cached block in use", pool.cachedBlocks(), std::size_t(0) ) ;
+    }
+    const auto cached = pool.cachedBlocks() ;
+    test.test( "blocks released", cached > 0, true ) ;
+    test.test( "size hint grown", pool.sizeHint() > ArenaPool::MinBlockSize, true ) ;
+    test.test( "size hint page aligned", pool.sizeHint() % 4096, std::size_t(0) ) ;
+    // the next arena takes a single block of the size hint, reused by the following arenas
+    EventArena arena( pool ) ;
+    void *first = arena.allocate( 64 ) ;
+    arena.release() ;
+    test.test( "arena reset", arena.bytesAllocated(), std::size_t(0) ) ;
+    const auto cachedAfter = pool.cachedBlocks() ;
+    void *second = arena.allocate( 64 ) ;
+    test.test( "next arena reuses a block", pool.cachedBlocks(), cachedAfter - 1 ) ;
+    test.test( "same block", first == second, true ) ;
+    arena.release() ;
+    // the size hint shrinks slowly
+    const auto hint = pool.sizeHint() ;
+    pool.updateSizeHint( 0 ) ;
+    test.test( "size hint shrinks slowly", pool.sizeHint() < hint and pool.sizeHint() > hint / 2, true ) ;
+  }
+
+  // worker pools
+  test.test( "same worker pool", &ArenaPool::workerPool( 1 ) == &ArenaPool::workerPool( 1 ), true ) ;
+  test.test( "different worker pools", &ArenaPool::workerPool( 0 ) != &ArenaPool::workerPool( 1 ), true ) ;
+  test.test( "no worker pool", &ArenaPool::workerPool( marlin::WorkerLocalBase::NoWorker ) != &ArenaPool::workerPool( 0 ), true ) ;
+
+  // concurrent use of a pool, e.g arenas released by another thread than their worker
+  {
+    ArenaPool pool ;
+    std::vector<std::thread> threads ;
+    for( int t=0 ; t<4 ; ++t ) {
+      threads.emplace_back( [&pool]() {
+        for( int i=0 ; i<1000 ; ++i ) {
+          EventArena arena( pool ) ;
+          void *ptr = arena.allocate( 1024 * ( 1 + i % 64 ) ) ;
+          static_cast<char*>( ptr )[0] = 0 ;
+        }
+      }) ;
+    }
+    for( auto &thread : threads ) {
+      thread.join() ;
+    }
+    test.test( "concurrent use", pool.cachedBlocks() <= ArenaPool::MaxCachedBlocks, true ) ;
+  }
+
+  return 0 ;
+}
@@ -0,0 +1,42 @@
+// -- marlin headers
+#include <marlin/InputCollections.h>
+#include <UnitTesting.h>
+
+using namespace marlin::test ;
+using namespace marlin ;
+
+int main( int /*argc*/, char ** /*argv*/ ) {
+
+  UnitTest test( "InputCollections" ) ;
+
+  // one processor declaring its inputs, one declaring nothing
+  InputCollections inputs ;
+  inputs.addProcessor( "Tracking" ) ;
+  inputs.addCollections( "Tracking", { "TPCHits", "" } ) ;
+  inputs.addProcessor( "Analysis" ) ;
+  test.test( "not empty", inputs.empty(), false ) ;
+  test.test( "names", inputs.names() == InputCollections::NameSet{ "TPCHits" }, true ) ;
+  test.test( "undeclared", inputs.undeclaredProcessors() == InputCollections::NameSet{ "Analysis" }, true ) ;
+
+  // declared with an empty list: no collection used
+  inputs.addCollections( "Analysis", {} ) ;
+  test.test( "all declared", inputs.undeclaredProcessors().empty(), true ) ;
+  test.test( "not used", inputs.isUsed( "MCParticle", "MCParticle" ), false ) ;
+
+  // a processor using all the collections declares its inputs too,
+  // even if it requires them before being added
+  inputs.addAllCollections( "Output", { "SimCalorimeterHits" }, { "MCParticle" } ) ;
+  inputs.addProcessor( "Output" ) ;
+  test.test( "all collections", inputs.allCollections(), true ) ;
+  test.test( "output declared", inputs.undeclaredProcessors().empty(), true ) ;
+  test.test( "used", inputs.isUsed( "Tracks", "Track" ), true ) ;
+  test.test( "except name", inputs.isUsed( "SimCalorimeterHits", "SimCalorimeterHit" ), false ) ;
+  test.test( "except type", inputs.isUsed( "MCParticle", "MCParticle" ), false ) ;
+
+  // nothing declared at all
+  InputCollections none ;
+  none.addProcessor( "Analysis" ) ;
+  test.test( "empty", none.empty(), true ) ;
+
+  return 0 ;
+}
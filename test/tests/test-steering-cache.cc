@@ -0,0 +1,141 @@
+// -- marlin headers
+#include <marlin/SteeringCache.h>
+#include <marlin/StringParameters.h>
+#include <UnitTesting.h>
+
+// -- std headers
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace marlin::test ;
+using namespace marlin ;
+
+namespace {
+  void writeFile( const std::string &fname, const std::string &content ) {
+    std::ofstream file( fname, std::ios::binary | std::ios::trunc ) ;
+    file << content ;
+  }
+
+  std::string readFile( const std::string &fname ) {
+    std::ifstream file( fname, std::ios::binary ) ;
+    std::stringstream ss ;
+    ss << file.rdbuf() ;
+    return ss.str() ;
+  }
+
+  std::string steering( const std::string &verbosity ) {
+    return
+      "<marlin>\n"
+      " <execute>\n"
+      "  <processor name=\"MyProcessor\"/>\n"
+      " </execute>\n"
+      " <global>\n"
+      "  <parameter name=\"Verbosity\"> " + verbosity + " </parameter>\n"
+      " </global>\n"
+      " <datasource type=\"LCIO\">\n"
+      "  <parameter name=\"LCIOInputFiles\"> input.slcio </parameter>\n"
+      " </datasource>\n"
+      " <include ref=\"processors.xml\"/>\n"
+      "</marlin>\n" ;
+  }
+
+  std::string processors( const std::string &value ) {
+    return
+      "<processor name=\"MyProcessor\" type=\"MyType\">\n"
+      " <parameter name=\"Value\"> " + value + " </parameter>\n"
+      " <parameter name=\"Values\"> a b c </parameter>\n"
+      "</processor>\n" ;
+  }
+
+  bool sameParameters( const std::shared_ptr<StringParameters> &lhs, const std::shared_ptr<StringParameters> &rhs ) {
+    if( nullptr == lhs or nullptr == rhs ) {
+      return false ;
+    }
+    auto keys = lhs->keys() ;
+    if( keys != rhs->keys() ) {
+      return false ;
+    }
+    for( auto &key : keys ) {
+      if( lhs->getValues<std::string>( key ) != rhs->getValues<std::string>( key ) ) {
+        return false ;
+      }
+    }
+    return true ;
+  }
+
+  // parse with a fresh cache instance, as a new job would do
+  std::shared_ptr<SteeringCache> parse( const std::string &steeringFile, const std::string &cacheFile, const CommandLineParametersMap &cmdline = {} ) {
+    auto cache = std::make_shared<SteeringCache>( steeringFile, cacheFile ) ;
+    cache->setCmdLineParameters( cmdline ) ;
+    cache->parse() ;
+    return cache ;
+  }
+}
+
+int main( int /*argc*/, char ** /*argv*/ ) {
+
+  UnitTest test( "SteeringCache" ) ;
+
+  char tmpl[] = "/tmp/marlin-steering-cache-XXXXXX" ;
+  const std::string directory = mkdtemp( tmpl ) ;
+  const std::string steeringFile = directory + "/steering.xml" ;
+  const std::string processorsFile = directory + "/processors.xml" ;
+  const std::string cacheFile = directory + "/steering.cache" ;
+  writeFile( steeringFile, steering( "MESSAGE" ) ) ;
+  writeFile( processorsFile, processors( "1" ) ) ;
+
+  // round trip
+  auto xml = parse( steeringFile, cacheFile ) ;
+  test.test( "first parse from XML", xml->loadedFromCache(), false ) ;
+  test.test( "cache file written", std::ifstream( cacheFile ).good(), true ) ;
+  auto cached = parse( steeringFile, cacheFile ) ;
+  test.test( "second parse from cache", cached->loadedFromCache(), true ) ;
+  test.test( "same global section", sameParameters( xml->getParameters( "Global" ), cached->getParameters( "Global" ) ), true ) ;
+  test.test( "same processor section", sameParameters( xml->getParameters( "MyProcessor" ), cached->getParameters( "MyProcessor" ) ), true ) ;
+  test.test( "cached value", cached->getParameters( "MyProcessor" )->getValue<int>( "Value" ), 1 ) ;
+  test.test( "cached values", cached->getParameters( "MyProcessor" )->getValues<std::string>( "Values" ) == std::vector<std::string>{ "a", "b", "c" }, true ) ;
+  test.test( "unknown section", nullptr == cached->getParameters( "Unknown" ), true ) ;
+
+  // steering file changed
+  writeFile( steeringFile, steering( "DEBUG" ) ) ;
+  auto changed = parse( steeringFile, cacheFile ) ;
+  test.test( "XML changed: rejected", changed->loadedFromCache(), false ) ;
+  test.test( "XML changed: new value", changed->getParameters( "Global" )->getValue<std::string>( "Verbosity" ), std::string( "DEBUG" ) ) ;
+  test.test( "XML changed: cache rewritten", parse( steeringFile, cacheFile )->loadedFromCache(), true ) ;
+
+  // included file changed
+  writeFile( processorsFile, processors( "2" ) ) ;
+  changed = parse( steeringFile, cacheFile ) ;
+  test.test( "include changed: rejected", changed->loadedFromCache(), false ) ;
+  test.test( "include changed: new value", changed->getParameters( "MyProcessor" )->getValue<int>( "Value" ), 2 ) ;
+  test.test( "include changed: cache rewritten", parse( steeringFile, cacheFile )->loadedFromCache(), true ) ;
+
+  // command line override changed
+  const CommandLineParametersMap cmdline { { "MyProcessor", { { "Value", "3" } } } } ;
+  changed = parse( steeringFile, cacheFile, cmdline ) ;
+  test.test( "override changed: rejected", changed->loadedFromCache(), false ) ;
+  test.test( "override changed: new value", changed->getParameters( "MyProcessor" )->getValue<int>( "Value" ), 3 ) ;
+  cached = parse( steeringFile, cacheFile, cmdline ) ;
+  test.test( "same override: from cache", cached->loadedFromCache(), true ) ;
+  test.test( "same override: cached value", cached->getParameters( "MyProcessor" )->getValue<int>( "Value" ), 3 ) ;
+  test.test( "override removed: rejected", parse( steeringFile, cacheFile )->loadedFromCache(), false ) ;
+
+  // corrupted cache file
+  auto content = readFile( cacheFile ) ;
+  auto corrupted = content ;
+  corrupted[ corrupted.size() / 2 ] ^= 0x1 ;
+  writeFile( cacheFile, corrupted ) ;
+  test.test( "checksum mismatch: rejected", parse( steeringFile, cacheFile )->loadedFromCache(), false ) ;
+  writeFile( cacheFile, content.substr( 0, content.size() - 1 ) ) ;
+  test.test( "truncated: rejected", parse( steeringFile, cacheFile )->loadedFromCache(), false ) ;
+  writeFile( cacheFile, content ) ;
+  test.test( "restored: from cache", parse( steeringFile, cacheFile )->loadedFromCache(), true ) ;
+
+  unlink( steeringFile.c_str() ) ;
+  unlink( processorsFile.c_str() ) ;
+  unlink( cacheFile.c_str() ) ;
+  rmdir( directory.c_str() ) ;
+
+  return 0 ;
+}
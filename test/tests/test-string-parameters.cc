@@ -0,0 +1,58 @@
+// -- marlin headers
+#include <marlin/StringParameters.h>
+#include <UnitTesting.h>
+
+// -- std headers
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace marlin::test ;
+
+int main( int /*argc*/, char ** /*argv*/ ) {
+
+  UnitTest test( "StringParameters" ) ;
+
+  marlin::StringParameters parameters ;
+  parameters.add( "Int", std::string("42") ) ;
+  parameters.add( "Floats", std::vector<std::string>{ "1.5", "2.5", "3.5" } ) ;
+  parameters.add( "Bool", std::string("true") ) ;
+
+  test.test( "int value", parameters.getValue<int>( "Int" ), 42 ) ;
+  test.test( "int value (cached)", parameters.getValue<int>( "Int" ), 42 ) ;
+  test.test( "same key, other type", parameters.getValue<double>( "Int" ), 42. ) ;
+  test.test( "bool value", parameters.getValue<bool>( "Bool" ), true ) ;
+  test.test( "fallback", parameters.getValue<int>( "Unknown", 12 ), 12 ) ;
+  auto floats = parameters.getValues<float>( "Floats" ) ;
+  test.test( "vector size", floats.size(), 3u ) ;
+  test.test( "vector value", floats[1], 2.5f ) ;
+
+  // modification must invalidate the typed values
+  parameters.replace( "Int", 17 ) ;
+  test.test( "replaced value", parameters.getValue<int>( "Int" ), 17 ) ;
+  parameters.add( "Floats", 4.5f ) ;
+  test.test( "appended value", parameters.getValues<float>( "Floats" ).size(), 4u ) ;
+
+  // copies do not share the typed values
+  marlin::StringParameters copy( parameters ) ;
+  copy.replace( "Int", 5 ) ;
+  test.test( "copy value", copy.getValue<int>( "Int" ), 5 ) ;
+  test.test( "original value", parameters.getValue<int>( "Int" ), 17 ) ;
+
+  // concurrent readers
+  std::vector<std::future<int>> futures ;
+  for( auto i=0u ; i<std::thread::hardware_concurrency() ; ++i ) {
+    futures.push_back( std::async( std::launch::async, [&](){
+      int sum = 0 ;
+      for( unsigned int j=0 ; j<1000 ; ++j ) {
+        sum += parameters.getValue<int>( "Int" ) ;
+      }
+      return sum ;
+    })) ;
+  }
+  for( auto &f : futures ) {
+    test.test( "concurrent read", f.get(), 17000 ) ;
+  }
+
+  return 0 ;
+}
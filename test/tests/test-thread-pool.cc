@@ -2,6 +2,9 @@
 #include <marlin/concurrency/ThreadPool.h>
 #include <UnitTesting.h>
 
+// -- std headers
+#include <set>
+
 using namespace marlin ;
 using namespace marlin::test ;
 using namespace marlin::concurrency ;
@@ -74,6 +77,107 @@ int main( int argc, char **argv ) {
   pool.stop(false) ;
   
   test.test( "counter", counter.load() == 3 ) ;
-    
+
+  // park all workers but one, then unpark them
+  Pool parkPool ;
+  for( unsigned int w=0 ; w<4 ; ++w ) {
+    parkPool.addWorker<TestWorker>( w ) ;
+  }
+  parkPool.setMaxQueueSize( 20 ) ;
+  parkPool.start() ;
+  parkPool.setActiveWorkers( 1 ) ;
+  test.test( "active workers", parkPool.activeWorkers() == 1 ) ;
+  std::mutex idMutex ;
+  std::set<std::thread::id> threadIds ;
+  std::atomic_int parkCounter {0} ;
+  Function g = [&](){
+    {
+      std::lock_guard<std::mutex> lock( idMutex ) ;
+      threadIds.insert( std::this_thread::get_id() ) ;
+    }
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) ) ;
+    parkCounter++ ;
+  } ;
+  PushResultList parkResults ;
+  for( unsigned int t=0 ; t<10 ; ++t ) {
+    Function gt = g ;
+    parkResults.push_back( parkPool.push( Pool::PushPolicy::Blocking, std::move( gt ) ) ) ;
+  }
+  for( auto &res : parkResults ) {
+    res.second.get() ;
+  }
+  test.test( "parked workers idle", threadIds.size() == 1 ) ;
+  parkPool.setActiveWorkers( 4 ) ;
+  test.test( "unparked workers", parkPool.activeWorkers() == 4 ) ;
+  parkResults.clear() ;
+  for( unsigned int t=0 ; t<10 ; ++t ) {
+    Function gt = g ;
+    parkResults.push_back( parkPool.push( Pool::PushPolicy::Blocking, std::move( gt ) ) ) ;
+  }
+  for( auto &res : parkResults ) {
+    res.second.get() ;
+  }
+  parkPool.stop(false) ;
+  test.test( "park counter", parkCounter.load() == 20 ) ;
+
+  // parallel for inside a pool task, helped by the idle workers
+  TaskQueue taskQueue ;
+  Pool taskPool ;
+  for( unsigned int w=0 ; w<4 ; ++w ) {
+    taskPool.addWorker<TestWorker>( w ) ;
+  }
+  taskPool.setMaxQueueSize( 4 ) ;
+  taskPool.setTaskQueue( &taskQueue ) ;
+  taskPool.start() ;
+  std::set<std::thread::id> taskThreadIds ;
+  std::atomic<std::size_t> sum {0} ;
+  Function h = [&](){
+    parallelFor( taskQueue, 0, 1000, 10, [&]( std::size_t first, std::size_t last ) {
+      {
+        std::lock_guard<std::mutex> lock( idMutex ) ;
+        taskThreadIds.insert( std::this_thread::get_id() ) ;
+      }
+      for( auto i=first ; i<last ; ++i ) {
+        sum += i ;
+      }
+      std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) ) ;
+    }) ;
+  } ;
+  taskPool.push( Pool::PushPolicy::Blocking, std::move( h ) ).second.get() ;
+  test.test( "parallel for sum", sum.load() == 499500 ) ;
+  test.test( "parallel for helpers", taskThreadIds.size() > 1 ) ;
+  // exceptions are rethrown in the waiting thread
+  bool caught = false ;
+  try {
+    parallelFor( taskQueue, 0, 100, 1, []( std::size_t first, std::size_t ) {
+      if( 50 == first ) {
+        throw Exception( "chunk failure" ) ;
+      }
+    }) ;
+  }
+  catch( Exception & ) {
+    caught = true ;
+  }
+  test.test( "parallel for exception", caught ) ;
+  taskPool.stop(false) ;
+  // no pool: the waiting thread runs everything
+  sum = 0 ;
+  TaskGroup group( taskQueue ) ;
+  for( std::size_t i=0 ; i<10 ; ++i ) {
+    group.run( [&sum, i](){ sum += i ; } ) ;
+  }
+  group.wait() ;
+  test.test( "task group inline", sum.load() == 45 ) ;
+  // waiting without helping others: only the tasks of the group are run
+  bool otherRun = false ;
+  TaskGroup other( taskQueue ) ;
+  other.run( [&otherRun](){ otherRun = true ; } ) ;
+  sum = 0 ;
+  group.run( [&sum](){ sum += 1 ; } ) ;
+  group.wait( false ) ;
+  test.test( "task group own tasks", sum.load() == 1 and not otherRun ) ;
+  other.wait() ;
+  test.test( "task group other tasks", otherRun ) ;
+
   return 0 ;
 }
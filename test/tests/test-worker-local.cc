@@ -0,0 +1,73 @@
+// -- marlin headers
+#include <marlin/WorkerLocal.h>
+#include <UnitTesting.h>
+
+// -- std headers
+#include <thread>
+#include <vector>
+
+using namespace marlin::test ;
+
+struct Counter {
+  std::size_t _index {0} ;
+  int         _count {0} ;
+};
+
+int main( int /*argc*/, char ** /*argv*/ ) {
+
+  UnitTest test( "WorkerLocal" ) ;
+
+  const std::size_t nworkers = 4 ;
+  marlin::WorkerLocal<Counter> counters( nworkers, []( std::size_t index ) {
+    auto counter = std::unique_ptr<Counter>( new Counter() ) ;
+    counter->_index = index ;
+    return counter ;
+  }) ;
+  test.test( "size", counters.size(), nworkers ) ;
+  test.test( "not allocated", counters.allocated(0), false ) ;
+
+  // threads that are not workers use their own slot
+  test.test( "no worker index", marlin::WorkerLocalBase::currentWorkerIndex(), marlin::WorkerLocalBase::NoWorker ) ;
+  counters.local()._count = 1000 ;
+  test.test( "no worker slot", counters.allocated(nworkers), true ) ;
+  test.test( "worker slot not used", counters.allocated(0), false ) ;
+
+  // each worker increments its own slot, without lock
+  std::vector<std::thread> threads ;
+  for( std::size_t i=0 ; i<nworkers ; ++i ) {
+    threads.emplace_back( [&counters,i]() {
+      marlin::WorkerLocalBase::setCurrentWorkerIndex( i ) ;
+      for( int c=0 ; c<1000 ; ++c ) {
+        counters.local()._count ++ ;
+      }
+    }) ;
+  }
+  for( auto &t : threads ) {
+    t.join() ;
+  }
+
+  int total {0} ;
+  bool indexOk {true} ;
+  counters.onReduce( [&]( marlin::WorkerLocal<Counter> &local ) {
+    local.forEach( [&]( std::size_t index, Counter &counter ) {
+      total += counter._count ;
+      indexOk = indexOk and ( index == counter._index ) ;
+    }) ;
+  }) ;
+  counters.reduce() ;
+  test.test( "reduced total", total, 5000 ) ;
+  test.test( "worker indices", indexOk, true ) ;
+
+  // out of range worker index
+  marlin::WorkerLocalBase::setCurrentWorkerIndex( nworkers ) ;
+  bool thrown {false} ;
+  try {
+    counters.local() ;
+  }
+  catch( marlin::Exception & ) {
+    thrown = true ;
+  }
+  test.test( "out of range index", thrown, true ) ;
+
+  return 0 ;
+}